@@ -18,7 +18,9 @@
 #include <netp/bytes_helper.hpp>
 #include <netp/ringbuffer.hpp>
 #include <netp/packet.hpp>
+#include <netp/composite_packet.hpp>
 #include <netp/bytes_ringbuffer.hpp>
+#include <netp/mirror_ringbuffer.hpp>
 #include <netp/heap.hpp>
 
 #include <netp/helper.hpp>
@@ -42,6 +44,7 @@
 #include <netp/logger/net_logger.hpp>
 
 #include <netp/scheduler.hpp>
+#include <netp/compute_pool.hpp>
 
 #include <netp/security/dh.hpp>
 #include <netp/security/xxtea.hpp>
@@ -49,6 +52,7 @@
 #include <netp/address.hpp>
 #include <netp/socket.hpp>
 #include <netp/icmp.hpp>
+#include <netp/static_pipeline.hpp>
 
 #include <netp/handler/hlen.hpp>
 #include <netp/handler/fragment.hpp>
@@ -66,6 +70,7 @@
 #include <netp/handler/dump_out_text.hpp>
 #include <netp/handler/dump_in_len.hpp>
 #include <netp/handler/dump_out_len.hpp>
+#include <netp/handler/idle_state.hpp>
 
 #include <netp/dns_resolver.hpp>
 #include <netp/http/message.hpp>
@@ -76,6 +81,7 @@
 
 #include <netp/signal_broker.hpp>
 #include <netp/app.hpp>
+#include <netp/coroutine.hpp>
 
 #include <netp/benchmark.hpp>
 #include <netp/test.hpp>
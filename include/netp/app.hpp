@@ -18,6 +18,12 @@ namespace netp {
 		int poller_max[T_POLLER_MAX];
 		int poller_count[T_POLLER_MAX];
 		event_loop_cfg event_loop_cfgs[T_POLLER_MAX];
+		int compute_worker_count; //0 means hardware_concurrency
+		size_t mem_tls_cached_bytes_max; //0 means no limit
+		size_t mem_global_cached_bytes_max; //0 means no limit
+		bool mem_preallocate_eager; //false means the pool of a thread is warmed on demand
+		size_t mem_budget_max; //bytes buffered by all channels, 0 means no limit
+		u32_t mem_budget_channel_max; //bytes buffered by one channel, 0 means no limit
 
 		fn_app_hook_t app_startup_prev;
 		fn_app_hook_t app_startup_post;
@@ -42,12 +48,21 @@ namespace netp {
 					cfg_poller_count(io_poller_type(i), 0);
 				}
 				event_loop_cfgs[i].ch_buf_size = (128 * 1024);
+				event_loop_cfgs[i].busy_poll_budget = 0;
+				event_loop_cfgs[i].sock_busy_poll = 0;
+				event_loop_cfgs[i].mem_decay_interval = NETP_EVENT_LOOP_MEM_DECAY_INTERVAL;
 			}
 		}
 	public:
 		app_cfg(int argc, char** argv) :
 			logfilepathname(),
 			dnsnses(std::vector<std::string>()),
+			compute_worker_count(0),
+			mem_tls_cached_bytes_max(0),
+			mem_global_cached_bytes_max(0),
+			mem_preallocate_eager(false),
+			mem_budget_max(0),
+			mem_budget_channel_max(0),
 			app_startup_prev(nullptr),
 			app_startup_post(nullptr),
 			app_exit_prev(nullptr),
@@ -69,6 +84,12 @@ namespace netp {
 		app_cfg() :
 			logfilepathname(),
 			dnsnses(std::vector<std::string>()),
+			compute_worker_count(0),
+			mem_tls_cached_bytes_max(0),
+			mem_global_cached_bytes_max(0),
+			mem_preallocate_eager(false),
+			mem_budget_max(0),
+			mem_budget_channel_max(0),
 			app_startup_prev(nullptr),
 			app_startup_post(nullptr),
 			app_exit_prev(nullptr),
@@ -118,6 +139,40 @@ namespace netp {
 			}
 		}
 
+		//spin_budget_in_us: spin on poll(0) for this long before blocking
+		//sock_busy_poll_in_us: SO_BUSY_POLL(and SO_PREFER_BUSY_POLL if available) for the sockets of the loop
+		void cfg_busy_poll(io_poller_type t, int spin_budget_in_us, int sock_busy_poll_in_us = 0) {
+			event_loop_cfgs[t].busy_poll_budget = spin_budget_in_us > 0 ? u32_t(spin_budget_in_us) : 0;
+			event_loop_cfgs[t].sock_busy_poll = sock_busy_poll_in_us > 0 ? u32_t(sock_busy_poll_in_us) : 0;
+		}
+
+		//workers of compute_pool, the pool is started on the first io_event_loop::offload
+		void cfg_compute_worker_count(int c) {
+			compute_worker_count = c > 0 ? c : 0;
+		}
+
+		//decay the memory pool of the loop thread every interval_in_ms, 0 means no decay
+		void cfg_memory_decay(io_poller_type t, int interval_in_ms) {
+			event_loop_cfgs[t].mem_decay_interval = interval_in_ms > 0 ? u32_t(interval_in_ms) : 0;
+		}
+
+		//cap of the bytes parked in the pool of every thread and the global pool
+		void cfg_memory_cached_bytes_max(size_t tls_max, size_t global_max) {
+			mem_tls_cached_bytes_max = tls_max;
+			mem_global_cached_bytes_max = global_max;
+		}
+
+		//eager: every thread fills the pool classes below 1K on start, it costs startup time and RSS for each loop
+		void cfg_memory_preallocate(bool eager) {
+			mem_preallocate_eager = eager;
+		}
+
+		//outbound queues and inbound accumulation of channels, over budget: stop reading, reject new connections
+		void cfg_memory_budget(size_t process_max, u32_t channel_max) {
+			mem_budget_max = process_max;
+			mem_budget_channel_max = channel_max;
+		}
+
 		void cfg_add_dns(std::string const& dns_ns) {
 			dnsnses.push_back(dns_ns);
 		}
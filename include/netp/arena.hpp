@@ -0,0 +1,133 @@
+#ifndef _NETP_ARENA_HPP_
+#define _NETP_ARENA_HPP_
+
+#include <string>
+#include <type_traits>
+
+#include <netp/core.hpp>
+#include <netp/smart_ptr.hpp>
+
+//a block is taken from the pooled allocator, a 8K block is a pooled item
+#define NETP_ARENA_BLOCK_SIZE (8*1024)
+
+namespace netp {
+
+	/*
+	 * @note
+	 * bump pointer allocator for request scoped objects (header fields, parser state ...)
+	 * 1, allocate() is for the owner loop only, deallocate() might be called from any thread, it only counts
+	 * 2, reset() frees every block in one go, it refuses (return false) if anything allocated is still alive
+	 * 3, an object that allocates from an arena should hold a NRP<arena>, so the blocks outlive it
+	 * 4, live() == 0 does not mean nobody would allocate again (an empty container bound to it), the owner drops the arena instead of resetting it if such an object is still held
+	 */
+	class arena final :
+		public netp::ref_base
+	{
+		NETP_DECLARE_NONCOPYABLE(arena)
+
+		struct block {
+			block* next;
+			size_t size;
+		};
+
+		block* m_blocks; //newest first
+		byte_t* m_cur;
+		byte_t* m_end;
+		u32_t m_block_size;
+		size_t m_allocated; //bytes handed out since last reset
+		std::atomic<u32_t> m_live;
+
+		void* __allocate_slow(size_t size, size_t alignment);
+		void __free_blocks(block* b);
+
+	public:
+		arena(u32_t block_size = NETP_ARENA_BLOCK_SIZE);
+		~arena();
+
+		__NETP_FORCE_INLINE void* allocate(size_t size, size_t alignment = sizeof(void*)) {
+			byte_t* p = (byte_t*)((size_t(m_cur) + (alignment - 1)) & ~(alignment - 1));
+			if (NETP_LIKELY((p + size) <= m_end)) {
+				m_cur = p + size;
+				m_allocated += size;
+				m_live.fetch_add(1, std::memory_order_relaxed);
+				return p;
+			}
+			return __allocate_slow(size, alignment);
+		}
+
+		//the memory is given back on reset
+		__NETP_FORCE_INLINE void deallocate(void* p, size_t size) {
+			(void)p;
+			(void)size;
+			NETP_ASSERT(m_live.load(std::memory_order_relaxed) > 0);
+			m_live.fetch_sub(1, std::memory_order_release);
+		}
+
+		bool reset();
+
+		inline size_t allocated() const { return m_allocated; }
+		inline u32_t live() const { return m_live.load(std::memory_order_acquire); }
+	};
+
+	//stl compliant, falls back to netp::allocator if no arena given
+	template <class T>
+	struct arena_allocator {
+		typedef size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T value_type;
+
+		template <class U>
+		struct rebind {
+			typedef arena_allocator<U> other;
+		};
+
+		//a container moved to another allocator takes it along
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		netp::arena* A;
+
+		arena_allocator() _NETP_NOEXCEPT :
+			A(nullptr)
+		{}
+		explicit arena_allocator(netp::arena* a) _NETP_NOEXCEPT :
+			A(a)
+		{}
+		template <class U>
+		arena_allocator(const arena_allocator<U>& other) _NETP_NOEXCEPT :
+			A(other.A)
+		{}
+
+		inline pointer allocate(size_type n) {
+			if (A == nullptr) {
+				return netp::allocator<T>::malloc(n);
+			}
+			return static_cast<pointer>(A->allocate(sizeof(T) * n, alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T)));
+		}
+
+		inline void deallocate(pointer p, size_type n) {
+			if (A == nullptr) {
+				netp::allocator<T>::free(p);
+				return;
+			}
+			A->deallocate(p, sizeof(T) * n);
+		}
+	};
+
+	template<typename _T1, typename _T2>
+	inline bool operator==(const arena_allocator<_T1>& l, const arena_allocator<_T2>& r) {
+		return l.A == r.A;
+	}
+
+	template<typename _T1, typename _T2>
+	inline bool operator!=(const arena_allocator<_T1>& l, const arena_allocator<_T2>& r) {
+		return l.A != r.A;
+	}
+
+	typedef std::basic_string<char, std::char_traits<char>, netp::arena_allocator<char> > arena_string_t;
+}
+#endif
@@ -87,7 +87,11 @@ namespace netp {
 		F_TIMER_2 = 1 << 25,
 
 		F_USE_DEFAULT_READ=1<<26,
-		F_USE_DEFAULT_WRITE = 1<<27
+		F_USE_DEFAULT_WRITE = 1<<27,
+
+		F_MIGRATING = 1<<28, //io unwatched from the old loop, not yet watched by the new loop
+		F_MEM_PAUSED = 1<<29, //read unwatched for the memory budget, rewatched once the buffered bytes drain
+		F_MEM_PAUSE_TIMER = 1<<30
 	};
 
 	struct channel_buf_cfg {
@@ -102,6 +106,40 @@ namespace netp {
 		CH_BUF_SND_MIN_SIZE = (8192U)
 	};
 
+	//resume reading once the buffered bytes drop below 3/4 of the limit
+	#define NETP_CHANNEL_MEM_RESUME_WATERMARK(max) ((max) - ((max)>>2))
+	#define NETP_CHANNEL_MEM_RESUME_CHECK_DUR (100)
+
+	/*
+	 * @note
+	 * bytes buffered by channels in total: outbound queues and inbound accumulation of codecs (hlen, websocket ...)
+	 * 1, process_max bounds the sum of all channels, channel_max bounds a single channel, 0 means no limit
+	 * 2, a channel over budget by its outbound bytes stops reading until they drain, a listener over process_max closes the new fd right away
+	 * 3, inbound partials drain by reading only, they never pause a read, a codec holding more than channel_max closes the channel (E_CHANNEL_MEM_LIMIT)
+	 * 4, used/used_in are shared by all loops, only the channels created with a process_max != 0 touch them, set the budget before any channel
+	 */
+	struct channel_mem_budget {
+		static std::atomic<size_t> used;
+		static std::atomic<size_t> used_in; //part of used
+		static std::atomic<size_t> process_max;
+		static std::atomic<u32_t> channel_max;
+	};
+	extern void channel_mem_budget_cfg(size_t process_max, u32_t channel_max);
+
+	__NETP_FORCE_INLINE size_t channel_mem_budget_used() {
+		return channel_mem_budget::used.load(std::memory_order_relaxed);
+	}
+	__NETP_FORCE_INLINE bool channel_mem_budget_exceeds(u32_t more = 0) {
+		const size_t max = channel_mem_budget::process_max.load(std::memory_order_relaxed);
+		return (max != 0) && ((channel_mem_budget::used.load(std::memory_order_relaxed) + more) > max);
+	}
+	//used_in is charged first and released last, load it first
+	__NETP_FORCE_INLINE size_t channel_mem_budget_out_used() {
+		const size_t in = channel_mem_budget::used_in.load(std::memory_order_relaxed);
+		const size_t all = channel_mem_budget::used.load(std::memory_order_relaxed);
+		return all > in ? (all - in) : 0;
+	}
+
 	class channel_pipeline;
 	typedef SOCKET channel_id_t;
 
@@ -124,10 +162,15 @@ namespace netp {
 		public netp::io_monitor
 	{
 	public:
+		//@note: loop thread only, ch_migrate_to rewrites it in the old loop, other threads must use ch_loop() or ch_loop_binding()
 		NRP<io_event_loop> L;
 	protected:
+		NRP<loop_binding> m_loop_binding;
 		int m_chflag;
 		int m_cherrno;
+		u32_t m_mem_bytes; //bytes accounted by ch_mem_charge
+		u32_t m_mem_in_bytes; //part of m_mem_bytes, accounted by ch_mem_account_in
+		bool m_mem_global; //process_max was set at creation, m_mem_bytes goes to channel_mem_budget::used too
 	private:
 		NRP<channel_pipeline> m_pipeline;
 		NRP<promise<int>> m_ch_close_p;
@@ -157,6 +200,20 @@ namespace netp {
 			CH_FIRE_ACTION_IMPL_0(connected)
 			CH_FIRE_ACTION_IMPL_0(read_closed)
 			CH_FIRE_ACTION_IMPL_0(write_closed)
+			CH_FIRE_ACTION_IMPL_0(read_complete)
+
+			__NETP_FORCE_INLINE void ch_fire_loop_migrated(NRP<io_event_loop> const& from) const {
+				m_pipeline->fire_loop_migrated(from);
+			}
+
+			//rebind channel&pipeline to the new loop, must be called in the old loop
+			//the binding is published last, other threads might run the channel in <to> right after that
+			inline void ch_rebind_loop(NRP<io_event_loop> const& to) {
+				NETP_ASSERT(L->in_event_loop());
+				NETP_ASSERT(m_pipeline != nullptr);
+				L = to;
+				m_loop_binding->rebind(to);
+			}
 
 			inline void ch_fire_closed(int code) const {
 				NETP_ASSERT(L->in_event_loop());
@@ -173,8 +230,19 @@ namespace netp {
 				NETP_ASSERT(m_pipeline != nullptr);
 				m_pipeline->deinit();
 				m_pipeline = nullptr;
+				//a handler that does not give back its bytes on close
+				if (m_mem_bytes != 0) {
+					if (m_mem_global) {
+						channel_mem_budget::used.fetch_sub(m_mem_bytes, std::memory_order_relaxed);
+						channel_mem_budget::used_in.fetch_sub(m_mem_in_bytes, std::memory_order_relaxed);
+					}
+					m_mem_bytes = 0;
+					m_mem_in_bytes = 0;
+				}
 			}
 
+			void _tmcb_mem_resume(NRP<timer> const& t);
+
 			inline void ch_init() {
 				NETP_ASSERT(m_ch_close_p == nullptr);
 				m_ch_close_p = netp::make_ref<promise<int>>();
@@ -195,8 +263,12 @@ namespace netp {
 	public:
 		channel(NRP<io_event_loop> const& L_) :
 			L(L_),
+			m_loop_binding(netp::make_ref<loop_binding>(L_)),
 			m_chflag(int(channel_flag::F_CLOSED)),
 			m_cherrno(0),
+			m_mem_bytes(0),
+			m_mem_in_bytes(0),
+			m_mem_global(channel_mem_budget::process_max.load(std::memory_order_relaxed) != 0),
 			m_pipeline(nullptr),
 			m_ch_close_p(nullptr),
 			m_ctx(nullptr)
@@ -211,6 +283,10 @@ namespace netp {
 		//__NETP_FORCE_INLINE NRP<io_event_loop> const& event_loop() const { return m_loop;}
 		__NETP_FORCE_INLINE NRP<channel_pipeline> const& pipeline() const { return m_pipeline;}
 		__NETP_FORCE_INLINE NRP<promise<int>> const& ch_close_promise() const { return m_ch_close_p;}
+		//the loop of this channel for other threads, it follows ch_migrate_to
+		__NETP_FORCE_INLINE NRP<loop_binding> const& ch_loop_binding() const { return m_loop_binding; }
+		//the current loop of this channel, safe from any thread, it might be stale by the time a task is scheduled on it
+		__NETP_FORCE_INLINE NRP<io_event_loop> ch_loop() const { return m_loop_binding->get(); }
 
 		template <class ctx_t>
 		inline NRP<ctx_t> get_ctx() const {
@@ -228,6 +304,76 @@ namespace netp {
 		inline bool ch_is_listener() { return (m_chflag & int(channel_flag::F_LISTENING)) != 0; }
 
 		inline void ch_set_active() { m_chflag |= int(channel_flag::F_ACTIVE); }
+
+		//@note: account the bytes buffered on behalf of this channel, L only
+		__NETP_FORCE_INLINE u32_t ch_mem_bytes() const { return m_mem_bytes; }
+		//no shared counter is touched without a process_max, the per message cost is a plain add then
+		__NETP_FORCE_INLINE void ch_mem_charge(u32_t n) {
+			m_mem_bytes += n;
+			if (m_mem_global) {
+				channel_mem_budget::used.fetch_add(n, std::memory_order_relaxed);
+			}
+		}
+		__NETP_FORCE_INLINE void ch_mem_release(u32_t n) {
+			NETP_ASSERT(n <= m_mem_bytes, "release: %u, bytes: %u", n, m_mem_bytes);
+			m_mem_bytes -= n;
+			if (m_mem_global) {
+				channel_mem_budget::used.fetch_sub(n, std::memory_order_relaxed);
+			}
+			if (NETP_UNLIKELY(m_chflag & int(channel_flag::F_MEM_PAUSED))) {
+				ch_mem_resume_read();
+			}
+		}
+		//charged: what the caller has accounted so far, now: what it holds right now
+		__NETP_FORCE_INLINE void ch_mem_account(u32_t& charged, u32_t now) {
+			if (now > charged) {
+				ch_mem_charge(now - charged);
+			} else if (now < charged) {
+				ch_mem_release(charged - now);
+			}
+			charged = now;
+		}
+		//for the inbound partials of a codec, return E_CHANNEL_MEM_LIMIT if they are over channel_max, the caller closes the channel then
+		__NETP_FORCE_INLINE int ch_mem_account_in(u32_t& charged, u32_t now) {
+			if (now > charged) {
+				m_mem_in_bytes += (now - charged);
+				if (m_mem_global) {
+					channel_mem_budget::used_in.fetch_add(now - charged, std::memory_order_relaxed);
+				}
+				ch_mem_charge(now - charged);
+			} else if (now < charged) {
+				NETP_ASSERT((charged - now) <= m_mem_in_bytes, "release: %u, bytes: %u", (charged - now), m_mem_in_bytes);
+				m_mem_in_bytes -= (charged - now);
+				ch_mem_release(charged - now);
+				if (m_mem_global) {
+					channel_mem_budget::used_in.fetch_sub(charged - now, std::memory_order_relaxed);
+				}
+			}
+			charged = now;
+			const u32_t max = channel_mem_budget::channel_max.load(std::memory_order_relaxed);
+			return ((max != 0) && (m_mem_in_bytes > max)) ? netp::E_CHANNEL_MEM_LIMIT : netp::OK;
+		}
+		//the read pause looks at the outbound bytes only, pausing for inbound partials would never end
+		__NETP_FORCE_INLINE bool ch_mem_out_exceeds() const {
+			const u32_t max = channel_mem_budget::channel_max.load(std::memory_order_relaxed);
+			if ((max != 0) && ((m_mem_bytes - m_mem_in_bytes) > max)) {
+				return true;
+			}
+			const size_t process_max = channel_mem_budget::process_max.load(std::memory_order_relaxed);
+			return (process_max != 0) && (channel_mem_budget_out_used() > process_max);
+		}
+		__NETP_FORCE_INLINE bool ch_mem_channel_exceeds(u32_t more = 0) const {
+			const u32_t max = channel_mem_budget::channel_max.load(std::memory_order_relaxed);
+			return (max != 0) && ((u64_t(m_mem_bytes) + more) > max);
+		}
+		__NETP_FORCE_INLINE bool ch_mem_exceeds(u32_t more = 0) const {
+			return ch_mem_channel_exceeds(more) || channel_mem_budget_exceeds(more);
+		}
+
+		//unwatch the default read, return false if the read is not ours to pause
+		bool ch_mem_pause_read();
+		//rewatch read if the outbound bytes of both the channel and the process are under the watermark, return false if not yet
+		bool ch_mem_resume_read();
 		inline void ch_set_connected() {
 			NETP_ASSERT( (m_chflag&int(channel_flag::F_CLOSED)) ==0 );
 			m_chflag &= ~int(channel_flag::F_CONNECTING);
@@ -250,8 +396,15 @@ public: \
 			return intp;\
 		} \
 		inline void ch_##NAME(NRP<promise<int>> const& intp) { \
-			L->execute([_ch=NRP<channel>(this), intp]() { \
+			if (m_loop_binding->in_event_loop()) { \
+				/*no std::function on the hot path, hold this as the task does*/ \
+				const NRP<channel> _ch(this); \
 				_ch->__ch_##NAME(intp); \
+				return; \
+			} \
+			/*check again in the task, the channel might have been migrated in between*/ \
+			m_loop_binding->get()->schedule([_ch=NRP<channel>(this), intp]() { \
+				_ch->channel::ch_##NAME(intp); \
 			}); \
 		} \
 
@@ -275,10 +428,19 @@ public: \
 			return intp; \
 		} \
 		inline void ch_##NAME(NRP<promise<int>> const& intp, NRP<packet> const& outlet) {\
-			L->execute([_ch=NRP<channel>(this), intp, outlet]() { \
+			if (m_loop_binding->in_event_loop()) { \
+				const NRP<channel> _ch(this); \
 				_ch->__ch_##NAME(intp, outlet); \
+				return; \
+			} \
+			m_loop_binding->get()->schedule([_ch=NRP<channel>(this), intp, outlet]() { \
+				_ch->ch_##NAME(intp, outlet); \
 			}); \
 		} \
+		/*no promise, write errors are reported by the close path only*/ \
+		inline void ch_##NAME##_void(NRP<packet> const& outlet) {\
+			ch_##NAME(void_promise(),outlet); \
+		} \
 
 		CH_FUTURE_ACTION_IMPL_PACKET(write);
 
@@ -298,10 +460,18 @@ public: \
 			return intp; \
 		} \
 		inline void ch_##NAME(NRP<promise<int>> const& intp, NRP<packet> const& outlet, NRP<address> const& to) {\
-			L->execute([_ch=NRP<channel>(this),intp, outlet, to]() { \
+			if (m_loop_binding->in_event_loop()) { \
+				const NRP<channel> _ch(this); \
 				_ch->__ch_##NAME(intp,outlet,to); \
+				return; \
+			} \
+			m_loop_binding->get()->schedule([_ch=NRP<channel>(this),intp, outlet, to]() { \
+				_ch->ch_##NAME(intp,outlet,to); \
 			}); \
 		} \
+		inline void ch_##NAME##_void(NRP<packet> const& outlet, NRP<address> const& to) {\
+			ch_##NAME(void_promise(),outlet,to); \
+		} \
 
 	CH_FUTURE_ACTION_IMPL_PACKET_ADDR(write_to);
 
@@ -330,6 +500,29 @@ public: \
 		virtual std::string ch_info() const = 0;
 		virtual void ch_set_bdlimit(u32_t) {};
 
+		//move this channel to another loop of the same poller type
+		//io is unwatched from the current loop, outbound entries stay in the channel and would be flushed by the new loop
+		//handlers with CH_ACTIVITY_LOOP_MIGRATED get loop_migrated() in the new loop before the promise is set
+		inline NRP<promise<int>> ch_migrate_to(NRP<io_event_loop> const& to) {
+			const NRP<promise<int>> intp = netp::make_ref<promise<int>>();
+			ch_migrate_to(intp, to);
+			return intp;
+		}
+		inline void ch_migrate_to(NRP<promise<int>> const& intp, NRP<io_event_loop> const& to) {
+			//always delay to the next tick, we might be in the middle of a io callback
+			m_loop_binding->get()->schedule([_ch = NRP<channel>(this), intp, to]() {
+				if (NETP_UNLIKELY(!_ch->m_loop_binding->in_event_loop())) {
+					_ch->ch_migrate_to(intp, to);
+					return;
+				}
+				_ch->ch_migrate_to_impl(intp, to);
+			});
+		}
+		virtual void ch_migrate_to_impl(NRP<promise<int>> const& intp, NRP<io_event_loop> const& to) {
+			(void)to;
+			intp->set(netp::E_INVALID_OPERATION);
+		}
+
 		virtual NRP<promise<int>> ch_set_read_buffer_size(u32_t size) = 0;
 		virtual NRP<promise<int>> ch_get_read_buffer_size() = 0;
 
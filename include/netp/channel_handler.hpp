@@ -8,6 +8,7 @@
 namespace netp {
 
 	struct address;
+	class io_event_loop;
 	class channel_handler_context;
 
 	enum channel_handler_api {
@@ -32,7 +33,16 @@ namespace netp {
 		CH_OUTBOUND = (CH_OUTBOUND_WRITE|CH_OUTBOUND_FLUSH | CH_OUTBOUND_CLOSE | CH_OUTBOUND_CLOSE_READ | CH_OUTBOUND_CLOSE_WRITE| CH_OUTBOUND_WRITE_TO),
 		CH_INBOUND = (CH_INBOUND_READ|CH_INBOUND_READ_FROM),
 
-		CH_CTX_DEATTACHED = 1<<14
+		CH_CTX_DEATTACHED = 1<<14,
+
+		//fired on the new loop after the channel has been migrated by ch_migrate_to
+		CH_ACTIVITY_LOOP_MIGRATED = 1<<15,
+
+		//user defined inbound event, fired by ctx->fire_user_event(evt), see handler::idle_state
+		CH_INBOUND_USER_EVENT = 1<<16,
+
+		//fired once a read round (all the read()s for one readiness notification) is done
+		CH_INBOUND_READ_COMPLETE = 1<<17
 	};
 
 	class channel_handler_abstract :
@@ -40,10 +50,10 @@ namespace netp {
 	{
 		friend class channel_handler_context;
 		friend class channel_pipeline;
-		u16_t CH_H_FLAG;
+		u32_t CH_H_FLAG;
 
 	public:
-		channel_handler_abstract(u16_t flag) : CH_H_FLAG(flag)
+		channel_handler_abstract(u32_t flag) : CH_H_FLAG(flag)
 		{
 		}
 
@@ -55,12 +65,22 @@ namespace netp {
 		virtual void read_closed(NRP<channel_handler_context> const& ctx);
 		virtual void write_closed(NRP<channel_handler_context> const& ctx);
 
+		//ctx->L is the new loop already, loop local states (timers, caches) should be moved from <from>
+		virtual void loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from);
+
 		//for inbound
 		virtual void read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income);
 
+		//a good point to coalesce the output of the reads in this round, pass it on by ctx->fire_read_complete()
+		virtual void read_complete(NRP<channel_handler_context> const& ctx);
+
 		virtual void readfrom(NRP<channel_handler_context> const& ctx, NRP<packet> const& income, NRP<address> const& from);
 
+		//evt is opaque to the pipeline, pass it on by ctx->fire_user_event(evt) if it is not yours
+		virtual void user_event(NRP<channel_handler_context> const& ctx, int evt);
+
 		//for outbound
+		//intp of write/write_to is never nullptr, a void write (write_void) passes void_promise() on which set() does nothing
 		virtual void write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet);
 		virtual void flush(NRP<channel_handler_context> const& ctx);
 
@@ -93,7 +113,7 @@ namespace netp {
 	{
 	public:
 		channel_handler_tail() :
-			channel_handler_abstract(CH_ACTIVITY|CH_INBOUND)
+			channel_handler_abstract(CH_ACTIVITY|CH_INBOUND|CH_ACTIVITY_LOOP_MIGRATED|CH_INBOUND_USER_EVENT|CH_INBOUND_READ_COMPLETE)
 		{}
 	protected:
 		void connected(NRP<channel_handler_context> const& ctx);
@@ -101,9 +121,12 @@ namespace netp {
 		void error(NRP<channel_handler_context> const& ctx, int err);
 		void read_closed(NRP<channel_handler_context> const& ctx);
 		void write_closed(NRP<channel_handler_context> const& ctx);
+		void loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from);
 
 		void read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) ;
+		void read_complete(NRP<channel_handler_context> const& ctx);
 		void readfrom(NRP<channel_handler_context> const& ctx, NRP<packet> const& income, NRP<address> const& from);
+		void user_event(NRP<channel_handler_context> const& ctx, int evt);
 	};
 }
 #endif
@@ -2,110 +2,109 @@
 #define _NETP_CHANNEL_HANDLER_CONTEXT_HPP
 
 #include <netp/io_event_loop.hpp>
+#include <netp/arena.hpp>
 #include <netp/channel_handler.hpp>
 #include <netp/address.hpp>
 
-/*head,tail never removed by iterate*/
-#define CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,DIR) \
-__ctx_iterate_begin: \
+/*
+ * NX[LINK] is the next context interested in LINK, inbound links go to the tail side, outbound links go to the head side
+ * links are rebuilt by channel_pipeline::__relink on add/remove, deattached contexts are never a link target
+ * head,tail never removed, head has all the outbound flags, tail has all the inbound flags, so a link is never null for a linked context
+ */
+#define CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+	channel_handler_context* _ctx = NX[LINK]; \
 	NETP_ASSERT(_ctx != nullptr); \
-	if (NETP_UNLIKELY(_ctx->H_FLAG&CH_CTX_DEATTACHED)) { \
-		_ctx->N->P = _ctx->P; \
-		_ctx->P->N = _ctx->N; \
-		_ctx = _ctx->DIR; \
-		goto __ctx_iterate_begin; \
-	} \
-	if(!(_ctx->H_FLAG&HANDLER_FLAG)) \
-	{ \
-		_ctx = _ctx->DIR; \
-		goto __ctx_iterate_begin; \
-	} \
 
+#define CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(LINK) \
+	channel_handler_context* _ctx = ((H_FLAG&(__ctx_link_flag[LINK]|CH_CTX_DEATTACHED)) == __ctx_link_flag[LINK]) ? this : NX[LINK]; \
+	NETP_ASSERT(_ctx != nullptr); \
 
-#define VOID_INVOKE(NAME,HANDLER_FLAG) \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,N) \
-	_ctx->H->NAME(_ctx); \
+#define VOID_INVOKE(NAME,LINK) \
+	_ctx->H->NAME(*_ctx->S); \
 
-#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(NAME,HANDLER_FLAG) \
+#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(NAME,LINK) \
 	inline void fire_##NAME() const { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = N; \
-		VOID_INVOKE(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+		VOID_INVOKE(NAME,LINK); \
 	} \
 	inline void invoke_##NAME() { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = NRP<channel_handler_context>(this); \
-		VOID_INVOKE(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(LINK) \
+		VOID_INVOKE(NAME,LINK); \
 	}
 
-#define VOID_INVOKE_INT_1(NAME,HANDLER_FLAG) \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,N) \
-	_ctx->H->NAME(_ctx,i); \
+#define VOID_INVOKE_INT_1(NAME,LINK) \
+	_ctx->H->NAME(*_ctx->S,i); \
 
-#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_INT_1(NAME,HANDLER_FLAG) \
+#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_INT_1(NAME,LINK) \
 	inline void fire_##NAME( int i ) const { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = N; \
-		VOID_INVOKE_INT_1(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+		VOID_INVOKE_INT_1(NAME,LINK); \
 	} \
 	inline void invoke_##NAME(int i) { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = NRP<channel_handler_context>(this); \
-		VOID_INVOKE_INT_1(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(LINK) \
+		VOID_INVOKE_INT_1(NAME,LINK); \
 	} \
 
-#define VOID_INVOKE_PACKET(NAME,HANDLER_FLAG) \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,N) \
-	_ctx->H->NAME(_ctx,p); \
+#define VOID_INVOKE_PACKET(NAME,LINK) \
+	_ctx->H->NAME(*_ctx->S,p); \
 
 
-#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_1(NAME,HANDLER_FLAG) \
+#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_1(NAME,LINK) \
 	inline void fire_##NAME( NRP<packet> const& p ) const { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = N; \
-		VOID_INVOKE_PACKET(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+		VOID_INVOKE_PACKET(NAME,LINK); \
 	} \
 	inline void invoke_##NAME( NRP<packet> const& p ) { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = NRP<channel_handler_context>(this); \
-		VOID_INVOKE_PACKET(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(LINK) \
+		VOID_INVOKE_PACKET(NAME,LINK); \
 	} \
 
-#define VOID_INVOKE_PACKET_ADDR(NAME,HANDLER_FLAG) \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,N) \
-	_ctx->H->NAME(_ctx,p,addr); \
+#define VOID_INVOKE_PACKET_ADDR(NAME,LINK) \
+	_ctx->H->NAME(*_ctx->S,p,addr); \
 
-#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_ADDR(NAME,HANDLER_FLAG) \
+#define VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_ADDR(NAME,LINK) \
 	inline void fire_##NAME( NRP<packet> const& p, NRP<address> const& addr ) const { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = N; \
-		VOID_INVOKE_PACKET_ADDR(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+		VOID_INVOKE_PACKET_ADDR(NAME,LINK); \
 	} \
 	inline void invoke_##NAME( NRP<packet> const& p, NRP<address> const& addr ) { \
 		NETP_ASSERT(L->in_event_loop()); \
-		NRP<channel_handler_context>_ctx = NRP<channel_handler_context>(this); \
-		VOID_INVOKE_PACKET_ADDR(NAME,HANDLER_FLAG); \
+		CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(LINK) \
+		VOID_INVOKE_PACKET_ADDR(NAME,LINK); \
 	} \
 
 //--T_TO_H--BEGIN
-#define CH_PROMISE_INVOKE_PREV_PACKET_CH_PROMISE(NAME,HANDLER_FLAG) \
-	NRP<channel_handler_context>_ctx = P; \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,P) \
-	_ctx->H->NAME(intp,_ctx,p); \
+#define CH_PROMISE_INVOKE_PREV_PACKET_CH_PROMISE(NAME,LINK) \
+	CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+	_ctx->H->NAME(intp,*_ctx->S,p); \
 
-#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_CH_PROMISE(NAME,HANDLER_FLAG) \
+#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_CH_PROMISE(NAME,LINK) \
 private:\
 	inline void __##NAME(NRP<promise<int>> const& intp, NRP<packet> const& p) { \
 		if( NETP_UNLIKELY(H_FLAG&CH_CTX_DEATTACHED) ) {\
 			intp->set(netp::E_CHANNEL_CONTEXT_DEATTACHED); \
 			return; \
 		} \
-		CH_PROMISE_INVOKE_PREV_PACKET_CH_PROMISE(NAME,HANDLER_FLAG) \
+		CH_PROMISE_INVOKE_PREV_PACKET_CH_PROMISE(NAME,LINK) \
 	} \
 public:\
 	inline void NAME(NRP<promise<int>> const& intp, NRP<packet> const& p) { \
-		L->execute([ctx=NRP<channel_handler_context>(this),intp, p]() { \
+		if (LB->in_event_loop()) { \
+			/*no std::function on the hot path, hold this as the task does*/ \
+			const NRP<channel_handler_context> ctx(this); \
 			ctx->__##NAME(intp,p); \
+			return; \
+		} \
+		/*check again in the task, the channel might have been migrated in between*/ \
+		LB->get()->schedule([ctx=NRP<channel_handler_context>(this),intp, p]() { \
+			ctx->NAME(intp,p); \
 		}); \
 	} \
 	inline NRP<promise<int>> NAME(NRP<packet> const& p) { \
@@ -113,25 +112,33 @@ public:\
 		NAME(intp,p); \
 		return intp; \
 	} \
+	/*no promise, errors go to the close path*/ \
+	inline void NAME##_void(NRP<packet> const& p) { \
+		NAME(void_promise(),p); \
+	} \
 
-#define CH_PROMISE_INVOKE_PREV_PACKET_ADDR_CH_PROMISE(NAME,HANDLER_FLAG) \
-	NRP<channel_handler_context>_ctx = P; \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,P) \
-	_ctx->H->NAME(intp,_ctx,p,to); \
+#define CH_PROMISE_INVOKE_PREV_PACKET_ADDR_CH_PROMISE(NAME,LINK) \
+	CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+	_ctx->H->NAME(intp,*_ctx->S,p,to); \
 
-#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_ADDR_CH_PROMISE(NAME,HANDLER_FLAG) \
+#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_ADDR_CH_PROMISE(NAME,LINK) \
 private:\
 	inline void __##NAME(NRP<promise<int>> const& intp, NRP<packet> const& p, NRP<address> const& to) { \
 		if( NETP_UNLIKELY(H_FLAG&CH_CTX_DEATTACHED) ) {\
 			intp->set(netp::E_CHANNEL_CONTEXT_DEATTACHED); \
 			return; \
 		} \
-		CH_PROMISE_INVOKE_PREV_PACKET_ADDR_CH_PROMISE(NAME,HANDLER_FLAG) \
+		CH_PROMISE_INVOKE_PREV_PACKET_ADDR_CH_PROMISE(NAME,LINK) \
 	} \
 public:\
 	inline void NAME(NRP<promise<int>> const& intp, NRP<packet> const& p, NRP<address> const& to) { \
-		L->execute([ctx=NRP<channel_handler_context>(this), p, to,intp]() { \
+		if (LB->in_event_loop()) { \
+			const NRP<channel_handler_context> ctx(this); \
 			ctx->__##NAME(intp,p,to); \
+			return; \
+		} \
+		LB->get()->schedule([ctx=NRP<channel_handler_context>(this), p, to,intp]() { \
+			ctx->NAME(intp,p,to); \
 		}); \
 	} \
 	inline NRP<promise<int>> NAME(NRP<packet> const& p, NRP<address> const& to) { \
@@ -139,25 +146,32 @@ public:\
 		NAME(intp,p,to); \
 		return intp;\
 	} \
+	inline void NAME##_void(NRP<packet> const& p, NRP<address> const& to) { \
+		NAME(void_promise(),p,to); \
+	} \
 
-#define CH_PROMISE_INVOKE_PREV_CH_PROMISE(NAME,HANDLER_FLAG) \
-	NRP<channel_handler_context>_ctx = P; \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,P) \
-	_ctx->H->NAME(intp,_ctx); \
+#define CH_PROMISE_INVOKE_PREV_CH_PROMISE(NAME,LINK) \
+	CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+	_ctx->H->NAME(intp,*_ctx->S); \
 
-#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(NAME,HANDLER_FLAG) \
+#define CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(NAME,LINK) \
 private:\
 	inline void __##NAME(NRP<promise<int>> const& intp) { \
 		if( NETP_UNLIKELY(H_FLAG&CH_CTX_DEATTACHED) ) {\
 			intp->set(netp::E_CHANNEL_CONTEXT_DEATTACHED); \
 			return; \
 		} \
-		CH_PROMISE_INVOKE_PREV_CH_PROMISE(NAME,HANDLER_FLAG) \
+		CH_PROMISE_INVOKE_PREV_CH_PROMISE(NAME,LINK) \
 	} \
 public:\
 	inline void NAME(NRP<promise<int>> const& intp) { \
-		L->execute([ctx=NRP<channel_handler_context>(this), intp]() { \
+		if (LB->in_event_loop()) { \
+			const NRP<channel_handler_context> ctx(this); \
 			ctx->__##NAME(intp); \
+			return; \
+		} \
+		LB->get()->schedule([ctx=NRP<channel_handler_context>(this), intp]() { \
+			ctx->NAME(intp); \
 		}); \
 	} \
 	inline NRP<promise<int>> NAME() { \
@@ -166,58 +180,141 @@ public:\
 		return f;\
 	} \
 
-#define CH_PROMISE_INVOKE_PREV(NAME,HANDLER_FLAG) \
-	NRP<channel_handler_context>_ctx = P; \
-	CHANNEL_HANDLER_CONTEXT_ITERATE_CTX(HANDLER_FLAG,P) \
-	_ctx->H->NAME(_ctx); \
+#define CH_PROMISE_INVOKE_PREV(NAME,LINK) \
+	CHANNEL_HANDLER_CONTEXT_NEXT_CTX(LINK) \
+	_ctx->H->NAME(*_ctx->S); \
 
 //--T_TO_H--END
 
 namespace netp {
 
+	enum channel_handler_context_link {
+		//inbound, to the tail side
+		CTX_LINK_CONNECTED,
+		CTX_LINK_CLOSED,
+		CTX_LINK_ERROR,
+		CTX_LINK_READ_CLOSED,
+		CTX_LINK_WRITE_CLOSED,
+		CTX_LINK_READ,
+		CTX_LINK_READ_FROM,
+		CTX_LINK_USER_EVENT,
+		CTX_LINK_LOOP_MIGRATED,
+		CTX_LINK_READ_COMPLETE,
+		CTX_LINK_INBOUND_MAX,
+
+		//outbound, to the head side
+		CTX_LINK_WRITE = CTX_LINK_INBOUND_MAX,
+		CTX_LINK_CLOSE,
+		CTX_LINK_CLOSE_READ,
+		CTX_LINK_CLOSE_WRITE,
+		CTX_LINK_WRITE_TO,
+		CTX_LINK_MAX
+	};
+
+	static constexpr u32_t __ctx_link_flag[CTX_LINK_MAX] = {
+		CH_ACTIVITY_CONNECTED,
+		CH_ACTIVITY_CLOSED,
+		CH_ACTIVITY_ERROR,
+		CH_ACTIVITY_READ_CLOSED,
+		CH_ACTIVITY_WRITE_CLOSED,
+		CH_INBOUND_READ,
+		CH_INBOUND_READ_FROM,
+		CH_INBOUND_USER_EVENT,
+		CH_ACTIVITY_LOOP_MIGRATED,
+		CH_INBOUND_READ_COMPLETE,
+
+		CH_OUTBOUND_WRITE,
+		CH_OUTBOUND_CLOSE,
+		CH_OUTBOUND_CLOSE_READ,
+		CH_OUTBOUND_CLOSE_WRITE,
+		CH_OUTBOUND_WRITE_TO
+	};
+
 	class channel;
+	template <class H> class dynamic_stage;
+
 	class channel_handler_context final:
 		public ref_base
 	{
 	public:
 		friend class channel_pipeline;
-		NRP<io_event_loop> L;
+		template <class H> friend class dynamic_stage;
+		//the L of ch, for the code running in it
+		NRP<io_event_loop> const& L;
 		NRP<netp::channel> ch;
 	private:
-		u16_t H_FLAG;
-		NRP<channel_handler_context> P;
-		NRP<channel_handler_context> N;
+		//the loop binding of ch, for the calls from other threads
+		loop_binding* LB;
+		u32_t H_FLAG;
+		//raw links, contexts are owned by channel_pipeline and only be linked/unlinked in L
+		channel_handler_context* P;
+		channel_handler_context* N;
+		//the owner slot in channel_pipeline, handlers get their ctx by it without a ref count inc/dec
+		NRP<channel_handler_context> const* S;
 		NRP<channel_handler_abstract> H;
+		//per event links, a fire is a single jump no matter how many handlers in between are not interested in
+		channel_handler_context* NX[CTX_LINK_MAX];
+		//request scoped allocations of the handler, created on first use
+		NRP<netp::arena> m_arena;
 
 	public:
 		channel_handler_context(NRP<netp::channel> const& ch_, NRP<channel_handler_abstract> const& h);
 
-		inline void do_remove_from_pipeline(NRP<netp::promise<int>> const& p) {
+		void do_remove_from_pipeline(NRP<netp::promise<int>> const& p);
+
+		inline bool is_deattached() { return (H_FLAG & CH_CTX_DEATTACHED); }
+
+		inline NRP<netp::arena> const& arena() {
 			NETP_ASSERT(L->in_event_loop());
-			//HEAD,TAIL will never BE REMOVED from outside
-			NETP_ASSERT(P != nullptr && N != nullptr );
-			H_FLAG |= CH_CTX_DEATTACHED;
+			if (m_arena == nullptr) {
+				m_arena = netp::make_ref<netp::arena>();
+			}
+			return m_arena;
+		}
 
-			p->set(netp::OK);
+		//call it once a request is done, everything allocated for it is freed in one go, no block is kept
+		//if some of them are still held, the old arena is left to the holders and a new one takes its place
+		inline void arena_reset() {
+			NETP_ASSERT(L->in_event_loop());
+			if ((m_arena != nullptr) && !m_arena->reset()) {
+				m_arena = netp::make_ref<netp::arena>();
+			}
 		}
 
-		inline bool is_deattached() { return (H_FLAG & CH_CTX_DEATTACHED); }
+		//something of the request is still held (a live() of 0 says nothing about an empty container), leave the arena to it
+		inline void arena_release() {
+			NETP_ASSERT(L->in_event_loop());
+			m_arena = nullptr;
+		}
 
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(connected, CH_ACTIVITY_CONNECTED)
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(closed, CH_ACTIVITY_CLOSED)
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(read_closed, CH_ACTIVITY_READ_CLOSED)
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(write_closed, CH_ACTIVITY_WRITE_CLOSED)
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_INT_1(error, CH_ACTIVITY_ERROR)
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_1(read, CH_INBOUND_READ)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(connected, CTX_LINK_CONNECTED)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(closed, CTX_LINK_CLOSED)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(read_closed, CTX_LINK_READ_CLOSED)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(write_closed, CTX_LINK_WRITE_CLOSED)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_INT_1(error, CTX_LINK_ERROR)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_1(read, CTX_LINK_READ)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_0(read_complete, CTX_LINK_READ_COMPLETE)
 
-		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_ADDR(readfrom, CH_INBOUND_READ_FROM)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_PACKET_ADDR(readfrom, CTX_LINK_READ_FROM)
+		VOID_FIRE_HANDLER_CONTEXT_IMPL_H_TO_T_INT_1(user_event, CTX_LINK_USER_EVENT)
+
+		inline void fire_loop_migrated(NRP<io_event_loop> const& from) const {
+			NETP_ASSERT(L->in_event_loop());
+			CHANNEL_HANDLER_CONTEXT_NEXT_CTX(CTX_LINK_LOOP_MIGRATED)
+			_ctx->H->loop_migrated(*_ctx->S, from);
+		}
+		inline void invoke_loop_migrated(NRP<io_event_loop> const& from) {
+			NETP_ASSERT(L->in_event_loop());
+			CHANNEL_HANDLER_CONTEXT_THIS_OR_NEXT_CTX(CTX_LINK_LOOP_MIGRATED)
+			_ctx->H->loop_migrated(*_ctx->S, from);
+		}
 
-		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_CH_PROMISE(write, CH_OUTBOUND_WRITE)
-		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close, CH_OUTBOUND_CLOSE)
-		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close_read, CH_OUTBOUND_CLOSE_READ)
-		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close_write, CH_OUTBOUND_CLOSE_WRITE)
+		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_CH_PROMISE(write, CTX_LINK_WRITE)
+		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close, CTX_LINK_CLOSE)
+		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close_read, CTX_LINK_CLOSE_READ)
+		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PROMISE(close_write, CTX_LINK_CLOSE_WRITE)
 
-		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_ADDR_CH_PROMISE(write_to, CH_OUTBOUND_WRITE_TO);
+		CH_PROMISE_ACTION_HANDLER_CONTEXT_IMPL_T_TO_H_PACKET_ADDR_CH_PROMISE(write_to, CTX_LINK_WRITE_TO);
 	};
 }
 #endif
\ No newline at end of file
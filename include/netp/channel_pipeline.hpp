@@ -1,6 +1,8 @@
 #ifndef _NETP_CHANNEL_PIPELINE_HPP
 #define _NETP_CHANNEL_PIPELINE_HPP
 
+#include <list>
+
 #include <netp/core.hpp>
 #include <netp/packet.hpp>
 #include <netp/address.hpp>
@@ -37,6 +39,9 @@
 		m_tail->NAME(intp,packet_); \
 		return intp; \
 	}\
+	__NETP_FORCE_INLINE void NAME##_void(NRP<packet> const& packet_) const {\
+		m_tail->NAME(void_promise(),packet_); \
+	}\
 
 #define PIPELINE_ACTION_PACKET_ADDR(NAME) \
 	__NETP_FORCE_INLINE void NAME( NRP<promise<int>> const& intp, NRP<packet> const& packet_, NRP<address> const& to) {\
@@ -47,6 +52,9 @@
 		m_tail->NAME(intp, packet_,to); \
 		return intp; \
 	}\
+	__NETP_FORCE_INLINE void NAME##_void(NRP<packet> const& packet_, NRP<address> const& to) const {\
+		m_tail->NAME(void_promise(), packet_,to); \
+	}\
 
 #define PIPELINE_CH_FUTURE_ACTION_VOID(NAME) \
 	NRP<promise<int>> NAME() {\
@@ -71,11 +79,14 @@ namespace netp {
 		friend class channel;
 
 	private:
-		NRP<io_event_loop> m_loop;
+		NRP<loop_binding> m_loop_binding;
 		NRP<channel> m_ch;
 		//tail,head is boundary
 		NRP<channel_handler_context> m_head;
 		NRP<channel_handler_context> m_tail;
+		//owner of the contexts in between, a node never moves, so ctx->S stays valid until it's erased
+		typedef std::list<NRP<channel_handler_context>, netp::allocator<NRP<channel_handler_context>>> context_list_t;
+		context_list_t m_ctxs;
 
 	public:
 		channel_pipeline(NRP<channel> const& ch);
@@ -85,21 +96,30 @@ namespace netp {
 		void deinit();
 
 		void do_add_last(NRP<channel_handler_abstract> const& h, NRP<netp::add_handler_promise> const& p ) {
-			NETP_ASSERT(m_loop->in_event_loop());
+			NETP_ASSERT(m_loop_binding->in_event_loop());
 			NETP_ASSERT(m_ch != nullptr);
-			NRP<channel_handler_context> ctx = netp::make_ref<channel_handler_context>(m_ch, h);
-			ctx->N = m_tail;
+			m_ctxs.push_back(netp::make_ref<channel_handler_context>(m_ch, h));
+			NRP<channel_handler_context> const& ctx = m_ctxs.back();
+			ctx->S = &ctx;
+			ctx->N = m_tail.get();
 			ctx->P = m_tail->P;
 
-			m_tail->P->N = ctx;
-			m_tail->P = ctx;
+			m_tail->P->N = ctx.get();
+			m_tail->P = ctx.get();
+			__relink();
 
 			p->set(std::make_tuple(netp::OK, ctx));
 		}
 
+		//rebuild the per event links of all the contexts, O(n*CTX_LINK_MAX), only on add/remove
+		void __relink();
+
+		//unlink&release the contexts removed by do_remove_from_pipeline, must be called out of any iterate
+		void __purge_deattached();
+
 		NRP<netp::add_handler_promise> add_last(NRP<channel_handler_abstract> const& h) {
 			NRP<netp::add_handler_promise> p = netp::make_ref<netp::add_handler_promise>();
-			m_loop->execute([ppl = NRP<channel_pipeline>(this), h, p]() -> void {
+			m_loop_binding->execute([ppl = NRP<channel_pipeline>(this), h, p]() -> void {
 				ppl->do_add_last(h,p);
 			});
 			return p;
@@ -112,8 +132,14 @@ namespace netp {
 		PIPELINE_VOID_FIRE_VOID(read_closed)
 		PIPELINE_VOID_FIRE_VOID(write_closed)
 		PIPELINE_VOID_FIRE_PACKET_1(read)
+		PIPELINE_VOID_FIRE_VOID(read_complete)
 
 		PIPELINE_VOID_FIRE_PACKET_ADDR(readfrom)
+		PIPELINE_VOID_FIRE_INT_1(user_event)
+
+		__NETP_FORCE_INLINE void fire_loop_migrated(NRP<io_event_loop> const& from) const {
+			m_head->fire_loop_migrated(from);
+		}
 
 		PIPELINE_ACTION_PACKET(write)
 		PIPELINE_ACTION_PACKET_ADDR(write_to)
@@ -0,0 +1,194 @@
+#ifndef _NETP_COMPOSITE_PACKET_HPP_
+#define _NETP_COMPOSITE_PACKET_HPP_
+
+#include <deque>
+
+#include <netp/core.hpp>
+#include <netp/smart_ptr.hpp>
+#include <netp/bytes_helper.hpp>
+#include <netp/packet.hpp>
+
+namespace netp {
+
+	/*
+	 * @note
+	 * a chain of byte ranges of ref counted packets, [head,tail) of each segment is captured on append/prepend
+	 * 1, append/prepend/slice never copy bytes, a packet given to a composite must not be written (or grown) any more
+	 * 2, read/skip consume from the front, a segment is released once it's consumed
+	 * 3, flatten() copies only if there are more than one segment, to_iov() is for sendv
+	 * 4, hlen keeps the partial frames that do not go into its ring here, every read is copied once and the frame once on completion
+	 */
+	template <class _ref_base, class _packet_t>
+	class cap_composite_packet :
+		public _ref_base
+	{
+		typedef cap_composite_packet<_ref_base, _packet_t> composite_packet_t;
+
+	public:
+		struct segment {
+			NRP<_packet_t> p;
+			byte_t* head;
+			u32_t len;
+		};
+		typedef std::deque<segment, netp::allocator<segment>> segment_deque_t;
+
+	private:
+		segment_deque_t m_segments;
+		u32_t m_len;
+
+		inline void _peek(byte_t* dst, u32_t len_) const {
+			typename segment_deque_t::const_iterator it = m_segments.begin();
+			while (len_ > 0) {
+				NETP_ASSERT(it != m_segments.end());
+				const u32_t c = len_ < it->len ? len_ : it->len;
+				std::memcpy(dst, it->head, c);
+				dst += c;
+				len_ -= c;
+				++it;
+			}
+		}
+
+	public:
+		cap_composite_packet() :
+			m_len(0)
+		{}
+
+		explicit cap_composite_packet(NRP<_packet_t> const& p) :
+			m_len(0)
+		{
+			append(p);
+		}
+
+		__NETP_FORCE_INLINE u32_t len() const { return m_len; }
+		__NETP_FORCE_INLINE size_t segment_count() const { return m_segments.size(); }
+		__NETP_FORCE_INLINE segment const& segment_at(size_t idx) const { return m_segments[idx]; }
+		__NETP_FORCE_INLINE bool is_contiguous() const { return m_segments.size() < 2; }
+
+		inline void append(NRP<_packet_t> const& p) {
+			NETP_ASSERT(p != nullptr);
+			const u32_t plen = p->len();
+			if (plen == 0) { return; }
+			NETP_ASSERT((u64_t(m_len) + plen) <= PACK_MAX_CAPACITY);
+			m_segments.push_back({ p, p->head(), plen });
+			m_len += plen;
+		}
+
+		inline void prepend(NRP<_packet_t> const& p) {
+			NETP_ASSERT(p != nullptr);
+			const u32_t plen = p->len();
+			if (plen == 0) { return; }
+			NETP_ASSERT((u64_t(m_len) + plen) <= PACK_MAX_CAPACITY);
+			m_segments.push_front({ p, p->head(), plen });
+			m_len += plen;
+		}
+
+		//share all the segments of other
+		inline void append(NRP<composite_packet_t> const& other) {
+			NETP_ASSERT(other != nullptr && other.get() != this);
+			NETP_ASSERT((u64_t(m_len) + other->m_len) <= PACK_MAX_CAPACITY);
+			m_segments.insert(m_segments.end(), other->m_segments.begin(), other->m_segments.end());
+			m_len += other->m_len;
+		}
+
+		//[offset, offset+len_) of this composite, shares the packets
+		NRP<composite_packet_t> slice(u32_t offset, u32_t len_) const {
+			NETP_ASSERT((u64_t(offset) + len_) <= m_len);
+			NRP<composite_packet_t> s = netp::make_ref<composite_packet_t>();
+			//offset may be len() here, there is no segment to walk to
+			if (len_ == 0) {
+				return s;
+			}
+			typename segment_deque_t::const_iterator it = m_segments.begin();
+			while (offset >= it->len) {
+				offset -= it->len;
+				++it;
+			}
+			while (len_ > 0) {
+				NETP_ASSERT(it != m_segments.end());
+				const u32_t c = (it->len - offset) < len_ ? (it->len - offset) : len_;
+				s->m_segments.push_back({ it->p, it->head + offset, c });
+				s->m_len += c;
+				len_ -= c;
+				offset = 0;
+				++it;
+			}
+			return s;
+		}
+
+		void skip(u32_t len_) {
+			NETP_ASSERT(len_ <= m_len);
+			m_len -= len_;
+			while (len_ > 0) {
+				segment& seg = m_segments.front();
+				if (len_ < seg.len) {
+					seg.head += len_;
+					seg.len -= len_;
+					return;
+				}
+				len_ -= seg.len;
+				m_segments.pop_front();
+			}
+		}
+
+		inline u32_t peek(byte_t* const dst, u32_t len_) const {
+			if ((dst == nullptr) || len_ == 0) { return 0; }
+			const u32_t c = len_ < m_len ? len_ : m_len;
+			_peek(dst, c);
+			return c;
+		}
+
+		inline u32_t read(byte_t* const dst, u32_t len_) {
+			const u32_t c = peek(dst, len_);
+			skip(c);
+			return c;
+		}
+
+		//T might cross segments
+		template <class T, class endian = netp::bytes_helper::big_endian>
+		inline T peek() const {
+			NETP_ASSERT(sizeof(T) <= m_len);
+			segment const& seg = m_segments.front();
+			if (NETP_LIKELY(sizeof(T) <= seg.len)) {
+				return endian::read_impl(seg.head, netp::bytes_helper::type<T>());
+			}
+			byte_t tmp[sizeof(T)];
+			_peek(tmp, sizeof(T));
+			return endian::read_impl(tmp, netp::bytes_helper::type<T>());
+		}
+
+		template <class T, class endian = netp::bytes_helper::big_endian>
+		inline T read() {
+			const T t = peek<T, endian>();
+			skip(sizeof(T));
+			return t;
+		}
+
+		//contiguous bytes, no copy for a whole single packet
+		NRP<_packet_t> flatten() const {
+			if (m_segments.size() == 1) {
+				segment const& seg = m_segments.front();
+				if (seg.head == seg.p->head() && seg.len == seg.p->len()) {
+					return seg.p;
+				}
+			}
+			NRP<_packet_t> p = netp::make_ref<_packet_t>(m_len);
+			for (typename segment_deque_t::const_iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+				p->write(it->head, it->len);
+			}
+			return p;
+		}
+
+		//fill at most max iov from the front, return the count filled
+		inline u32_t to_iov(iov_t* iov, u32_t max) const {
+			u32_t n = 0;
+			for (typename segment_deque_t::const_iterator it = m_segments.begin(); it != m_segments.end() && n < max; ++it) {
+				iov_set(iov[n++], it->head, it->len);
+			}
+			return n;
+		}
+	};
+
+	using composite_packet = cap_composite_packet<netp::ref_base, packet>;
+	using non_atomic_ref_composite_packet = cap_composite_packet<netp::non_atomic_ref_base, non_atomic_ref_packet>;
+}
+#endif
@@ -0,0 +1,104 @@
+#ifndef _NETP_COMPUTE_POOL_HPP_
+#define _NETP_COMPUTE_POOL_HPP_
+
+#include <deque>
+#include <vector>
+#include <functional>
+
+#include <netp/core.hpp>
+#include <netp/singleton.hpp>
+#include <netp/mutex.hpp>
+#include <netp/condition.hpp>
+#include <netp/thread.hpp>
+#include <netp/ws_deque.hpp>
+
+namespace netp {
+
+	typedef std::function<void()> fn_task_t;
+
+	class compute_pool;
+	class compute_worker final :
+		public netp::ref_base
+	{
+		friend class compute_pool;
+		NETP_DECLARE_NONCOPYABLE(compute_worker)
+
+		compute_pool* m_pool;
+		u32_t m_idx;
+		u32_t m_seed;
+		ws_deque<fn_task_t*> m_q;
+		NRP<netp::thread> m_th;
+
+		void __run();
+	public:
+		compute_worker(compute_pool* pool, u32_t idx) :
+			m_pool(pool),
+			m_idx(idx),
+			m_seed(idx*2654435761u + 1),
+			m_q(),
+			m_th(nullptr)
+		{}
+	};
+
+	/*
+	 * @note
+	 * work stealing pool for cpu bound jobs (compression, tls handshake, json encoding ...), do not block io_event_loop with them
+	 * 1, every worker owns a Chase-Lev deque, tasks posted from a worker go to its own deque (LIFO), idle workers steal (FIFO)
+	 * 2, tasks posted from other threads (loops) go to a shared injection queue
+	 * 3, a worker parks on a condition only if nothing could be taken or stolen
+	 *
+	 * started on the first execute() with cfg_worker_count() workers, stopped by app before the loops exit
+	 * use io_event_loop::offload() to get the result back in the loop
+	 */
+	class compute_pool final :
+		public netp::singleton<compute_pool>
+	{
+		friend class compute_worker;
+		NETP_DECLARE_NONCOPYABLE(compute_pool)
+
+		enum class pool_state {
+			S_IDLE,
+			S_RUNNING,
+			S_EXIT
+		};
+
+		std::atomic<u8_t> m_state;
+		u32_t m_worker_count;
+
+		netp::mutex m_mtx;
+		netp::condition_variable m_cond;
+		std::vector<NRP<compute_worker>> m_workers;
+
+		spin_mutex m_inject_mtx;
+		std::deque<fn_task_t*> m_inject;
+
+		//tasks queued but not taken yet
+		std::atomic<i64_t> m_pending;
+		std::atomic<u32_t> m_sleepers;
+		//execute() calls between the state check and the push, stop() drains after it drops to 0
+		std::atomic<u32_t> m_pushers;
+
+		bool _take(compute_worker* w, fn_task_t*& t);
+		void _park();
+		void _push(fn_task_t* t);
+	public:
+		compute_pool();
+		~compute_pool();
+
+		//0 means hardware_concurrency, take effect on next start
+		void cfg_worker_count(u32_t count);
+
+		int start();
+		//tasks not taken yet are dropped (destroyed without being run)
+		void stop();
+
+		inline u32_t worker_count() const { return u32_t(m_workers.size()); }
+
+		//return E_INVALID_STATE if the pool has been stopped
+		int execute(fn_task_t&& f);
+		int execute(fn_task_t const& f) {
+			return execute(fn_task_t(f));
+		}
+	};
+}
+#endif
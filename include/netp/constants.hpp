@@ -523,6 +523,7 @@ const int  E_ERANGE = -34;         /* Result too large */
 
 	const int E_CHANNEL_OVERLAPPED_OP_TRY = -34017;
 	const int E_CHANNEL_MISSING_MAKER = -34018;//custom socket channel must have its own maker
+	const int E_CHANNEL_MEM_LIMIT = -34019;//inbound accumulation of a codec over channel_max of the memory budget
 	const int E_FORWARDER_DOMAIN_LEN_EXCEED	= -35001;
 	const int E_FORWARDER_INVALID_IPV4					= -35002;
 	const int E_FORWARDER_DIAL_DST_FAILED			= -35003;
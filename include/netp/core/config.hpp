@@ -112,6 +112,15 @@
 
 #define NETP_RPC_QUEUE_SIZE (200)
 
+//opt-in c++20 coroutine awaitables, refer to netp/coroutine.hpp
+#if defined(NETP_ENABLE_COROUTINE)
+	#if defined(__cpp_impl_coroutine)
+		#define NETP_HAS_COROUTINE
+	#else
+		#error "NETP_ENABLE_COROUTINE requires c++20 coroutine support"
+	#endif
+#endif
+
 
 //#define NETP_ENABLE_WEBSOCKET
 
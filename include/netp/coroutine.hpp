@@ -0,0 +1,279 @@
+#ifndef _NETP_COROUTINE_HPP
+#define _NETP_COROUTINE_HPP
+
+#include <netp/core.hpp>
+
+//opt-in, define NETP_ENABLE_COROUTINE and build with c++20 (cmake -DNETP_ENABLE_COROUTINE=ON)
+#ifdef NETP_HAS_COROUTINE
+
+#include <coroutine>
+#include <deque>
+#include <tuple>
+#include <exception>
+
+#include <netp/exception.hpp>
+#include <netp/promise.hpp>
+#include <netp/timer.hpp>
+#include <netp/io_event_loop.hpp>
+#include <netp/channel_handler.hpp>
+#include <netp/channel_handler_context.hpp>
+
+/*
+ * @note
+ * every NRP<promise<V>> is awaitable, so are the apis built on it:
+ *	NRP<channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:80", initializer);
+ *	NRP<channel> ch = std::get<1>(co_await dp);
+ *	int rt = co_await ch->ch_write(p);
+ *	std::tuple<int, NRP<packet>> resp = co_await rpc->call(api_id, data);
+ *	co_await netp::co_sleep(std::chrono::seconds(1));
+ *
+ * @impl consideration
+ * 1, a coroutine suspended in a io_event_loop thread is always resumed in the same loop by schedule(), no matter which thread sets the promise
+ *	  it resumes in the thread that sets the promise if it was suspended in a non loop thread, the setter must hold a ref of the promise
+ * 2, co_task/co_future start eagerly, frames come from netp::allocator
+ * 3, an unset promise or a terminated loop leaves the frame suspended forever (leaked), just as a lost if_done callee does
+ * 4, gcc (at least up to 12) may destroy temporaries of a co_await full-expression twice, do not build a capturing lambda into
+ *	  a std::function argument in the same expression as co_await, get the promise in a separate statement first (as dial above)
+ * 5, an exception escaping a co_future body is rethrown to its awaiter, if_done watchers see co_error_value<V> (E_UNKNOWN)
+ *	  an exception escaping a co_task is logged and dropped, it never goes into the loop
+ */
+
+namespace netp {
+
+	struct co_frame_allocator {
+		static void* operator new(std::size_t size) {
+			void* p = netp::allocator<byte_t>::malloc(size);
+			NETP_ALLOC_CHECK(p, size);
+			return p;
+		}
+		static void operator delete(void* p, std::size_t size) {
+			netp::allocator<byte_t>::free((byte_t*)p);
+			(void)size;
+		}
+	};
+
+	//the value a co_future is set with when its body throws
+	template <class V>
+	struct co_error_value {
+		inline static V make(int) { return V(); }
+	};
+	template <>
+	struct co_error_value<int> {
+		inline static int make(int code) { return code; }
+	};
+	template <class... _Args>
+	struct co_error_value<std::tuple<int, _Args...>> {
+		inline static std::tuple<int, _Args...> make(int code) { return std::make_tuple(code, _Args()...); }
+	};
+
+	inline int co_exception_code(std::exception_ptr const& ep, char const* who) {
+		try {
+			std::rethrow_exception(ep);
+		} catch (netp::exception& e) {
+			NETP_ERR("[%s]unhandled exception: [%d]%s", who, e.code(), e.what());
+			return (e.code() != netp::OK) ? e.code() : netp::E_UNKNOWN;
+		} catch (std::exception& e) {
+			NETP_ERR("[%s]unhandled exception: %s", who, e.what());
+		} catch (...) {
+			NETP_ERR("[%s]unhandled unknown exception", who);
+		}
+		return netp::E_UNKNOWN;
+	}
+
+	template <class V>
+	struct promise_awaiter {
+		NRP<netp::promise<V>> p;
+
+		bool await_ready() const noexcept { return !p->is_idle(); }
+		bool await_suspend(std::coroutine_handle<> h) {
+			NRP<io_event_loop> L(tls_get<io_event_loop>());
+			if (!p->is_idle()) {
+				return false;
+			}
+			p->if_done([L, h](V const&) {
+				if (L == nullptr) {
+					h.resume();
+					return;
+				}
+				//never resume inside promise::set, the frame (and the last ref of the promise) may go away in it
+				L->schedule([h]() {
+					h.resume();
+				});
+			});
+			return true;
+		}
+		V await_resume() {
+			//pair with the release store in promise::set if it is set in another thread
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return p->get();
+		}
+	};
+
+	template <class V>
+	inline promise_awaiter<V> operator co_await(NRP<netp::promise<V>> const& p) {
+		return promise_awaiter<V>{ p };
+	}
+
+	//fire and forget
+	struct co_task {
+		struct promise_type :
+			public co_frame_allocator
+		{
+			co_task get_return_object() noexcept { return co_task(); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept {
+				(void)co_exception_code(std::current_exception(), "co_task");
+			}
+		};
+	};
+
+	//the exception is written before the promise is set, it is read by the awaiter after
+	template <class V>
+	class co_promise final :
+		public netp::promise<V>
+	{
+	public:
+		std::exception_ptr ep;
+	};
+
+	template <class V>
+	struct co_future_awaiter :
+		public promise_awaiter<V>
+	{
+		NRP<co_promise<V>> cp;
+
+		V await_resume() {
+			V v = promise_awaiter<V>::await_resume();
+			if (cp->ep) {
+				std::rethrow_exception(cp->ep);
+			}
+			return v;
+		}
+	};
+
+	//the result is delivered by a netp::promise, so a co_future could be awaited, or be watched by if_done()
+	template <class V = int>
+	struct co_future {
+		NRP<co_promise<V>> p;
+
+		struct promise_type :
+			public co_frame_allocator
+		{
+			NRP<co_promise<V>> p;
+			promise_type() :
+				p(netp::make_ref<co_promise<V>>())
+			{}
+			co_future get_return_object() noexcept { return co_future{ p }; }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_value(V const& v) { p->set(v); }
+			void unhandled_exception() noexcept {
+				p->ep = std::current_exception();
+				p->set(co_error_value<V>::make(co_exception_code(p->ep, "co_future")));
+			}
+		};
+
+		co_future_awaiter<V> operator co_await() const { return co_future_awaiter<V>{ { p }, p }; }
+	};
+
+	struct co_sleep_awaiter {
+		timer_duration_t delay;
+
+		bool await_ready() const noexcept { return delay.count() <= 0; }
+		bool await_suspend(std::coroutine_handle<> h) {
+			io_event_loop* L = tls_get<io_event_loop>();
+			NETP_ASSERT(L != nullptr, "co_sleep must be awaited in a io_event_loop");
+			NRP<netp::promise<int>> lf = netp::make_ref<netp::promise<int>>();
+			L->launch(netp::make_ref<netp::timer>(delay, [h](NRP<netp::timer> const&) {
+				h.resume();
+			}), lf);
+			//resume right now if the loop refused the timer
+			return lf->get() == netp::OK;
+		}
+		void await_resume() const noexcept {}
+	};
+
+	template <class dur>
+	inline co_sleep_awaiter co_sleep(dur const& delay) {
+		return co_sleep_awaiter{ std::chrono::duration_cast<timer_duration_t>(delay) };
+	}
+
+	/*
+	 * @note
+	 * pull style inbound for coroutines, put it at the end of the pipeline
+	 * packets are queued until read() is awaited, read() returns nullptr once the read side is closed
+	 * read() must be awaited in the channel's loop, one reader at a time
+	 * the reader is resumed by a loop task, never inside read()/closed(), the pipeline is not reentered by the coroutine
+	 */
+	class co_reader final :
+		public channel_handler_abstract
+	{
+		std::deque<NRP<packet>> m_q;
+		std::coroutine_handle<> m_waiter;
+		NRP<io_event_loop> m_waiter_L;
+		bool m_read_closed;
+
+		void _resume_waiter() {
+			if (!m_waiter) {
+				return;
+			}
+			std::coroutine_handle<> h = m_waiter;
+			m_waiter = nullptr;
+			NRP<io_event_loop> L;
+			L.swap(m_waiter_L);
+			L->schedule([r = NRP<co_reader>(this), h]() {
+				h.resume();
+			});
+		}
+	public:
+		co_reader() :
+			channel_handler_abstract(CH_INBOUND_READ|CH_ACTIVITY_READ_CLOSED|CH_ACTIVITY_CLOSED),
+			m_waiter(nullptr),
+			m_read_closed(false)
+		{}
+
+		void read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) override {
+			m_q.push_back(income);
+			_resume_waiter();
+			(void)ctx;
+		}
+		void read_closed(NRP<channel_handler_context> const& ctx) override {
+			m_read_closed = true;
+			_resume_waiter();
+			ctx->fire_read_closed();
+		}
+		void closed(NRP<channel_handler_context> const& ctx) override {
+			m_read_closed = true;
+			_resume_waiter();
+			ctx->fire_closed();
+		}
+
+		struct read_awaiter {
+			NRP<co_reader> r;
+
+			bool await_ready() const noexcept { return !r->m_q.empty() || r->m_read_closed; }
+			void await_suspend(std::coroutine_handle<> h) {
+				NETP_ASSERT(!r->m_waiter, "co_reader: one reader at a time");
+				io_event_loop* L = tls_get<io_event_loop>();
+				NETP_ASSERT(L != nullptr, "co_reader: read() must be awaited in the channel's loop");
+				r->m_waiter = h;
+				r->m_waiter_L = NRP<io_event_loop>(L);
+			}
+			NRP<packet> await_resume() {
+				if (r->m_q.empty()) {
+					return nullptr;
+				}
+				NRP<packet> p = std::move(r->m_q.front());
+				r->m_q.pop_front();
+				return p;
+			}
+		};
+
+		read_awaiter read() { return read_awaiter{ NRP<co_reader>(this) }; }
+	};
+}
+
+#endif //NETP_HAS_COROUTINE
+#endif
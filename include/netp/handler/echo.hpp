@@ -13,7 +13,7 @@ public:
 	echo() :channel_handler_abstract(CH_INBOUND_READ) {}
 	void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income)
 	{	
-		ctx->write(netp::make_ref<packet>(income->head(), income->len()));
+		ctx->write_void(netp::make_ref<packet>(income->head(), income->len()));
 	}
 };
 
@@ -1,14 +1,32 @@
 #ifndef  _NETP_HANDLER_HLEN_HPP
 #define _NETP_HANDLER_HLEN_HPP
 
+#include <vector>
+
 #include <netp/core.hpp>
 #include <netp/channel_handler.hpp>
+#include <netp/mirror_ringbuffer.hpp>
+#include <netp/composite_packet.hpp>
+
+//a frame smaller than this is copied out unless it is the rest of the income, a retained slice pins the whole read buffer
+#define NETP_HLEN_SLICE_MIN (4*1024)
+
+//the frames written in one read round are flushed earlier once they reach this size
+#define NETP_HLEN_BATCH_MAX (64*1024)
 
 namespace netp { namespace handler {
 
+	/*
+	 * @note
+	 * the frames written in a read round (read()s up to read_complete) go out as one ctx->write on read_complete,
+	 * a close or close_write flushes first, so do a read_closed
+	 * batching starts once read_complete has been seen, a transport without read_complete writes through
+	 */
 	class hlen final :
 		public channel_handler_abstract
 	{
+		typedef std::vector<NRP<promise<int>>, netp::allocator<NRP<promise<int>>>> promise_vector_t;
+
 		enum class parse_state {
 			S_READ_LEN,
 			S_READ_CONTENT
@@ -18,23 +36,48 @@ namespace netp { namespace handler {
 
 		parse_state m_state;
 		u32_t m_size;
-		NRP<packet> m_tmp;
+		//partial len or frame without a ring, the reads are chained instead of being concatenated again on every read
+		NRP<composite_packet> m_tmp;
+		//partial frames are appended here instead of being concatenated on every read, created on the first partial and kept until read_closed, setting one up costs a memfd and three mappings
+		NRP<mirror_ringbuffer> m_ring;
+		u32_t m_ring_capacity; //0 for no ring, a frame bigger than this goes by m_tmp
+		u32_t m_mem_charged; //bytes of m_tmp or m_ring accounted to the channel
 		bool m_read_closed;
+		bool m_read_complete_seen;
+		bool m_batching;
+		NRP<packet> m_batch; //len prefixed frames written in this read round
+		promise_vector_t m_batch_ps;
+
+		bool __ring_fill(NRP<channel_handler_context> const& ctx, NRP<packet> const& income);
+		bool __tmp_fill(NRP<channel_handler_context> const& ctx, NRP<packet> const& income);
+		void __keep_partial(NRP<packet> const& income);
+		void __mem_account(NRP<channel_handler_context> const& ctx, u32_t now);
+		void __batch_flush(NRP<channel_handler_context> const& ctx);
 	public:
-		hlen() :
-			channel_handler_abstract(CH_INBOUND_READ| CH_OUTBOUND_WRITE|CH_ACTIVITY_CONNECTED|CH_ACTIVITY_READ_CLOSED),
+		hlen(u32_t ring_capacity = 0) :
+			channel_handler_abstract(CH_INBOUND_READ|CH_INBOUND_READ_COMPLETE|CH_OUTBOUND_WRITE|CH_OUTBOUND_CLOSE|CH_OUTBOUND_CLOSE_WRITE|CH_ACTIVITY_CONNECTED|CH_ACTIVITY_CLOSED|CH_ACTIVITY_READ_CLOSED),
 			m_state(parse_state::S_READ_LEN),
 			m_size(0),
 			m_tmp(nullptr),
-			m_read_closed(true)
+			m_ring(nullptr),
+			m_ring_capacity(ring_capacity),
+			m_mem_charged(0),
+			m_read_closed(true),
+			m_read_complete_seen(false),
+			m_batching(false),
+			m_batch(nullptr)
 		{}
 
 		virtual ~hlen() {}
 		void connected(NRP<channel_handler_context> const& ctx) override;
+		void closed(NRP<channel_handler_context> const& ctx) override;
 		void read_closed(NRP<channel_handler_context> const& ctx) override;
 
 		void read( NRP<channel_handler_context> const& ctx, NRP<packet> const& income ) override;
+		void read_complete(NRP<channel_handler_context> const& ctx) override;
 		void write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet) override;
+		void close(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx) override;
+		void close_write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx) override;
 	};
 }}
 #endif
\ No newline at end of file
@@ -57,8 +57,9 @@ namespace netp { namespace handler {
 		NRP<netp::http::message> m_message_tmp;
 		NRP<address> m_from_tmp;
 
-		void __setup_parser( bool is_httpu = false );
+		void __setup_parser(NRP<netp::channel_handler_context> const& ctx, bool is_httpu = false );
 		void __unsetup_parser();
+		void __message_done(NRP<netp::http::parser> const& p);
 		int __http_parse(NRP<netp::http::parser> const& http_parser, NRP<netp::packet> const& income);
 	public:
 		http() :
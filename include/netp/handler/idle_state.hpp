@@ -0,0 +1,88 @@
+#ifndef _NETP_HANDLER_IDLE_STATE_HPP
+#define _NETP_HANDLER_IDLE_STATE_HPP
+
+#include <netp/core.hpp>
+#include <netp/timer.hpp>
+#include <netp/channel_handler.hpp>
+
+//idle events are fired with a precision of one wheel tick
+#ifndef NETP_IDLE_STATE_WHEEL_TICK_MS
+	#define NETP_IDLE_STATE_WHEEL_TICK_MS (500)
+#endif
+
+#ifndef NETP_IDLE_STATE_WHEEL_SLOTS
+	#define NETP_IDLE_STATE_WHEEL_SLOTS (256)
+#endif
+
+namespace netp { namespace handler {
+
+	//passed to user_event(ctx,evt)
+	enum idle_state_event {
+		IDLE_STATE_READ_IDLE = 0x1D01,
+		IDLE_STATE_WRITE_IDLE,
+		IDLE_STATE_ALL_IDLE
+	};
+
+	class idle_state_wheel;
+
+	/*
+	 * @note
+	 * read-idle: no read for read_idle, write-idle: no write for write_idle, all-idle: neither for all_idle
+	 * a zero duration disables the corresponding check
+	 * the event fires again for every further period the channel stays idle
+	 *
+	 * @impl consideration
+	 * there is no timer per channel, read()/write() only stamp the cached loop clock,
+	 * every loop owns one coarse timing wheel that rechecks a channel at its earliest deadline
+	 *
+	 * idle_state must be added before the channel is connected
+	 */
+	class idle_state final :
+		public channel_handler_abstract
+	{
+		friend class idle_state_wheel;
+		NETP_DECLARE_NONCOPYABLE(idle_state)
+
+		NRP<channel_handler_context> m_ctx;
+		timer_duration_t m_read_idle;
+		timer_duration_t m_write_idle;
+		timer_duration_t m_all_idle;
+
+		//max(last io, last idle event fired)
+		timer_timepoint_t m_last_read;
+		timer_timepoint_t m_last_write;
+		timer_timepoint_t m_last_all;
+
+		//bumped on closed/migrated, a stale wheel entry is dropped by the sweep
+		u32_t m_wheel_seq;
+		//where the entry of m_wheel_seq is, for the removal on closed
+		u32_t m_wheel_slot;
+		u32_t m_wheel_pos;
+
+		timer_timepoint_t _next_deadline() const;
+		//fire due events, return the next deadline, or _TIMER_TP_INFINITE if closed
+		timer_timepoint_t _check(timer_timepoint_t const& now);
+		void _watch();
+	public:
+		idle_state(timer_duration_t const& read_idle, timer_duration_t const& write_idle, timer_duration_t const& all_idle) :
+			channel_handler_abstract(CH_ACTIVITY_CONNECTED|CH_ACTIVITY_CLOSED|CH_ACTIVITY_LOOP_MIGRATED|CH_INBOUND_READ|CH_OUTBOUND_WRITE),
+			m_ctx(nullptr),
+			m_read_idle(read_idle),
+			m_write_idle(write_idle),
+			m_all_idle(all_idle),
+			m_wheel_seq(0),
+			m_wheel_slot(NETP_IDLE_STATE_WHEEL_SLOTS),
+			m_wheel_pos(0)
+		{}
+
+		virtual ~idle_state() {}
+
+		void connected(NRP<channel_handler_context> const& ctx) override;
+		void closed(NRP<channel_handler_context> const& ctx) override;
+		void loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from) override;
+
+		void read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) override;
+		void write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet) override;
+	};
+}}
+#endif
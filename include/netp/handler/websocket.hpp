@@ -130,6 +130,7 @@ namespace netp { namespace handler {
 		NSP<ws_frame> m_tmp_frame;
 
 		NRP<packet> m_tmp_message; //for fragmented message
+		u32_t m_mem_charged; //bytes of the partial frame&message accounted to the channel
 		websocket_type m_type;
 		state m_state;
 		u8_t m_message_opcode;
@@ -146,10 +147,13 @@ namespace netp { namespace handler {
 			int http_on_chunk_header(NRP<netp::http::parser> const& p);
 			int http_on_chunk_complete(NRP<netp::http::parser> const& p);
 
+			void _do_read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income);
+
 			public:
 				websocket(websocket_type t) :
 					channel_handler_abstract(CH_ACTIVITY_CONNECTED|CH_ACTIVITY_CLOSED | CH_INBOUND_READ | CH_OUTBOUND_WRITE|CH_OUTBOUND_CLOSE),
 					m_http_parser(nullptr),
+					m_mem_charged(0),
 					m_type(t),
 					m_state(state::S_IDLE),
 					m_message_opcode(OP_TEXT),
@@ -8,6 +8,7 @@
 #include <netp/core.hpp>
 #include <netp/packet.hpp>
 #include <netp/string.hpp>
+#include <netp/arena.hpp>
 
 #define NETP_HTTP_CR	"\r"
 #define NETP_HTTP_LF	"\n"
@@ -75,6 +76,9 @@ namespace netp { namespace http {
 	//1, all header fileds order from the src
 	//2, do not merge multi line header field when do forwarding
 
+	//@note: fields are allocated from A if given (a request scoped arena of the channel), otherwise from netp::allocator
+	//a header kept past its request is left the arena it was parsed on, detach() copies it to netp::allocator and gives the arena back
+
 	struct header final:
 		public netp::ref_base
 	{
@@ -83,25 +87,35 @@ namespace netp { namespace http {
 			size_t len;
 		};
 
-		typedef std::list<mul_hfv_pos> mul_header_filed_with_same_name_pos_list_t;
+		typedef std::list<mul_hfv_pos, netp::arena_allocator<mul_hfv_pos>> mul_header_filed_with_same_name_pos_list_t;
 		struct _header_line {
-			netp::string_t name;
-			netp::string_t value;
+			netp::arena_string_t name;
+			netp::arena_string_t value;
 			mul_header_filed_with_same_name_pos_list_t mul_hf_pos_list;
 		};
 
 		const static inline netp::size_t H_key(netp::string_t const& field) {
 			return ihash_seq((const unsigned char*)field.c_str(), field.length());
 		}
+		const static inline netp::size_t H_key(netp::arena_string_t const& field) {
+			return ihash_seq((const unsigned char*)field.c_str(), field.length());
+		}
 
-		typedef std::unordered_map<size_t, _header_line, std::hash<size_t>, std::equal_to<size_t>, netp::allocator<std::pair<const size_t, _header_line>>>	header_map;
+		typedef std::unordered_map<size_t, _header_line, std::hash<size_t>, std::equal_to<size_t>, netp::arena_allocator<std::pair<const size_t, _header_line>>>	header_map;
 		typedef std::pair<size_t, _header_line>	header_pair;
-		typedef std::list<netp::string_t, netp::allocator<netp::string_t>> keys_order_list_t;
+		typedef std::list<netp::arena_string_t, netp::arena_allocator<netp::arena_string_t>> keys_order_list_t;
 
+		//must be declared before the containers, they release to it on destruct
+		NRP<netp::arena> A;
 		header_map map;
 		keys_order_list_t keys_order;
 
 		header() {}
+		explicit header(NRP<netp::arena> const& a) :
+			A(a),
+			map(0, std::hash<size_t>(), std::equal_to<size_t>(), header_map::allocator_type(a.get())),
+			keys_order(keys_order_list_t::allocator_type(a.get()))
+		{}
 		~header() {}
 
 		void reset() {
@@ -109,6 +123,27 @@ namespace netp { namespace http {
 			keys_order.clear();
 		}
 
+		//copy every field to netp::allocator and drop A, the arena could be reset after
+		void detach() {
+			if (A == nullptr) {
+				return;
+			}
+			const netp::arena_allocator<char> ca;
+			header_map _map(map.size(), std::hash<size_t>(), std::equal_to<size_t>(), header_map::allocator_type(ca));
+			for (header_map::const_iterator it = map.begin(); it != map.end(); ++it) {
+				mul_header_filed_with_same_name_pos_list_t hf_pos_list(it->second.mul_hf_pos_list.begin(), it->second.mul_hf_pos_list.end(), ca);
+				_map.insert({ it->first, { netp::arena_string_t(it->second.name.c_str(), it->second.name.length(), ca), netp::arena_string_t(it->second.value.c_str(), it->second.value.length(), ca), std::move(hf_pos_list) } });
+			}
+			keys_order_list_t _keys_order(ca);
+			for (netp::arena_string_t const& key : keys_order) {
+				_keys_order.push_back(netp::arena_string_t(key.c_str(), key.length(), ca));
+			}
+			//the old nodes go back to A before A is dropped
+			map = std::move(_map);
+			keys_order = std::move(_keys_order);
+			A = nullptr;
+		}
+
 		bool have(netp::string_t const& field) const {
 			header_map::const_iterator&& it = map.find(H_key(field));
 			return it != map.end();
@@ -118,7 +153,7 @@ namespace netp { namespace http {
 			size_t key = H_key(field);
 			header_map::iterator it = map.find(key);
 			if (it != map.end()) {
-				keys_order_list_t::iterator it_key = std::find_if(keys_order.begin(), keys_order.end(), [name = it->second.name](netp::string_t const& key) {
+				keys_order_list_t::iterator it_key = std::find_if(keys_order.begin(), keys_order.end(), [&name = it->second.name](netp::arena_string_t const& key) {
 					return key == name;
 				});
 				NETP_ASSERT(it_key != keys_order.end());
@@ -133,7 +168,7 @@ namespace netp { namespace http {
 		string_t get(string_t const& field) const {
 			header_map::const_iterator&& it = map.find(H_key(field));
 			if (it != map.end()) {
-				return it->second.value;
+				return string_t(it->second.value.c_str(), it->second.value.length());
 			}
 			return "";
 		}
@@ -143,11 +178,12 @@ namespace netp { namespace http {
 			header_map::iterator&& it = map.find(_key);
 			if (it != map.end()) {
 				mul_hfv_pos hf_pos = {value.length() + 2 /*netp::strlen(", ")*/, value.length()  };
-				it->second.value += ", " + value;
+				it->second.value.append(", ", 2);
+				it->second.value.append(value.c_str(), value.length());
 				it->second.mul_hf_pos_list.push_back(hf_pos);
 
 #ifdef _NETP_DEBUG
-				keys_order_list_t::iterator kit = std::find_if(keys_order.begin(), keys_order.end(), [name=it->second.name](netp::string_t const& key) {
+				keys_order_list_t::iterator kit = std::find_if(keys_order.begin(), keys_order.end(), [&name=it->second.name](netp::arena_string_t const& key) {
 					return key == name;
 				});
 				NETP_ASSERT( kit != keys_order.end() );
@@ -155,16 +191,17 @@ namespace netp { namespace http {
 				return;
 			}
 
-			mul_header_filed_with_same_name_pos_list_t hf_pos_list;
+			const netp::arena_allocator<char> ca(A.get());
+			mul_header_filed_with_same_name_pos_list_t hf_pos_list(ca);
 			hf_pos_list.push_back({ 0, value.length() });
-			map.insert({ _key, { field,value, hf_pos_list } });
-			keys_order.push_front(field);
+			map.insert({ _key, { netp::arena_string_t(field.c_str(), field.length(), ca), netp::arena_string_t(value.c_str(), value.length(), ca), std::move(hf_pos_list) } });
+			keys_order.push_front(netp::arena_string_t(field.c_str(), field.length(), ca));
 		}
 
 		void replace(string_t const& field, string_t const& value) {
 			header_map::iterator&& it = map.find(H_key(field));
 			if (it != map.end()) {
-				it->second.value = value;
+				it->second.value.assign(value.c_str(), value.length());
 				it->second.mul_hf_pos_list.clear();
 				it->second.mul_hf_pos_list.push_back({ 0, value.length() });
 			}
@@ -175,7 +212,7 @@ namespace netp { namespace http {
 				packet_o = netp::make_ref<packet>();
 			}
 
-			std::for_each(keys_order.rbegin(), keys_order.rend(), [&](string_t const& key) {
+			std::for_each(keys_order.rbegin(), keys_order.rend(), [&](netp::arena_string_t const& key) {
 				header_map::const_iterator&& it = map.find(H_key(key));
 				NETP_ASSERT(it != map.end());
 				const char* value_cstr = it->second.value.c_str();
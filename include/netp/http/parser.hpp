@@ -7,6 +7,7 @@
 #include "./../../../3rd/llhttp/llhttp.h"
 
 #include <netp/core.hpp>
+#include <netp/arena.hpp>
 #include <netp/http/chunk_encoder.hpp>
 #include <netp/http/message.hpp>
 
@@ -47,6 +48,8 @@ namespace netp { namespace http {
 		parser_cb on_chunk_complete;
 
 		NRP<netp::http::message> message_tmp;
+		//headers of a new message are allocated from it if set
+		NRP<netp::arena> arena;
 
 		last_header_element last_h;
 		string_t field_tmp;//for header field
@@ -13,6 +13,7 @@
 #include <netp/promise.hpp>
 #include <netp/packet.hpp>
 #include <netp/poller_abstract.hpp>
+#include <netp/compute_pool.hpp>
 
 #if defined(NETP_HAS_POLLER_EPOLL)
 #define NETP_DEFAULT_POLLER_TYPE netp::io_poller_type::T_EPOLL
@@ -27,6 +28,9 @@
 #error "unknown poller type"
 #endif
 
+//in milliseconds
+#define NETP_EVENT_LOOP_MEM_DECAY_INTERVAL (10*1000)
+
 namespace netp {
 
 	typedef std::function<void()> fn_task_t;
@@ -34,6 +38,9 @@ namespace netp {
 
 	struct event_loop_cfg {
 		u32_t ch_buf_size;
+		u32_t busy_poll_budget; //in microseconds, spin on a zero timeout poll before blocking, 0 means never spin
+		u32_t sock_busy_poll; //in microseconds, SO_BUSY_POLL for sockets of this loop (linux only), 0 means do not set
+		u32_t mem_decay_interval; //in milliseconds, release the pooled memory that is not used in the interval, 0 means never decay
 	};
 
 	class io_event_loop;
@@ -80,6 +87,10 @@ namespace netp {
 		std::atomic<long> m_internal_ref_count;
 		event_loop_cfg m_cfg;
 
+		bool m_busy_polling;
+		timer_timepoint_t m_busy_poll_deadline;
+		clock_snapshot m_clock;
+
 	protected:
 		inline long internal_ref_count() { return m_internal_ref_count.load(std::memory_order_relaxed); }
 		inline void store_internal_ref_count( long count ) { m_internal_ref_count.store( count, std::memory_order_relaxed); }
@@ -93,12 +104,25 @@ namespace netp {
 			NETP_ASSERT( m_waiting.load(std::memory_order_relaxed) == false, "_calc_wait_dur_in_nano waiting check failed" );
 			static_assert(TIMER_TIME_INFINITE == i64_t(-1), "timer infinite check");
 			netp::timer_duration_t ndelay;
-			m_tb->expire(ndelay);
+			m_tb->expire(ndelay, m_clock.steady);
 			i64_t ndelayns = i64_t(ndelay.count());
 			if (ndelayns == 0) {
 				return 0;
 			}
 
+			//@note: m_waiting is not set during spin, so schedule() would not write the interrupt fd
+			if (m_cfg.busy_poll_budget != 0) {
+				if (!m_busy_polling) {
+					m_busy_polling = true;
+					m_busy_poll_deadline = m_clock.steady + std::chrono::microseconds(m_cfg.busy_poll_budget);
+					return 0;
+				} else if (m_clock.steady < m_busy_poll_deadline) {
+					return 0;
+				}
+				//budget exhausted, block, we'll get a new budget for the next idle round
+				m_busy_polling = false;
+			}
+
 			{
 				lock_guard<spin_mutex> lg(m_tq_mutex);
 				if (m_tq_standby.size() != 0) {
@@ -113,8 +137,19 @@ namespace netp {
 			m_channel_rcv_buf = netp::make_ref<netp::packet>(m_cfg.ch_buf_size);
 			m_tid = std::this_thread::get_id();
 			m_tb = netp::make_ref<timer_broker>();
+			m_clock.update();
+			tls_set<clock_snapshot>(&m_clock);
+			tls_set<io_event_loop>(this);
 			
+			m_poller->bind_clock(&m_clock);
 			m_poller->init();
+
+#ifdef NETP_MEMORY_USE_TLS_POOL
+			//@note: no ref to this loop, io_event_loop_group detach the loop by its ref count
+			if (m_cfg.mem_decay_interval != 0) {
+				m_tb->launch(netp::make_ref<netp::timer>(std::chrono::milliseconds(m_cfg.mem_decay_interval), &io_event_loop::__tmcb_mem_decay, this, std::placeholders::_1), m_clock.steady);
+			}
+#endif
 		}
 
 		virtual void deinit() {
@@ -132,10 +167,13 @@ namespace netp {
 			m_tb = nullptr;
 
 			m_poller->deinit();
+			tls_set<clock_snapshot>(nullptr);
+			tls_set<io_event_loop>(nullptr);
 			NETP_VERBOSE("[io_event_loop]deinit done");
 		}
 
 		void __run();
+		void __tmcb_mem_decay(NRP<timer> const& t);
 		void __do_notify_terminating();
 		void __notify_terminating();		
 		void __do_enter_terminated();
@@ -152,7 +190,8 @@ namespace netp {
 			m_io_ctx_count_before_running(0),
 			m_poller(poller),
 			m_internal_ref_count(0),
-			m_cfg(cfg)
+			m_cfg(cfg),
+			m_busy_polling(false)
 		{}
 
 		~io_event_loop() {
@@ -212,6 +251,11 @@ namespace netp {
 			return std::this_thread::get_id() == m_tid;
 		}
 
+		//launch() without a promise throws once this is true
+		__NETP_FORCE_INLINE bool is_terminated() const {
+			return m_state.load(std::memory_order_acquire) >= u8_t(loop_state::S_TERMINATED);
+		}
+
 		void launch(NRP<netp::timer> const& t , NRP<netp::promise<int>> const& lf = nullptr ) {
 			if(!in_event_loop()) {
 				schedule([L = NRP<io_event_loop>(this), t, lf]() {
@@ -220,7 +264,7 @@ namespace netp {
 				return;
 			}
 			if (NETP_LIKELY(m_state.load(std::memory_order_acquire) < u8_t(loop_state::S_TERMINATED))) {
-				m_tb->launch(t);
+				m_tb->launch(t, m_clock.steady);
 				(lf != nullptr)? lf->set(netp::OK):(void)0;
 			} else {
 				(lf != nullptr) ? lf->set(netp::E_IO_EVENT_LOOP_TERMINATED):NETP_THROW("DO NOT LAUNCH AFTER TERMINATED, OR PASS A PROMISE TO OVERRIDE THIS ERRO");
@@ -235,7 +279,7 @@ namespace netp {
 				return;
 			}
 			if (NETP_LIKELY(m_state.load(std::memory_order_acquire) < u8_t(loop_state::S_TERMINATED))) {
-				m_tb->launch(std::move(t));
+				m_tb->launch(std::move(t), m_clock.steady);
 				(lf != nullptr) ? lf->set(netp::OK) : (void)0;
 			} else {
 				(lf != nullptr) ? lf->set(netp::E_IO_EVENT_LOOP_TERMINATED) : NETP_THROW("DO NOT LAUNCH AFTER TERMINATED, OR PASS A PROMISE TO OVERRIDE THIS ERRO");
@@ -243,11 +287,89 @@ namespace netp {
 		}
 
 		inline io_poller_type poller_type() const { return m_type; }
+		inline event_loop_cfg const& cfg() const { return m_cfg; }
+
+		//cached at the return of the last poll, do not call it out of the loop thread
+		__NETP_FORCE_INLINE timer_timepoint_t const& now() const {
+			NETP_ASSERT(in_event_loop());
+			return m_clock.steady;
+		}
+		__NETP_FORCE_INLINE wall_timepoint_t const& wall_now() const {
+			NETP_ASSERT(in_event_loop());
+			return m_clock.wall;
+		}
 
 		__NETP_FORCE_INLINE NRP<netp::packet> const& channel_rcv_buf() const {
 			return m_channel_rcv_buf;
 		}
 
+		//sets the promise of an offload job once, in the loop of the job
+		//a job dropped by compute_pool::stop() is destroyed without being run, its promise is set with E_INVALID_STATE by the last ref
+		template <class _Ret>
+		class offload_settler final :
+			public ref_base
+		{
+			typedef typename promise_value<_Ret>::type V;
+			NRP<io_event_loop> m_L;
+			NRP<promise<V>> m_p;
+			bool m_done;
+		public:
+			offload_settler(NRP<io_event_loop> const& L, NRP<promise<V>> const& p) :
+				m_L(L),
+				m_p(p),
+				m_done(false)
+			{}
+			~offload_settler() {
+				if (!m_done) {
+					settle(promise_value<_Ret>::error(netp::E_INVALID_STATE));
+				}
+			}
+			void settle(V const& v) {
+				if (m_done) {
+					return;
+				}
+				m_done = true;
+				m_L->execute([p = m_p, v]() {
+					p->set(v);
+				});
+			}
+		};
+
+		//run fn in compute_pool, the promise is set in this loop
+		//fn runs in this loop instead if the pool has been stopped, a job dropped by a stopping pool gets E_INVALID_STATE
+		//a void job is mapped to promise<int>, others to promise<std::tuple<int,R>>, the int is netp::OK or the code of what fn throws
+		template <class _callable, class _Ret = decltype(std::declval<typename std::decay<_callable>::type&>()())>
+		NRP<promise<typename promise_value<_Ret>::type>> offload(_callable&& fn) {
+			typedef typename promise_value<_Ret>::type V;
+			NRP<promise<V>> p = netp::make_ref<promise<V>>();
+			NRP<offload_settler<_Ret>> S = netp::make_ref<offload_settler<_Ret>>(NRP<io_event_loop>(this), p);
+			fn_task_t job = [S, fn = std::forward<_callable>(fn)]() mutable {
+				int ec = netp::OK;
+				try {
+					S->settle(promise_value<_Ret>::invoke(fn));
+				} catch (netp::exception& e) {
+					ec = (e.code() != netp::OK) ? e.code() : netp::E_UNKNOWN;
+					NETP_ERR("[io_event_loop]offload job exception: [%d]%s", e.code(), e.what());
+				} catch (std::exception& e) {
+					ec = netp::E_UNKNOWN;
+					NETP_ERR("[io_event_loop]offload job exception: %s", e.what());
+				} catch (...) {
+					ec = netp::E_UNKNOWN;
+					NETP_ERR("[io_event_loop]offload job unknown exception");
+				}
+				if (ec != netp::OK) {
+					S->settle(promise_value<_Ret>::error(ec));
+				}
+			};
+			S = nullptr;
+			int rt = compute_pool::instance()->execute(job);
+			if (NETP_UNLIKELY(rt != netp::OK)) {
+				NETP_WARN("[io_event_loop]offload failed: %d, run in loop", rt);
+				schedule(std::move(job));
+			}
+			return p;
+		}
+
 		inline int io_do(io_action act, io_ctx* ctx) {
 			NETP_ASSERT(in_event_loop());
 			if (((u8_t(act) & u8_t(io_action::READ_WRITE)) == 0) || m_state.load(std::memory_order_acquire) < u8_t(loop_state::S_TERMINATING)) {
@@ -277,6 +399,106 @@ namespace netp {
 		}
 	};
 
+	/*
+	 * @note
+	 * the loop a channel is bound to, shared by the channel, its pipeline, contexts and the handlers that take calls from other threads
+	 * ch_migrate_to rebinds it in the old loop once the channel has been detached from there, a task that lands on the old loop
+	 * right before that is forwarded by execute() again
+	 * in_event_loop() compares the raw pointer with the loop of the calling thread, no lock and no deref on the write path
+	 * a raw pointer loaded right before a rebind stays valid, the old loop is held by ch_migrate_to until the migration is done,
+	 * and by io_event_loop_group until every channel is gone
+	 */
+	class loop_binding final :
+		public ref_base
+	{
+		std::atomic<io_event_loop*> m_raw;
+		NRP<io_event_loop> m_L; //written by the bound loop only
+
+	public:
+		loop_binding(NRP<io_event_loop> const& L) :
+			m_raw(L.get()),
+			m_L(L)
+		{}
+
+		__NETP_FORCE_INLINE bool in_event_loop() const {
+			return tls_get<io_event_loop>() == m_raw.load(std::memory_order_acquire);
+		}
+
+		__NETP_FORCE_INLINE NRP<io_event_loop> get() const {
+			return NRP<io_event_loop>(m_raw.load(std::memory_order_acquire));
+		}
+
+		//the bound loop only
+		__NETP_FORCE_INLINE NRP<io_event_loop> const& L() const {
+			NETP_ASSERT(in_event_loop());
+			return m_L;
+		}
+
+		inline void rebind(NRP<io_event_loop> const& to) {
+			NETP_ASSERT(in_event_loop());
+			m_L = to;
+			m_raw.store(to.get(), std::memory_order_release);
+		}
+
+		inline void execute(fn_task_t const& fn) {
+			if (in_event_loop()) {
+				fn();
+				return;
+			}
+			get()->schedule([B = NRP<loop_binding>(this), fn]() {
+				B->execute(fn);
+			});
+		}
+	};
+
+	template <typename V>
+	struct __with_timeout_ctx :
+		public ref_base
+	{
+		std::atomic<bool> settled;
+		NRP<promise<std::tuple<int, V>>> rp;
+
+		__with_timeout_ctx() :
+			settled(false),
+			rp(netp::make_ref<promise<std::tuple<int, V>>>())
+		{}
+
+		inline void settle(int rt, V const& v) {
+			if (!settled.exchange(true, std::memory_order_acq_rel)) {
+				rp->set(std::make_tuple(rt, v));
+			}
+		}
+	};
+
+	//{netp::OK, v} if p is done in dur, {E_OP_TIMEOUT, V()} otherwise, the timer of L decides, {E_OP_ABORT, V()} if p is cancelled
+	//p is not cancelled on timeout, the timer is not cancelled on done (it fires as a no-op)
+	template <typename V, class dur>
+	NRP<promise<std::tuple<int, V>>> with_timeout(NRP<io_event_loop> const& L, NRP<promise<V>> const& p, dur const& d) {
+		NRP<__with_timeout_ctx<V>> wctx = netp::make_ref<__with_timeout_ctx<V>>();
+		NRP<promise<std::tuple<int, V>>> rp = wctx->rp;
+		//the callee is run by p itself, a raw pointer does
+		p->if_done([wctx, _p = p.get()](V const& v) {
+			wctx->settle(_p->is_cancelled() ? netp::E_OP_ABORT : netp::OK, v);
+		});
+		//a callee bound after the cancel is never run
+		if (p->is_cancelled()) {
+			wctx->settle(netp::E_OP_ABORT, V());
+		}
+		if (!rp->is_idle()) {
+			return rp;
+		}
+		NRP<promise<int>> lf = netp::make_ref<promise<int>>();
+		lf->if_done([wctx](int const& rt) {
+			if (rt != netp::OK) {
+				wctx->settle(rt, V());
+			}
+		});
+		L->launch(netp::make_ref<netp::timer>(std::chrono::duration_cast<timer_duration_t>(d), [wctx](NRP<netp::timer> const&) {
+			wctx->settle(netp::E_OP_TIMEOUT, V());
+		}), lf);
+		return rp;
+	}
+
 	class app;
 	typedef std::vector<NRP<io_event_loop>> io_event_loop_vector;
 	class io_event_loop_group:
@@ -3,6 +3,8 @@
 
 
 #include <vector>
+#include <string>
+#include <atomic>
 #include <cstring>
 #include <type_traits>
 
@@ -20,6 +22,13 @@
 //#define NETP_MEMORY_USE_ALIGN_MALLOC 1
 //#define NETP_MEMORY_USE_STD_MALLOC
 
+//per thread counters for every TABLE/slot, aggregated by allocator_stat_collect(), off by default
+//define NETP_MEMORY_ENABLE_STAT for the lib and its users alike (cmake -DNETP_MEMORY_ENABLE_STAT=ON), it changes the layout of the allocators
+//#define NETP_MEMORY_ENABLE_STAT 1
+
+//the global pool has a shard for each numa node, the nodes beyond are folded
+#define NETP_MEMORY_NUMA_NODE_MAX 8
+
 namespace netp {
 
 	enum TABLE {
@@ -45,54 +54,209 @@ namespace netp {
 	struct table_slot_t {
 		u32_t max;
 		u32_t count;
+		u32_t low; //low watermark of count since last decay, these items are not in use during the decay interval
+		u32_t warm; //items to preallocate on the next miss, grows with misses, shrinks with decay
 		//pointer to sizeof(u8_t*) * max;
 		u8_t** ptr; //
 
-		//if count == slot_max, we move half of count into global
-		//if count ==0, we borrow half of slot_max from global 
+		//if count == slot_max, we move a transfer batch into global
+		//if count ==0, we borrow a transfer batch from global
+	};
+
+	//owner thread writes with relaxed load+store (no lock prefix), any thread might read
+	struct table_slot_stat_t {
+		std::atomic<u64_t> alloc_hit;
+		std::atomic<u64_t> alloc_miss;
+		std::atomic<u64_t> free_cached;
+		std::atomic<u64_t> free_released;
+		std::atomic<u64_t> borrow;
+		std::atomic<u64_t> borrow_items;
+		std::atomic<u64_t> commit;
+		std::atomic<u64_t> commit_items;
+		std::atomic<u64_t> trimmed; //items released by decay/trim
+		std::atomic<u64_t> warmed; //items preallocated on miss
+		std::atomic<u64_t> remote; //items of other nodes sent home
+		std::atomic<u32_t> cached;
+	};
+
+#define NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT 16
+
+	struct allocator_slot_stat {
+		u32_t size;
+		u64_t alloc_hit;
+		u64_t alloc_miss;
+		u64_t free_cached;
+		u64_t free_released;
+		u64_t borrow;
+		u64_t borrow_items;
+		u64_t commit;
+		u64_t commit_items;
+		u64_t trimmed;
+		u64_t warmed;
+		u64_t remote;
+		u64_t tls_cached; //items parked in tls slots
+		u64_t global_cached; //items parked in global slots
+	};
+
+	struct allocator_stat {
+		u32_t thread_count;
+		u32_t numa_nodes;
+		u64_t large_alloc; //size beyond the last table
+		u64_t large_free;
+		u32_t slab_chunks; //NETP_MEMORY_USE_SLAB only
+		u32_t slab_huge_chunks;
+		allocator_slot_stat slots[TABLE::T_COUNT][NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT];
 	};
 
 #define TABLE_SLOT_COUNT(tst) (tst->count)
 #define TABLE_SLOT_POP(tst) ( tst->ptr + sizeof(u8_t*) * (--tst->count)))
 #define TABLE_SLOT_PUSH(tst,ptr) (tst->ptr + sizeof(u8_t*) * (tst->count++)))
 
+	//false by default, a thread warms the classes it uses on demand
+	extern bool allocator_preallocate_eager();
+
+	//1 if the topology is unknown
+	extern u32_t allocator_numa_node_count();
+
 	//NOTE: if want to share address with different alignment in the same pool, we need to check alignment and do a re-align if necessary
+	class global_pool_aligned_allocator;
+	struct remote_slot_t;
 	class pool_aligned_allocator {
-
+		friend class global_pool_aligned_allocator;
 	protected:
 		//pointer to the first table slot
 		//not all the table has seem size
 		table_slot_t** m_tables[TABLE::T_COUNT];
+		size_t m_cached_bytes;
+		//@note: the node this thread runs on when the pool is created, every item is tagged with the node that malloc it
+		//an item of another node is parked in m_remote[t][s*node_count+node], and sent home as a whole batch
+		u8_t m_node;
+		remote_slot_t** m_remote[TABLE::T_COUNT]; //nullptr on a single node
+		void __free_remote(u8_t* item, u8_t t, u8_t s, u8_t node);
+		void __flush_remote();
+#ifdef NETP_MEMORY_ENABLE_STAT
+		table_slot_stat_t* m_stats[TABLE::T_COUNT];
+		std::atomic<u64_t> m_large_alloc;
+		std::atomic<u64_t> m_large_free;
+		//set by stat_attach, deinit() folds into the global after its own flush
+		bool m_stat_attached;
+
+		void stat_load(allocator_stat& st) const;
+		void stat_fold(pool_aligned_allocator const& other);
+#endif
 
 		void preallocate_table_slot_item(table_slot_t* tst, u8_t t, u8_t slot, size_t item_count);
 		void deallocate_table_slot_item(table_slot_t* tst);
+		void __table_slot_warm(table_slot_t* tst, u8_t t, u8_t s, size_t slot_size);
 		
 		void init(bool preallocate);
 		void deinit();
 
 		public:
-			pool_aligned_allocator( bool preallocate = true );
+			pool_aligned_allocator( bool preallocate = allocator_preallocate_eager() );
 			virtual ~pool_aligned_allocator();
 
+			//fill the classes below 1K to half of the slot at once
+			void preallocate();
+			inline u8_t node() const { return m_node; }
+
 			void* malloc(size_t size, size_t alignment );
 			void free(void* ptr);
 			void* realloc(void* ptr, size_t size, size_t alignment);
+
+			//release half of the low watermark of each slot, return bytes released
+			size_t decay();
+			//release all the cached items, return bytes released
+			size_t trim();
+			inline size_t cached_bytes() const { return m_cached_bytes; }
+	};
+
+	//fixed size array of free items of one TABLE/slot, handed over between tls slots and the global pool as a whole
+	#define NETP_TRANSFER_BATCH_MAX 64
+	#define NETP_TRANSFER_SEGMENT_BATCHES 1024
+	#define NETP_TRANSFER_SEGMENT_MAX 1024
+
+	struct transfer_batch {
+		std::atomic<u32_t> next; //id of the next batch in the stack
+		u32_t count;
+		u8_t* items[NETP_TRANSFER_BATCH_MAX];
+	};
+
+	//@note: lock free stack of batch id (1 based, 0 means empty), the upper 32 bits of head is a tag bumped by every push/pop against ABA
+	//batches live in segments that are never freed before the global pool goes, so the next of a stale head is always readable
+	struct transfer_class {
+		std::atomic<u64_t> head;
+		std::atomic<u32_t> count; //batches in the stack
+		std::atomic<u32_t> low; //low watermark of count since last decay
+		std::atomic<u32_t> limit; //grow with thread count
 	};
 
 	class global_pool_aligned_allocator final :
 		public pool_aligned_allocator,
 		public singleton<global_pool_aligned_allocator>
 	{
-		spin_mutex* m_table_slots_mtx[TABLE::T_COUNT];
+		u32_t m_node_count;
+		transfer_class* m_transfer[NETP_MEMORY_NUMA_NODE_MAX][TABLE::T_COUNT];
+		std::atomic<u64_t> m_free_batches;
+		std::atomic<transfer_batch*> m_batch_segments[NETP_TRANSFER_SEGMENT_MAX];
+		std::atomic<u32_t> m_batch_segment_count;
+		spin_mutex m_batch_segment_mtx;
+
+		std::atomic<size_t> m_global_cached_bytes;
+		std::atomic<i64_t> m_last_decay;
+#ifdef NETP_MEMORY_ENABLE_STAT
+		//the stat of exited threads is folded into the global's own counters
+		spin_mutex m_stat_mtx;
+		std::vector<pool_aligned_allocator*> m_stat_allocators;
+#endif
+
+		inline transfer_batch* __batch_at(u32_t id) const {
+			--id;
+			return m_batch_segments[id / NETP_TRANSFER_SEGMENT_BATCHES].load(std::memory_order_acquire) + (id % NETP_TRANSFER_SEGMENT_BATCHES);
+		}
+		u32_t __stack_pop(std::atomic<u64_t>& head);
+		void __stack_push(std::atomic<u64_t>& head, u32_t id);
+		u32_t __batch_alloc();
+		//pop at most n batches of the class and free their items, return bytes released
+		size_t __release_batches(u8_t node, u8_t t, u8_t s, u32_t n);
+		//push n items to the shard of node as a batch, return false if the shard is full
+		bool __push_batch(u8_t node, u8_t t, u8_t s, u8_t** items, u32_t n);
+
 	public:
 		global_pool_aligned_allocator();
 		virtual ~global_pool_aligned_allocator();
-		void incre_thread_count();
-		void decre_thread_count();
-		u32_t commit(u8_t t, u8_t slot, table_slot_t* tst);
-		u32_t borrow(u8_t t, u8_t slot, table_slot_t* tst);
+		//the shard of node grows with its threads
+		void incre_thread_count(u8_t node);
+		void decre_thread_count(u8_t node);
+		u32_t commit(u8_t node, u8_t t, u8_t slot, table_slot_t* tst);
+		u32_t borrow(u8_t node, u8_t t, u8_t slot, table_slot_t* tst);
+		//items freed on another node, the items are released to the system if the home shard is full
+		void commit_remote(u8_t node, u8_t t, u8_t slot, u8_t** items, u32_t n);
+
+		//at most once per min_interval_ms whoever calls it
+		size_t decay(u32_t min_interval_ms);
+		size_t trim();
+		inline size_t cached_bytes() const { return m_global_cached_bytes.load(std::memory_order_relaxed); }
+
+		void stat_attach(pool_aligned_allocator* allocator);
+		//called by the deinit() of an attached allocator
+		void stat_detach(pool_aligned_allocator* allocator);
+		void stat_collect(allocator_stat& st);
 	};
 
+	//0 means no limit, a free beyond the cap goes to the system directly
+	extern void allocator_cfg_cached_bytes_max(size_t tls_max, size_t global_max);
+	//eager: every new thread preallocates the classes below 1K on start, so does the calling thread right now
+	extern void allocator_cfg_preallocate(bool eager);
+	//decay the pool of the calling thread and the global pool, called by the decay timer of io_event_loop
+	extern size_t allocator_decay(u32_t global_min_interval_ms);
+	//trim the pool of the calling thread and the global pool, and return the free heap to the system if we can
+	extern size_t allocator_trim();
+
+	//snapshot of all the live threads + exited threads + global pool, safe to call from any thread
+	extern void allocator_stat_collect(allocator_stat& st);
+	extern std::string allocator_stat_dump(allocator_stat const& st);
+
 	using pool_aligned_allocator_t = pool_aligned_allocator;
 
 	struct tag_allocator_std_malloc {};
@@ -0,0 +1,130 @@
+#ifndef _NETP_MIRROR_RINGBUFFER_HPP_
+#define _NETP_MIRROR_RINGBUFFER_HPP_
+
+#include <netp/core.hpp>
+#include <netp/smart_ptr.hpp>
+#include <netp/bytes_helper.hpp>
+
+namespace netp {
+
+	/*
+	 * @note
+	 * ring buffer with the same physical pages mapped twice back to back in virtual memory
+	 * [0, capacity) and [capacity, capacity*2) alias each other, so both the readable and the writable region are always contiguous
+	 * 1, no split at the wrap point, a parser reads a frame from head() directly, recv() writes into tail() directly
+	 * 2, capacity is rounded up to the page size (allocation granularity on windows)
+	 * 3, not thread safe, the owner loop only
+	 */
+	class mirror_ringbuffer final :
+		public netp::ref_base
+	{
+		NETP_DECLARE_NONCOPYABLE(mirror_ringbuffer)
+
+		enum size_range {
+			MAX_MIRROR_RINGBUFFER_SIZE = 1024*1024*256
+		};
+
+		byte_t* m_buffer; //capacity*2 bytes of address space
+		u32_t m_capacity;
+		u32_t m_begin; //read, always less than m_capacity
+		u32_t m_end; //write, m_begin <= m_end <= m_begin + m_capacity
+
+		void __unmap();
+
+	public:
+		mirror_ringbuffer();
+		~mirror_ringbuffer();
+
+		//return netp::OK or the errno of the failed mapping step
+		int init(u32_t capacity);
+
+		__NETP_FORCE_INLINE void reset() {
+			m_begin = m_end = 0;
+		}
+		__NETP_FORCE_INLINE bool is_empty() const {
+			return m_begin == m_end;
+		}
+		__NETP_FORCE_INLINE bool is_full() const {
+			return (m_end - m_begin) == m_capacity;
+		}
+		__NETP_FORCE_INLINE u32_t capacity() const {
+			return m_capacity;
+		}
+		__NETP_FORCE_INLINE u32_t count() const {
+			return m_end - m_begin;
+		}
+		__NETP_FORCE_INLINE u32_t left_capacity() const {
+			return m_capacity - (m_end - m_begin);
+		}
+
+		//count() bytes readable from here
+		__NETP_FORCE_INLINE byte_t* head() const {
+			NETP_ASSERT(m_buffer != nullptr);
+			return m_buffer + m_begin;
+		}
+		//left_capacity() bytes writable from here
+		__NETP_FORCE_INLINE byte_t* tail() const {
+			NETP_ASSERT(m_buffer != nullptr);
+			return m_buffer + m_end;
+		}
+
+		//commit the bytes written to tail() by the caller
+		__NETP_FORCE_INLINE void incre_write_idx(u32_t s) {
+			NETP_ASSERT(s <= left_capacity());
+			m_end += s;
+		}
+
+		__NETP_FORCE_INLINE void skip(u32_t s) {
+			NETP_ASSERT(s <= count());
+			m_begin += s;
+			if (m_begin == m_end) {
+				m_begin = m_end = 0;
+			} else if (m_begin >= m_capacity) {
+				m_begin -= m_capacity;
+				m_end -= m_capacity;
+			}
+		}
+
+		//return the bytes written, as much as possible
+		inline u32_t write(const byte_t* const bytes, u32_t s) {
+			const u32_t c = NETP_MIN(s, left_capacity());
+			std::memcpy(tail(), bytes, c);
+			m_end += c;
+			return c;
+		}
+
+		//return the bytes read, as much as possible
+		inline u32_t read(byte_t* const target, u32_t s, bool move_forward_r_idx = true) {
+			const u32_t c = NETP_MIN(s, count());
+			std::memcpy(target, head(), c);
+			if (NETP_LIKELY(move_forward_r_idx)) {
+				skip(c);
+			}
+			return c;
+		}
+
+		inline u32_t peek(byte_t* const target, u32_t s) {
+			return read(target, s, false);
+		}
+
+		template <class T, class endian = netp::bytes_helper::big_endian>
+		inline T peek() const {
+			NETP_ASSERT(count() >= sizeof(T));
+			return endian::read_impl(head(), netp::bytes_helper::type<T>());
+		}
+
+		template <class T, class endian = netp::bytes_helper::big_endian>
+		inline T read() {
+			const T t = peek<T, endian>();
+			skip(sizeof(T));
+			return t;
+		}
+
+		//recv into tail() once, return the bytes received, ec is netp::E_EWOULDBLOCK if the ring is full
+		u32_t recv(SOCKET fd, int& ec);
+
+		//send from head() once, return the bytes sent
+		u32_t send(SOCKET fd, int& ec);
+	};
+}
+#endif
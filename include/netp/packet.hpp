@@ -6,6 +6,10 @@
 #include <netp/smart_ptr.hpp>
 #include <netp/bytes_helper.hpp>
 
+#ifndef _NETP_WIN
+	#include <sys/uio.h>
+#endif
+
 #define PACK_MIN_LEFT_CAPACITY (64)
 #define PACK_MIN_RIGHT_CAPACITY (128-(PACK_MIN_LEFT_CAPACITY))
 #define PACK_MIN_CAPACITY ((PACK_MIN_LEFT_CAPACITY)+(PACK_MIN_RIGHT_CAPACITY))
@@ -16,6 +20,15 @@
 
 namespace netp {
 
+	//scatter/gather unit for sendv
+#ifdef _NETP_WIN
+	typedef WSABUF iov_t;
+	__NETP_FORCE_INLINE void iov_set(iov_t& iov, byte_t const* base, u32_t len) { iov.buf = (char*)base; iov.len = ULONG(len); }
+#else
+	typedef struct iovec iov_t;
+	__NETP_FORCE_INLINE void iov_set(iov_t& iov, byte_t const* base, u32_t len) { iov.iov_base = (void*)base; iov.iov_len = len; }
+#endif
+
 	//[ head,tail )
 	// memory bytes layout
 	// [--writeable----bytes---bytes-----begin ------bytes--------bytes----bytes--end---writeable--]
@@ -25,8 +38,19 @@ namespace netp {
 	 * 2, read forward only
 	 * 3, write_left from head, write from tail, 
 	 * 4, always read from head, 
+	 * 5, retained_slice shares the buffer, a shared buffer is never written left of tail or reallocated, the writer copies to a buffer of its own instead
 	 */
 
+	//owns a buffer once it is shared by retained slices, same ref count flavor as the packet
+	template<class _ref_base>
+	struct packet_buffer_holder final :
+		public _ref_base
+	{
+		byte_t* buf;
+		explicit packet_buffer_holder(byte_t* buf_) : buf(buf_) {}
+		~packet_buffer_holder() { netp::allocator<byte_t>::free(buf); }
+	};
+
 	template<class _ref_base, u32_t LEFT_RESERVE, u32_t DEFAULT_CAPACITY, u32_t AGN>
 	class cap_fix_packet:
 		public _ref_base
@@ -34,10 +58,37 @@ namespace netp {
 		typedef cap_fix_packet<_ref_base, LEFT_RESERVE, DEFAULT_CAPACITY,AGN> fix_packet_t;
 
 	protected:
+		typedef packet_buffer_holder<_ref_base> buffer_holder_t;
+
 		byte_t* m_buffer;
 		u32_t	m_read_idx; //read index
 		u32_t	m_write_idx; //write index
 		u32_t	m_capacity; //the total buffer size
+		NRP<buffer_holder_t> m_shared; //not null if m_buffer is shared with slices
+
+		__NETP_FORCE_INLINE NRP<buffer_holder_t> const& _share() {
+			if (m_shared == nullptr) {
+				m_shared = netp::make_ref<buffer_holder_t>(m_buffer);
+			}
+			return m_shared;
+		}
+
+		//copy the bytes to a buffer of our own before writing left of head, the bytes there might belong to a slice
+		void _unshare_left(netp::u32_t left) {
+			NETP_ASSERT(m_shared != nullptr);
+			const netp::u32_t _len = len();
+			const netp::u32_t new_left = (m_read_idx > left) ? m_read_idx : left;
+			m_capacity = new_left + _len + (m_capacity - m_write_idx);
+			byte_t* _newbuffer = netp::allocator<byte_t>::malloc(sizeof(byte_t) * m_capacity, AGN);
+			NETP_ALLOC_CHECK(_newbuffer, sizeof(byte_t) * m_capacity);
+			if (_len > 0) {
+				std::memcpy(_newbuffer + new_left, m_buffer + m_read_idx, _len);
+			}
+			m_buffer = _newbuffer;
+			m_read_idx = new_left;
+			m_write_idx = new_left + _len;
+			m_shared = nullptr;
+		}
 
 		void _init_buffer(netp::u32_t left, netp::u32_t right) {
 			if (right == 0) {
@@ -68,17 +119,45 @@ namespace netp {
 			write(buf, len);
 		}
 
+		//a view of [buf, buf+len) in the buffer of shared, no left/right capacity
+		explicit cap_fix_packet(NRP<buffer_holder_t> const& shared, byte_t* buf, netp::u32_t len) :
+			m_buffer(buf),
+			m_read_idx(0),
+			m_write_idx(len),
+			m_capacity(len),
+			m_shared(shared)
+		{}
+
 		~cap_fix_packet() {
-			netp::allocator<byte_t>::free(m_buffer);
+			if (m_shared == nullptr) {
+				netp::allocator<byte_t>::free(m_buffer);
+			}
 		}
 
 		__NETP_FORCE_INLINE void reset(netp::u32_t left_capacity = LEFT_RESERVE) {
 #ifdef _NETP_DEBUG
 			NETP_ASSERT(left_capacity < m_capacity);
 #endif
+			if (NETP_UNLIKELY(m_shared != nullptr)) {
+				//the slices keep the bytes, start over with a buffer of our own, a slice has no spare capacity
+				if (m_capacity <= left_capacity) {
+					m_capacity = (DEFAULT_CAPACITY > left_capacity) ? DEFAULT_CAPACITY : (left_capacity + PACK_MIN_RIGHT_CAPACITY);
+				}
+				m_buffer = netp::allocator<byte_t>::malloc(sizeof(byte_t) * m_capacity, AGN);
+				NETP_ALLOC_CHECK(m_buffer, sizeof(byte_t) * m_capacity);
+				m_shared = nullptr;
+			}
 			m_read_idx = m_write_idx = left_capacity;
 		}
 
+		__NETP_FORCE_INLINE bool is_shared() const { return m_shared != nullptr; }
+
+		//[head()+offset, head()+offset+len_), zero copy, the buffer is released once the packet and all its slices are gone
+		inline NRP<fix_packet_t> retained_slice(netp::u32_t offset, netp::u32_t len_) {
+			NETP_ASSERT((u64_t(offset) + len_) <= len());
+			return netp::make_ref<fix_packet_t>(_share(), head() + offset, len_);
+		}
+
 		__NETP_FORCE_INLINE byte_t* head() const {
 			return m_buffer + m_read_idx;
 		}
@@ -119,6 +198,9 @@ namespace netp {
 		const inline netp::u32_t left_right_capacity() const { return (NETP_UNLIKELY(m_buffer == nullptr)) ? 0 : m_capacity - m_write_idx; }
 
 		inline void write_left(byte_t const* buf, netp::u32_t len) {
+			if (NETP_UNLIKELY(m_shared != nullptr)) {
+				_unshare_left(len);
+			}
 			NETP_ASSERT(m_read_idx >= len);
 			m_read_idx -= len;
 			std::memcpy(m_buffer + m_read_idx, buf, len);
@@ -127,6 +209,9 @@ namespace netp {
 		//would result in memmove if left space is not enough
 		template <class T, class endian = netp::bytes_helper::big_endian>
 		inline void write_left(T t) {
+			if (NETP_UNLIKELY(m_shared != nullptr)) {
+				_unshare_left(sizeof(T));
+			}
 			NETP_ASSERT( m_read_idx >= sizeof(T) );
 			m_read_idx -= sizeof(T);
 			netp::u32_t wnbytes = endian::write_impl(t, (m_buffer + m_read_idx));
@@ -232,8 +317,12 @@ namespace netp {
 			}
 			cap_fix_packet_t::m_read_idx = new_left;
 			cap_fix_packet_t::m_write_idx = cap_fix_packet_t::m_read_idx+_len;
-			
-			netp::allocator<byte_t>::free(cap_fix_packet_t::m_buffer);
+
+			if (cap_fix_packet_t::m_shared != nullptr) {
+				cap_fix_packet_t::m_shared = nullptr;
+			} else {
+				netp::allocator<byte_t>::free(cap_fix_packet_t::m_buffer);
+			}
 			cap_fix_packet_t::m_buffer = _newbuffer;
 		}
 
@@ -242,6 +331,15 @@ namespace netp {
 			NETP_ASSERT(cap_fix_packet_t::m_buffer != nullptr);
 			NETP_ASSERT((cap_fix_packet_t::m_capacity + increment) <= PACK_MAX_CAPACITY);
 			cap_fix_packet_t::m_capacity += increment;
+			if (cap_fix_packet_t::m_shared != nullptr) {
+				//never realloc a shared buffer, the slices are still on it
+				byte_t* _newbuffer = netp::allocator<byte_t>::malloc(cap_fix_packet_t::m_capacity, AGN);
+				NETP_ALLOC_CHECK(_newbuffer, cap_fix_packet_t::m_capacity);
+				std::memcpy(_newbuffer + cap_fix_packet_t::m_read_idx, cap_fix_packet_t::m_buffer + cap_fix_packet_t::m_read_idx, cap_fix_packet_t::len());
+				cap_fix_packet_t::m_buffer = _newbuffer;
+				cap_fix_packet_t::m_shared = nullptr;
+				return;
+			}
 			byte_t* _newbuffer = netp::allocator<byte_t>::realloc(cap_fix_packet_t::m_buffer, cap_fix_packet_t::m_capacity, AGN);
 			NETP_ALLOC_CHECK(_newbuffer, cap_fix_packet_t::m_capacity);
 			cap_fix_packet_t::m_buffer = _newbuffer;
@@ -258,7 +356,21 @@ namespace netp {
 		{
 		}
 
+		explicit cap_expandable_packet(NRP<typename cap_fix_packet_t::buffer_holder_t> const& shared, byte_t* buf, netp::u32_t len) :
+			cap_fix_packet_t(shared, buf, len)
+		{
+		}
+
+		inline NRP<expandable_packet_t> retained_slice(netp::u32_t offset, netp::u32_t len_) {
+			NETP_ASSERT((u64_t(offset) + len_) <= cap_fix_packet_t::len());
+			return netp::make_ref<expandable_packet_t>(cap_fix_packet_t::_share(), cap_fix_packet_t::head() + offset, len_);
+		}
+
 		void write_left( byte_t const* buf, netp::u32_t len ) {
+			if (NETP_UNLIKELY(cap_fix_packet_t::m_shared != nullptr)) {
+				//the bytes on the left might belong to a slice
+				_extend_leftbuffer_capacity__(len);
+			}
 			while ( NETP_UNLIKELY(len > (cap_fix_packet_t::left_left_capacity())) ) {
 				_extend_leftbuffer_capacity__( ((len - (cap_fix_packet_t::left_left_capacity() ))<<1));
 			}
@@ -273,6 +385,9 @@ namespace netp {
 		//would result in memmove if left space is not enough
 		template <class T, class endian=netp::bytes_helper::big_endian>
 		inline void write_left(T t) {
+			if (NETP_UNLIKELY(cap_fix_packet_t::m_shared != nullptr)) {
+				_extend_leftbuffer_capacity__(PACK_INCREMENT_SIZE_LEFT);
+			}
 			while ( NETP_UNLIKELY(sizeof(T) > (cap_fix_packet_t::left_left_capacity())) ) {
 				_extend_leftbuffer_capacity__(PACK_INCREMENT_SIZE_LEFT);
 			}
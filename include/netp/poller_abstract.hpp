@@ -3,9 +3,13 @@
 
 #include <netp/core.hpp>
 #include <netp/io_monitor.hpp>
+#include <netp/timer.hpp>
 
 #define NETP_DEBUG_IO_CTX_
 
+//io_ctx kept by a poller for reuse, a short connection costs no allocation for its ctx once the loop is warmed up
+#define NETP_IO_CTX_RECYCLE_MAX (1024)
+
 //in nano
 #define NETP_POLLER_WAIT_IGNORE_DUR (u64_t(27))
 //ENTER HAS A lock_gurard to sure the compiler would not reorder it
@@ -64,16 +68,34 @@ namespace netp {
 		netp::allocator<io_ctx>::trash(ctx);
 	}
 
+	//drop the monitor at once, a recycled ctx must not keep its channel alive
+	inline static void io_ctx_reset(io_ctx* ctx) {
+		NETP_ASSERT(ctx->iom != nullptr);
+		ctx->prev = nullptr;
+		ctx->next = nullptr;
+		ctx->fd = (SOCKET)NETP_INVALID_SOCKET;
+		ctx->flag = 0;
+		ctx->iom = nullptr;
+	}
+
 
 	class poller_abstract:
 		public netp::ref_base
 	{
 	protected:
+		clock_snapshot* m_clock;
 
+		//@note: called right after the wait returns, the handlers dispatched by this poll see the time of the wakeup
+		__NETP_FORCE_INLINE void _clock_update() {
+			m_clock->update();
+		}
 	public:
-		poller_abstract() {}
+		poller_abstract():m_clock(nullptr) {}
 		~poller_abstract() {}
 
+		//the snapshot of the owner loop, bound before init
+		void bind_clock(clock_snapshot* clock) { m_clock = clock; }
+
 		virtual void init() = 0;
 		virtual void deinit() = 0;
 
@@ -110,6 +110,7 @@ namespace netp {
 			const int wait_in_mill = wait_in_nano != ~0 ? (wait_in_nano / i64_t(1000000)): ~0;
 			int nEvents = epoll_wait(m_epfd, epEvents,NETP_EPOLL_PER_HANDLE_SIZE, wait_in_mill);
 			NETP_POLLER_WAIT_EXIT(wait_in_nano, W);
+			_clock_update();
 			if ( -1 == nEvents ) {
 				NETP_ERR("[EPOLL][##%u]epoll wait event failed!, errno: %d", m_epfd, netp_socket_get_last_errno() );
 				return ;
@@ -44,6 +44,8 @@ namespace netp {
 	{
 	public:
 		io_ctx m_io_ctx_list;
+		io_ctx* m_io_ctx_free; //singly linked by next, in loop only
+		u32_t m_io_ctx_free_count;
 		NRP<interrupt_fd_monitor> m_fd_monitor_r;
 		SOCKET m_fd_w;
 
@@ -54,6 +56,8 @@ namespace netp {
 
 		poller_interruptable_by_fd() :
 			poller_abstract(),
+			m_io_ctx_free(nullptr),
+			m_io_ctx_free_count(0),
 			m_fd_monitor_r(nullptr),
 			m_fd_w(NETP_INVALID_SOCKET)
 #ifdef NETP_DEBUG_IO_CTX_
@@ -113,6 +117,12 @@ namespace netp {
 
 		void deinit() {
 			__deinit_interrupt_fd();
+			while (m_io_ctx_free != nullptr) {
+				io_ctx* ctx = m_io_ctx_free;
+				m_io_ctx_free = ctx->next;
+				netp::allocator<io_ctx>::trash(ctx);
+			}
+			m_io_ctx_free_count = 0;
 #ifdef NETP_DEBUG_IO_CTX_
 			NETP_ASSERT(m_io_ctx_count_alloc == m_io_ctx_count_free);
 #endif
@@ -130,7 +140,15 @@ namespace netp {
 		}
 
 		virtual io_ctx* io_begin(SOCKET fd, NRP<io_monitor> const& iom) override {
-			io_ctx* ctx = netp::io_ctx_allocate(fd,iom);
+			io_ctx* ctx = m_io_ctx_free;
+			if (ctx != nullptr) {
+				m_io_ctx_free = ctx->next;
+				--m_io_ctx_free_count;
+				ctx->fd = fd;
+				ctx->iom = iom;
+			} else {
+				ctx = netp::io_ctx_allocate(fd,iom);
+			}
 			netp::list_append(&m_io_ctx_list, ctx);
 
 #ifdef NETP_DEBUG_IO_CTX_
@@ -142,7 +160,15 @@ namespace netp {
 		//
 		virtual void io_end(io_ctx* ctx) override {
 			netp::list_delete(ctx);
-			netp::io_ctx_deallocate(ctx);
+			//same rule as a free, no pending event may refer to the ctx after io_end
+			if (m_io_ctx_free_count < NETP_IO_CTX_RECYCLE_MAX) {
+				netp::io_ctx_reset(ctx);
+				ctx->next = m_io_ctx_free;
+				m_io_ctx_free = ctx;
+				++m_io_ctx_free_count;
+			} else {
+				netp::io_ctx_deallocate(ctx);
+			}
 
 #ifdef NETP_DEBUG_IO_CTX_
 			++m_io_ctx_count_free;
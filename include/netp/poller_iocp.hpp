@@ -237,6 +237,7 @@ namespace netp {
 			int ec = netp::OK;
 			BOOL getOk = ::GetQueuedCompletionStatusEx(m_handle, &entrys[0], n, &n, (DWORD)(wait_in_milli), FALSE);
 			NETP_POLLER_WAIT_EXIT(wait_in_nano, W);
+			_clock_update();
 			if (NETP_UNLIKELY(getOk) == FALSE) {
 				ec = netp_socket_get_last_errno();
 				if (ec == netp::E_WAIT_TIMEOUT) {
@@ -278,6 +279,7 @@ namespace netp {
 			LPOVERLAPPED ol;
 			BOOL getOk = ::GetQueuedCompletionStatus(m_handle, &dwTrans_, &ckey, &ol, (DWORD)wait_in_milli);
 			NETP_POLLER_WAIT_EXIT(wait_in_nano, W);
+			_clock_update();
 
 			if (NETP_UNLIKELY(getOk == FALSE)) {
 				ec = netp_socket_get_last_errno();
@@ -54,6 +54,7 @@ namespace netp {
 			int ec=netp::OK;
 			int rt = kevent(m_kq, NULL, 0, m_kevts, NETP_KEVT_COUNT, tspp);
 			NETP_POLLER_WAIT_EXIT(wait_in_nano, W);
+			_clock_update();
 
 			if (NETP_LIKELY(rt > 0)) {
 				for (int j = 0; j < rt; ++j) {
@@ -75,6 +75,7 @@ namespace netp {
 
 			int nready = ::select((int)(max_fd_v + 1), &m_fds[fds_r], &m_fds[fds_w], &m_fds[fds_e], tv); //only read now
 			NETP_POLLER_WAIT_EXIT(wait_in_nano,W);
+			_clock_update();
 
 			if (nready == 0) {
 				return;
@@ -2,6 +2,8 @@
 #define _NETP_PROMISE_HPP
 
 #include <functional>
+#include <vector>
+#include <tuple>
 
 #include <netp/core.hpp>
 #include <netp/smart_ptr.hpp>
@@ -95,7 +97,26 @@ namespace netp {
 		S_IDLE, //wait to operation
 		S_UPDATING,
 		S_CANCELLED, //operation cancelled
-		S_DONE //operation done
+		S_DONE, //operation done
+		S_VOID //nobody waits for it, set() does nothing, refer to void_promise()
+	};
+	struct promise_void_t {};
+
+	//the value type of a promise that carries the result of a callable (then, io_event_loop::offload)
+	//{netp::OK or the code of what the callable throws, result}, void is mapped to int with the code only
+	template <class _Ret>
+	struct promise_value {
+		typedef std::tuple<int, _Ret> type;
+		template <class _callable, class... _Args>
+		inline static type invoke(_callable& fn, _Args&&... args) { return std::make_tuple(netp::OK, fn(std::forward<_Args>(args)...)); }
+		inline static type error(int code) { return std::make_tuple(code, _Ret()); }
+	};
+	template <>
+	struct promise_value<void> {
+		typedef int type;
+		template <class _callable, class... _Args>
+		inline static type invoke(_callable& fn, _Args&&... args) { fn(std::forward<_Args>(args)...); return netp::OK; }
+		inline static type error(int code) { return code; }
 	};
 
 	#define __NETP_PROMISE_EBP_INTERNAL_SLOTS (2)
@@ -135,6 +156,13 @@ namespace netp {
 			m_waiter(0)
 		{}
 
+		explicit promise(promise_void_t) :
+			m_state(u8_t(promise_state::S_VOID)),
+			m_v(V()),
+			m_cond(0),
+			m_waiter(0)
+		{}
+
 		~promise() {
 			__cond_deallocate_check();
 		}
@@ -188,6 +216,9 @@ namespace netp {
 		const inline bool is_cancelled() const {
 			return m_state.load(std::memory_order_relaxed) == u8_t(promise_state::S_CANCELLED);
 		}
+		const inline bool is_void() const {
+			return m_state.load(std::memory_order_relaxed) == u8_t(promise_state::S_VOID);
+		}
 
 		bool cancel() {
 			lock_guard<spin_mutex> lg(m_mutex);
@@ -215,7 +246,7 @@ namespace netp {
 				//slow path: double check
 				if (is_done()) {
 					callee(promise_t::m_v);
-				} else {
+				} else if (!is_void()) {
 					//if we missed a if_done in this place, we must not missed it in promise::set
 					event_broker_promise_t::bind(std::bind(std::forward<_callable>(callee), std::placeholders::_1));
 				}
@@ -234,19 +265,45 @@ namespace netp {
 				//slow path: double check
 				if (is_done()) {
 					callee(promise_t::m_v);
-				} else {
+				} else if (!is_void()) {
 					//if we miss a if_done in this place, we must not miss it in promise::set, cuz store must happen before lock of m_mutex
 					event_broker_promise_t::bind(std::bind(std::forward<_callable>(callee), std::placeholders::_1));
 				}
 			}
 		}
 
+		//run fn(v) in loop L once this promise is done (or cancelled, with V()), the returned promise is set by fn's result
+		//a void fn is mapped to promise<int>, others to promise<std::tuple<int,R>>, the int is netp::OK or the code of what fn throws
+		//_loop_t is io_event_loop usually, anything with execute(fn_task_t) works
+		template <class _loop_t, class _callable, class _Ret = decltype(std::declval<typename std::decay<_callable>::type&>()(std::declval<V const&>()))>
+		NRP<promise<typename promise_value<_Ret>::type>> then(NRP<_loop_t> const& L, _callable&& fn) {
+			typedef typename promise_value<_Ret>::type R;
+			NRP<promise<R>> rp = netp::make_ref<promise<R>>();
+			if_done([L, rp, fn = std::forward<_callable>(fn)](V const& v) {
+				L->execute([rp, fn, v]() mutable {
+					//do not let it escape into the loop, rp would never be set
+					int ec;
+					try {
+						rp->set(promise_value<_Ret>::invoke(fn, v));
+						return;
+					} catch (netp::exception& e) {
+						ec = (e.code() != netp::OK) ? e.code() : netp::E_UNKNOWN;
+					} catch (...) {
+						ec = netp::E_UNKNOWN;
+					}
+					rp->set(promise_value<_Ret>::error(ec));
+				});
+			});
+			return rp;
+		}
+
 		//if future was destructed during set by accident, we would get a ~mutex(){} assert failed on DEBUG version
 		void set(V const& v) {
 			
 			//only one thread, one try succeed
 			u8_t s = u8_t(promise_state::S_IDLE);
 			if (NETP_UNLIKELY(!promise_t::m_state.compare_exchange_strong(s, u8_t(promise_state::S_UPDATING), std::memory_order_acq_rel, std::memory_order_acquire)) ) {
+				NETP_RETURN_IF_MATCH(s == u8_t(promise_state::S_VOID));
 				NETP_THROW("set failed: DO NOT set twice on a same promise");
 			}
 
@@ -281,6 +338,7 @@ namespace netp {
 		void set(V&& v) {
 			u8_t s = u8_t(promise_state::S_IDLE);
 			if (NETP_UNLIKELY(!promise_t::m_state.compare_exchange_strong(s, u8_t(promise_state::S_UPDATING), std::memory_order_acq_rel, std::memory_order_acquire))) {
+				NETP_RETURN_IF_MATCH(s == u8_t(promise_state::S_VOID));
 				NETP_THROW("set failed: DO NOT set twice on a same promise");
 			}
 			promise_t::m_v = v;
@@ -292,5 +350,214 @@ namespace netp {
 			promise_t::m_waiter > 0 ? m_cond->notify_all() : (void)0;
 		}
 	};
+
+	//shared by the void writes (write_void, ch_write_void), handlers could set it as any other one, nothing happens
+	//it is never released, the static could outlive the allocator at exit otherwise
+	inline NRP<promise<int>> const& void_promise() {
+		static NRP<promise<int>> const* vp = new NRP<promise<int>>(netp::make_ref<promise<int>>(promise_void_t()));
+		return *vp;
+	}
+
+	/*
+	 * @note
+	 * combinators, no thread, no lock, a shared ctx and a atomic counter (or flag) per call
+	 * every slot of the result is written by exactly one callee, the last one (acq_rel on the counter) publishes them all
+	 * a cancelled input counts as done with V()
+	 */
+	template <typename V>
+	struct __when_all_ctx :
+		public ref_base
+	{
+		std::atomic<netp::size_t> left;
+		std::vector<V> vals;
+		NRP<promise<std::vector<V>>> rp;
+
+		__when_all_ctx(netp::size_t n) :
+			left(n),
+			vals(n),
+			rp(netp::make_ref<promise<std::vector<V>>>())
+		{}
+	};
+
+	//the result keeps the order of ps
+	template <typename V>
+	NRP<promise<std::vector<V>>> when_all(std::vector<NRP<promise<V>>> const& ps) {
+		NRP<__when_all_ctx<V>> wctx = netp::make_ref<__when_all_ctx<V>>(ps.size());
+		NRP<promise<std::vector<V>>> rp = wctx->rp;
+		if (ps.size() == 0) {
+			rp->set(std::vector<V>());
+			return rp;
+		}
+		for (netp::size_t i = 0; i < ps.size(); ++i) {
+			ps[i]->if_done([wctx, i](V const& v) {
+				wctx->vals[i] = v;
+				if (wctx->left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					wctx->rp->set(std::move(wctx->vals));
+				}
+			});
+		}
+		return rp;
+	}
+
+	template <typename V>
+	struct __when_some_ctx :
+		public ref_base
+	{
+		std::atomic<netp::size_t> claimed;
+		std::atomic<netp::size_t> filled;
+		netp::size_t k;
+		std::vector<std::tuple<netp::size_t, V>> vals;
+		NRP<promise<std::vector<std::tuple<netp::size_t, V>>>> rp;
+
+		__when_some_ctx(netp::size_t k_) :
+			claimed(0),
+			filled(0),
+			k(k_),
+			vals(k_),
+			rp(netp::make_ref<promise<std::vector<std::tuple<netp::size_t, V>>>>())
+		{}
+	};
+
+	//the first k done, as {index in ps, value} in done order, k is clamped to ps.size()
+	template <typename V>
+	NRP<promise<std::vector<std::tuple<netp::size_t, V>>>> when_some(std::vector<NRP<promise<V>>> const& ps, netp::size_t k) {
+		k = (std::min)(k, ps.size());
+		NRP<__when_some_ctx<V>> wctx = netp::make_ref<__when_some_ctx<V>>(k);
+		NRP<promise<std::vector<std::tuple<netp::size_t, V>>>> rp = wctx->rp;
+		if (k == 0) {
+			rp->set(std::vector<std::tuple<netp::size_t, V>>());
+			return rp;
+		}
+		for (netp::size_t i = 0; i < ps.size(); ++i) {
+			ps[i]->if_done([wctx, i](V const& v) {
+				//claim a slot first, fill it, then the one who fills the k-th publishes
+				const netp::size_t slot = wctx->claimed.fetch_add(1, std::memory_order_relaxed);
+				if (slot >= wctx->k) {
+					return;
+				}
+				wctx->vals[slot] = std::make_tuple(i, v);
+				if (wctx->filled.fetch_add(1, std::memory_order_acq_rel) + 1 == wctx->k) {
+					wctx->rp->set(std::move(wctx->vals));
+				}
+			});
+		}
+		return rp;
+	}
+
+	template <typename V>
+	struct __when_any_ctx :
+		public ref_base
+	{
+		std::atomic<bool> settled;
+		NRP<promise<std::tuple<netp::size_t, V>>> rp;
+
+		__when_any_ctx() :
+			settled(false),
+			rp(netp::make_ref<promise<std::tuple<netp::size_t, V>>>())
+		{}
+	};
+
+	//the first done, as {index in ps, value}, ps must not be empty
+	template <typename V>
+	NRP<promise<std::tuple<netp::size_t, V>>> when_any(std::vector<NRP<promise<V>>> const& ps) {
+		NETP_ASSERT(ps.size() > 0);
+		NRP<__when_any_ctx<V>> wctx = netp::make_ref<__when_any_ctx<V>>();
+		NRP<promise<std::tuple<netp::size_t, V>>> rp = wctx->rp;
+		for (netp::size_t i = 0; i < ps.size(); ++i) {
+			ps[i]->if_done([wctx, i](V const& v) {
+				if (!wctx->settled.exchange(true, std::memory_order_acq_rel)) {
+					wctx->rp->set(std::make_tuple(i, v));
+				}
+			});
+		}
+		return rp;
+	}
+
+	/*
+	 * @note
+	 * for the promises that are created, set and watched in one thread (a io_event_loop usually)
+	 * no atomic state, no lock, no condition, callees are kept in the same inline slots as promise
+	 * it could not be waited, call shared() in the owner thread to get a thread safe promise for other threads
+	 * the write/close promises of a channel are handed in by the caller, they stay promise<int>, the loop local close calls pass nullptr
+	 */
+	template <typename V>
+	class loop_promise :
+		public non_atomic_ref_base,
+		protected event_broker_promise<V, __NETP_PROMISE_EBP_INTERNAL_SLOTS>
+	{
+		typedef event_broker_promise<V, __NETP_PROMISE_EBP_INTERNAL_SLOTS> event_broker_promise_t;
+		typedef typename event_broker_promise_t::fn_promise_callee_t fn_promise_callee_t;
+
+		u8_t m_state;
+		V m_v;
+		NRP<promise<V>> m_shared;
+
+	public:
+		loop_promise() :
+			m_state(u8_t(promise_state::S_IDLE)),
+			m_v(V()),
+			m_shared(nullptr)
+		{}
+
+		inline const V& get() const {
+			NETP_ASSERT(m_state != u8_t(promise_state::S_IDLE), "loop_promise could not be waited, use shared()");
+			return m_v;
+		}
+		const inline bool is_idle() const {
+			return m_state == u8_t(promise_state::S_IDLE);
+		}
+		const inline bool is_done() const {
+			return m_state == u8_t(promise_state::S_DONE);
+		}
+		const inline bool is_cancelled() const {
+			return m_state == u8_t(promise_state::S_CANCELLED);
+		}
+
+		bool cancel() {
+			if (m_state != u8_t(promise_state::S_IDLE)) {
+				return false;
+			}
+			m_state = u8_t(promise_state::S_CANCELLED);
+			event_broker_promise_t::invoke(V());
+			return true;
+		}
+
+		template<class _callable
+			, class = typename std::enable_if<std::is_convertible<_callable, fn_promise_callee_t>::value>::type>
+		void if_done(_callable&& callee) {
+			if (is_done()) {
+				callee(m_v);
+			} else {
+				event_broker_promise_t::bind(std::bind(std::forward<_callable>(callee), std::placeholders::_1));
+			}
+		}
+
+		void set(V const& v) {
+			if (NETP_UNLIKELY(m_state != u8_t(promise_state::S_IDLE))) {
+				NETP_THROW("set failed: DO NOT set twice on a same promise");
+			}
+			m_v = v;
+			m_state = u8_t(promise_state::S_DONE);
+			event_broker_promise_t::invoke(m_v);
+		}
+
+		//the thread safe one is allocated on first call, and set (or cancelled) by this loop_promise
+		NRP<promise<V>> const& shared() {
+			if (m_shared != nullptr) {
+				return m_shared;
+			}
+			m_shared = netp::make_ref<promise<V>>();
+			if (is_done()) {
+				m_shared->set(m_v);
+			} else if (is_cancelled()) {
+				m_shared->cancel();
+			} else {
+				event_broker_promise_t::bind([this](V const& v) {
+					is_done() ? m_shared->set(v) : (void)m_shared->cancel();
+				});
+			}
+			return m_shared;
+		}
+	};
 }
-#endif
\ No newline at end of file
+#endif
@@ -91,7 +91,7 @@ namespace netp {
 	enum rpc_write_state {
 		S_WRITE_CLOSED,
 		S_WRITE_IDLE,
-		S_WRITING
+		S_WRITING //in _do_flush
 	};
 
 	enum rpc_activity {
@@ -155,7 +155,8 @@ namespace netp {
 		typedef std::deque<NRP<netp::rpc_req_message>, netp::allocator<NRP<netp::rpc_req_message>>> rpc_message_req_queue_t;
 
 	private:
-		NRP<netp::io_event_loop> m_loop;
+		//the loop binding of the channel, rpc follows the channel on ch_migrate_to
+		NRP<netp::loop_binding> m_loop_binding;
 		rpc_write_state m_wstate;
 		fn_on_push_t m_fn_on_push;
 
@@ -164,19 +165,28 @@ namespace netp {
 		NRP<netp::ref_base> m_rpc_ctx;
 
 		rpc_message_reply_queue_t m_reply_q;
+		rpc_message_reply_queue_t m_replying_q; //written, wait for the write done
 
 		rpc_message_req_list_t m_wait_respond_list;
 		rpc_message_req_list_t m_write_list;
+		rpc_message_req_list_t m_writing_list; //written, wait for the write done
 
 		netp::u32_t m_queue_size;
 
+		//a read round defers the flush to read_complete, the replies and reqs of the round go out in one go
+		bool m_read_complete_seen;
+		bool m_flush_deferred;
+		bool m_write_blocked;
+		u32_t m_tm_seq; //the timeout timer of an old loop stops by it
+
 		void _do_reply(NRP<netp::rpc_message> const& reply);
-		void _do_reply_done(int code);
-		void _do_write_req_done(int code);
+		void _do_reply_done(NRP<netp::rpc_message> const& reply, int code);
+		void _do_write_req_done(NRP<netp::rpc_req_message> const& req, int code);
 
 		void _do_flush();
 
-		void _timer_timeout(NRP<netp::timer> const& t);
+		void _timer_launch();
+		void _timer_timeout(NRP<netp::timer> const& t, u32_t seq);
 		void _do_timer_timeout();
 
 		void _do_close(NRP<netp::promise<int>> const& op_future);
@@ -189,14 +199,16 @@ namespace netp {
 		void error(NRP<netp::channel_handler_context> const& ctx, int err);
 		void read_closed(NRP<netp::channel_handler_context> const& ctx);
 		void write_closed(NRP<netp::channel_handler_context> const& ctx);
+		void loop_migrated(NRP<netp::channel_handler_context> const& ctx, NRP<netp::io_event_loop> const& from);
 
 		void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const &income);
+		void read_complete(NRP<netp::channel_handler_context> const& ctx);
 
 	public:
-		rpc(NRP<netp::io_event_loop> const& L);
+		rpc(NRP<netp::channel> const& ch);
 		~rpc();
 
-		NRP<netp::io_event_loop> const& event_loop() const { return m_loop; }
+		NRP<netp::io_event_loop> event_loop() const { return m_loop_binding->get(); }
 		NRP<netp::channel> const& channel() const { return m_ctx->ch; }
 
 		template <class ctx_t>
@@ -222,9 +234,8 @@ namespace netp {
 		void operator >> (fn_on_push_t const& fn) ;
 
 		NRP<netp::promise<int>> set_queue_size( netp::u32_t s ) {
-			NETP_ASSERT(m_loop != nullptr);
 			NRP<netp::promise<int>> rf = netp::make_ref<netp::promise<int>>();
-			m_loop->execute([rpc_=NRP<rpc>(this), s,rf](){
+			m_loop_binding->execute([rpc_=NRP<rpc>(this), s,rf](){
 				rpc_->m_queue_size = s;
 				rf->set(netp::OK);
 			});
@@ -234,7 +245,7 @@ namespace netp {
 
 		template <class dur = std::chrono::seconds>
 		void call(NRP<netp::rpc_call_promise> const& callp, int id, NRP<netp::packet> const& data, dur const& timeout = __NETP_RPC_DEFAULT_TIMEOUT) {
-			m_loop->execute([rpc = NRP<rpc>(this), id, data, callp, timeout]() {
+			m_loop_binding->execute([rpc = NRP<rpc>(this), id, data, callp, timeout]() {
 				rpc->_do_call(callp, id, data, timeout);
 			});
 		}
@@ -242,7 +253,7 @@ namespace netp {
 		template <class dur=std::chrono::seconds>
 		NRP<netp::rpc_call_promise> call(int id, NRP<netp::packet> const& data, dur const& timeout = __NETP_RPC_DEFAULT_TIMEOUT) {
 			NRP<rpc_call_promise> callp = netp::make_ref<rpc_call_promise>();
-			m_loop->execute([rpc = NRP<rpc>(this), callp, id, data, timeout]() {
+			m_loop_binding->execute([rpc = NRP<rpc>(this), callp, id, data, timeout]() {
 				rpc->_do_call(callp, id, data, timeout);
 			});
 			return callp;
@@ -255,7 +266,7 @@ namespace netp {
 
 		template <class dur = std::chrono::seconds>
 		void do_push(NRP<rpc_push_promise> const& pushp, NRP<netp::packet> const& data, dur const& timeout = __NETP_RPC_DEFAULT_TIMEOUT) {
-			m_loop->execute([R = NRP<netp::rpc>(this), data, pushp, timeout](){
+			m_loop_binding->execute([R = NRP<netp::rpc>(this), data, pushp, timeout](){
 				R->_do_push(pushp,data, timeout);
 			});
 		}
@@ -263,7 +274,7 @@ namespace netp {
 		template <class dur=std::chrono::seconds>
 		NRP<netp::rpc_push_promise> push(NRP<netp::packet> const& data, dur const& timeout = __NETP_RPC_DEFAULT_TIMEOUT ) {
 			NRP<rpc_push_promise> pushp = netp::make_ref<rpc_push_promise>();
-			m_loop->execute([R = NRP<netp::rpc>(this), data, pushp, timeout](){
+			m_loop_binding->execute([R = NRP<netp::rpc>(this), data, pushp, timeout](){
 				R->_do_push(pushp, data, timeout);
 			});
 			return pushp;
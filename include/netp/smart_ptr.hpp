@@ -1134,6 +1134,8 @@ template<class _Ty COMMA LIST(_CLASS_TYPE)> \
 		}
 
 		__NETP_FORCE_INLINE POINTER_TYPE get() const {return (_p);}
+		//a snapshot, exact only if no other thread holds a copy
+		__NETP_FORCE_INLINE long use_count() const { return (_p == 0) ? 0 : _p->_ref_count(); }
 
 		__NETP_FORCE_INLINE bool operator == (THIS_TYPE const& r) const { return _p == r._p; }
 		__NETP_FORCE_INLINE bool operator != (THIS_TYPE const& r) const { return _p != r._p; }
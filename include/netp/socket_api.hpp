@@ -3,6 +3,7 @@
 
 #include <netp/core.hpp>
 #include <netp/address.hpp>
+#include <netp/packet.hpp>
 #include <netp/logger_broker.hpp>
 
 #ifdef _NETP_WIN
@@ -282,6 +283,39 @@ namespace netp {
 		return R;
 	}
 
+	//one syscall, a partial write returns with ec_o == OK, the caller decides whether to go on
+	inline netp::u32_t sendv(SOCKET fd, iov_t* iov, netp::u32_t n, int& ec_o, int flag) {
+		NETP_ASSERT(iov != nullptr);
+		NETP_ASSERT(n > 0);
+	_sendv:
+#ifdef _NETP_WIN
+		DWORD _nbytes = 0;
+		const int r = ::WSASend(fd, iov, DWORD(n), &_nbytes, DWORD(flag), nullptr, nullptr);
+		if (NETP_LIKELY(r == 0)) {
+			ec_o = netp::OK;
+			return netp::u32_t(_nbytes);
+		}
+#else
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n;
+		const ::ssize_t r = ::sendmsg(fd, &msg, flag);
+		if (NETP_LIKELY(r >= 0)) {
+			ec_o = netp::OK;
+			return netp::u32_t(r);
+		}
+#endif
+		int ec = netp_socket_get_last_errno();
+		_NETP_REFIX_EWOULDBLOCK(ec);
+		if (NETP_UNLIKELY(ec == netp::E_EINTR)) {
+			goto _sendv;
+		}
+		NETP_TRACE_SOCKET_API("[netp::sendv][#%d]sendv failed: %d", fd, ec);
+		ec_o = ec;
+		return 0;
+	}
+
 	inline netp::u32_t recv(SOCKET fd, byte_t* const buffer_o, netp::u32_t size, int& ec_o, int flag) {
 		NETP_ASSERT(buffer_o != nullptr);
 		NETP_ASSERT(size > 0);
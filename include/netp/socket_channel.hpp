@@ -19,6 +19,9 @@
 #define NETP_SOCKET_BDLIMIT_TIMER_DELAY_DUR (50)
 #define NETP_DEFAULT_LISTEN_BACKLOG 256
 
+//max count of outbound entries gathered by one sendv
+#define NETP_SOCKET_SENDV_IOV_MAX (64)
+
 namespace netp {
 
 	enum socket_option {
@@ -130,6 +133,8 @@ namespace netp {
 
 	struct socket_outbound_entry final {
 		NRP<non_atomic_ref_packet> data;
+		//nullptr for void write, void_promise() is not kept
+		//not a loop_promise, it comes from the writer who may wait on it from any thread
 		NRP<promise<int>> write_promise;
 		NRP<address> to;
 	};
@@ -382,6 +387,24 @@ namespace netp {
 			return netp::OK;
 		}
 
+		int _cfg_busy_poll(u32_t busy_poll_in_us) {
+			(void)busy_poll_in_us;
+#if (defined(_NETP_GNU_LINUX) || defined(_NETP_ANDROID)) && defined(SO_BUSY_POLL)
+			NETP_RETURN_V_IF_MATCH(netp::E_INVALID_OPERATION, m_fd == NETP_INVALID_SOCKET);
+			int optval = int(busy_poll_in_us);
+			int rt = socket_setsockopt_impl(SOL_SOCKET, SO_BUSY_POLL, &optval, sizeof(optval));
+			NETP_RETURN_V_IF_MATCH(netp_socket_get_last_errno(), rt == NETP_SOCKET_ERROR);
+	#ifdef SO_PREFER_BUSY_POLL
+			int prefer = busy_poll_in_us > 0 ? 1 : 0;
+			rt = socket_setsockopt_impl(SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer));
+			NETP_RETURN_V_IF_MATCH(netp_socket_get_last_errno(), rt == NETP_SOCKET_ERROR);
+	#endif
+			return netp::OK;
+#else
+			return netp::E_INVALID_OPERATION;
+#endif
+		}
+
 		int _cfg_option(u16_t opt, keep_alive_vals const& kvals) {
 			//force nonblocking
 			int rt = _cfg_nonblocking((opt & u16_t(socket_option::OPTION_NON_BLOCKING)) != 0);
@@ -482,6 +505,9 @@ namespace netp {
 		virtual int socket_send_impl(const byte_t* data, u32_t len, int& status, int flag = 0) {
 			return netp::send(m_fd, data, len, status, flag);
 		}
+		virtual int socket_sendv_impl(iov_t* iov, u32_t n, int& status, int flag = 0) {
+			return netp::sendv(m_fd, iov, n, status, flag);
+		}
 		virtual int socket_sendto_impl(const byte_t* data, u32_t len, NRP<address> const& to, int& status, int flag = 0) {
 			return netp::sendto(m_fd, data, len, to, status, flag);
 		}
@@ -609,16 +635,23 @@ namespace netp {
 				ch_close_impl(nullptr);
 				return rt;
 			}
+			if (L->cfg().sock_busy_poll != 0) {
+				//raising SO_BUSY_POLL over net.core.busy_read requires CAP_NET_ADMIN, not a fatal error
+				rt = _cfg_busy_poll(L->cfg().sock_busy_poll);
+				if (rt != netp::OK) {
+					NETP_WARN("[socket][%s]cfg busy poll failed: %d", ch_info().c_str(), rt);
+				}
+			}
 			return netp::OK;
 		}
 
 		//url example: tcp://0.0.0.0:80, udp://127.0.0.1:80
 		//@todo
 		//tcp6://ipv6address
-		void do_listen_on(NRP<promise<int>> const& intp, NRP<address> const& addr, fn_channel_initializer_t const& fn_accepted, NRP<socket_cfg> const& ccfg, int backlog = NETP_DEFAULT_LISTEN_BACKLOG);
+		void do_listen_on(NRP<loop_promise<int>> const& intp, NRP<address> const& addr, fn_channel_initializer_t const& fn_accepted, NRP<socket_cfg> const& ccfg, int backlog = NETP_DEFAULT_LISTEN_BACKLOG);
 		//NRP<promise<int>> listen_on(address const& addr, fn_channel_initializer_t const& fn_accepted, NRP<socket_cfg> const& cfg, int backlog = NETP_DEFAULT_LISTEN_BACKLOG);
 
-		void do_dial(NRP<promise<int>> const& dialp, NRP<address> const& addr, fn_channel_initializer_t const& fn_initializer);
+		void do_dial(NRP<loop_promise<int>> const& dialp, NRP<address> const& addr, fn_channel_initializer_t const& fn_initializer);
 		//NRP<promise<int>> dial(address const& addr, fn_channel_initializer_t const& initializer);
 
 		void _ch_do_close_read() {
@@ -651,9 +684,12 @@ namespace netp {
 				//hold a copy before we do pop it from queue
 				NRP<promise<int>> wp = entry.write_promise;
 				m_noutbound_bytes -= u32_t(entry.data->len());
+				ch_mem_release(u32_t(entry.data->len()));
 				m_outbound_entry_q.pop_front();
-				NETP_ASSERT(wp->is_idle());
-				wp->set(ch_errno());
+				if (wp != nullptr) {
+					NETP_ASSERT(wp->is_idle());
+					wp->set(ch_errno());
+				}
 			}
 
 			socket_shutdown_impl(SHUT_WR);
@@ -665,7 +701,7 @@ namespace netp {
 			ch_rdwr_shutdown_check();
 		}
 
-		void __do_io_dial_done(fn_channel_initializer_t const& fn_initializer, NRP<promise<int>> const& dialf, int status, io_ctx* ctx);
+		void __do_io_dial_done(fn_channel_initializer_t const& fn_initializer, NRP<loop_promise<int>> const& dialf, int status, io_ctx* ctx);
 
 		void __do_accept_fire(fn_channel_initializer_t const& ch_initializer) {
 			ch_io_begin([ch=NRP<socket_channel>(this),ch_initializer](int status, io_ctx*) {
@@ -798,6 +834,7 @@ namespace netp {
 		//==0, flush done
 		//this api would be called right after a check of writeable of the current socket
 		int ___do_io_write();
+		int ___do_io_writev();
 		int ___do_io_write_to();
 
 		//for connected socket type
@@ -808,6 +845,12 @@ namespace netp {
 			m_chflag |= int(channel_flag::F_IO_EVENT_LOOP_BEGIN_DONE);
 		}
 
+		void __ch_fire_loop_migrated(NRP<io_event_loop> const& from) {
+			_CH_FIRE_ACTION_CLOSE_AND_RETURN_IF_EXCEPTION(ch_fire_loop_migrated(from), this, "ch_fire_loop_migrated");
+		}
+		void __ch_do_migrate_done(NRP<promise<int>> const& intp, NRP<io_event_loop> const& from, bool rewatch_read);
+		void ch_migrate_to_impl(NRP<promise<int>> const& intp, NRP<io_event_loop> const& to) override;
+
 		void ch_write_impl(NRP<promise<int>> const& intp, NRP<packet> const& outlet) override;
 		void ch_write_to_impl(NRP<promise<int>> const& intp, NRP<packet> const& outlet, NRP<netp::address> const& to) override;
 
@@ -855,7 +898,7 @@ namespace netp {
 
 			NRP<promise<int>> ch_set_read_buffer_size(u32_t size) override {
 				NRP<promise<int>> chp = make_ref<promise<int>>();
-				L->execute([S = NRP<socket_channel>(this), size, chp]() {
+				m_loop_binding->execute([S = NRP<socket_channel>(this), size, chp]() {
 					chp->set(S->set_rcv_buffer_size(size));
 				});
 				return chp;
@@ -863,7 +906,7 @@ namespace netp {
 
 			NRP<promise<int>> ch_get_read_buffer_size() override {
 				NRP<promise<int>> chp = make_ref<promise<int>>();
-				L->execute([S = NRP<socket_channel>(this), chp]() {
+				m_loop_binding->execute([S = NRP<socket_channel>(this), chp]() {
 					chp->set(S->get_rcv_buffer_size());
 				});
 				return chp;
@@ -871,7 +914,7 @@ namespace netp {
 
 			NRP<promise<int>> ch_set_write_buffer_size(u32_t size) override {
 				NRP<promise<int>> chp = make_ref<promise<int>>();
-				L->execute([S = NRP<socket_channel>(this), size, chp]() {
+				m_loop_binding->execute([S = NRP<socket_channel>(this), size, chp]() {
 					chp->set(S->set_snd_buffer_size(size));
 				});
 				return chp;
@@ -879,7 +922,7 @@ namespace netp {
 
 			NRP<promise<int>> ch_get_write_buffer_size() override {
 				NRP<promise<int>> chp = make_ref<promise<int>>();
-				L->execute([S = NRP<socket_channel>(this), chp]() {
+				m_loop_binding->execute([S = NRP<socket_channel>(this), chp]() {
 					chp->set(S->get_snd_buffer_size());
 				});
 				return chp;
@@ -887,7 +930,7 @@ namespace netp {
 
 			NRP<promise<int>> ch_set_nodelay() override {
 				NRP<promise<int>> chp = make_ref<promise<int>>();
-				L->execute([s = NRP<socket_channel>(this), chp]() {
+				m_loop_binding->execute([s = NRP<socket_channel>(this), chp]() {
 					chp->set(s->cfg_nodelay(true));
 				});
 				return chp;
@@ -898,7 +941,7 @@ namespace netp {
 				return socketinfo{ m_fd, (m_family),(m_type),(m_protocol),local_addr(), remote_addr() }.to_string();
 			}
 			void ch_set_bdlimit(netp::u32_t limit) override {
-				L->execute([s = NRP<socket_channel>(this), limit]() {
+				m_loop_binding->execute([s = NRP<socket_channel>(this), limit]() {
 					s->m_outbound_limit = limit;
 					s->m_outbound_budget = s->m_outbound_limit;
 				});
@@ -0,0 +1,417 @@
+#ifndef _NETP_STATIC_PIPELINE_HPP
+#define _NETP_STATIC_PIPELINE_HPP
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+
+#include <netp/core.hpp>
+#include <netp/packet.hpp>
+#include <netp/address.hpp>
+#include <netp/channel_handler.hpp>
+#include <netp/channel_handler_context.hpp>
+
+/*
+ * @note
+ * a fixed handler stack resolved at compile time, installed as a single node of channel_pipeline:
+ *	typedef netp::static_pipeline<tls_stage, hlen_stage, rpc_stage> rpc_stack;
+ *	ch->pipeline()->add_last(netp::make_ref<rpc_stack>());
+ *
+ * 1, a stage is a plain class derived from static_handler, it hides the events it cares about with non virtual templates
+ *	  and declares them by CH_FLAG, events hop from stage to stage by direct calls, so they could be inlined
+ * 2, stage 0 is on the head side, inbound goes 0 -> n-1 then to the next node of channel_pipeline, outbound goes n-1 -> 0 then to the prev node
+ * 3, static_handler_context is a call scoped object, do not keep it, use dynamic_ctx() for anything deferred (it skips the stages on the head side for outbound)
+ * 4, dynamic_stage<H> runs an existing channel_handler_abstract H as a stage, at the cost of a virtual call and ctx bridging
+ */
+
+#define __STATIC_PIPELINE_INBOUND_0(NAME) \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, std::true_type) { \
+		static_handler_context<static_pipeline, I> sctx(this, ctx); \
+		std::get<I>(m_stages).NAME(sctx); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, std::false_type) { \
+		ctx->fire_##NAME(); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx) { \
+		__##NAME<I>(ctx, std::integral_constant<bool, (I < sizeof...(H))>()); \
+	} \
+public: \
+	void NAME(NRP<channel_handler_context> const& ctx) override { \
+		__##NAME##_at<0>(ctx); \
+	} \
+private: \
+
+#define __STATIC_PIPELINE_INBOUND_1(NAME,T1) \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, T1 a1, std::true_type) { \
+		static_handler_context<static_pipeline, I> sctx(this, ctx); \
+		std::get<I>(m_stages).NAME(sctx, a1); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, T1 a1, std::false_type) { \
+		ctx->fire_##NAME(a1); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx, T1 a1) { \
+		__##NAME<I>(ctx, a1, std::integral_constant<bool, (I < sizeof...(H))>()); \
+	} \
+public: \
+	void NAME(NRP<channel_handler_context> const& ctx, T1 a1) override { \
+		__##NAME##_at<0>(ctx, a1); \
+	} \
+private: \
+
+#define __STATIC_PIPELINE_INBOUND_2(NAME,T1,T2) \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, T1 a1, T2 a2, std::true_type) { \
+		static_handler_context<static_pipeline, I> sctx(this, ctx); \
+		std::get<I>(m_stages).NAME(sctx, a1, a2); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, T1 a1, T2 a2, std::false_type) { \
+		ctx->fire_##NAME(a1, a2); \
+	} \
+	template <size_t I> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx, T1 a1, T2 a2) { \
+		__##NAME<I>(ctx, a1, a2, std::integral_constant<bool, (I < sizeof...(H))>()); \
+	} \
+public: \
+	void NAME(NRP<channel_handler_context> const& ctx, T1 a1, T2 a2) override { \
+		__##NAME##_at<0>(ctx, a1, a2); \
+	} \
+private: \
+
+//J is the count of stages left on the head side, stage J-1 is the next one
+#define __STATIC_PIPELINE_OUTBOUND_0(NAME) \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, std::true_type) { \
+		static_handler_context<static_pipeline, J-1> sctx(this, ctx); \
+		std::get<J-1>(m_stages).NAME(intp, sctx); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, std::false_type) { \
+		ctx->NAME(intp); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp) { \
+		__##NAME<J>(ctx, intp, std::integral_constant<bool, (J > 0)>()); \
+	} \
+public: \
+	void NAME(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx) override { \
+		__##NAME##_at<sizeof...(H)>(ctx, intp); \
+	} \
+private: \
+
+#define __STATIC_PIPELINE_OUTBOUND_1(NAME,T1) \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1, std::true_type) { \
+		static_handler_context<static_pipeline, J-1> sctx(this, ctx); \
+		std::get<J-1>(m_stages).NAME(intp, sctx, a1); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1, std::false_type) { \
+		ctx->NAME(intp, a1); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1) { \
+		__##NAME<J>(ctx, intp, a1, std::integral_constant<bool, (J > 0)>()); \
+	} \
+public: \
+	void NAME(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, T1 a1) override { \
+		__##NAME##_at<sizeof...(H)>(ctx, intp, a1); \
+	} \
+private: \
+
+#define __STATIC_PIPELINE_OUTBOUND_2(NAME,T1,T2) \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1, T2 a2, std::true_type) { \
+		static_handler_context<static_pipeline, J-1> sctx(this, ctx); \
+		std::get<J-1>(m_stages).NAME(intp, sctx, a1, a2); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1, T2 a2, std::false_type) { \
+		ctx->NAME(intp, a1, a2); \
+	} \
+	template <size_t J> \
+	__NETP_FORCE_INLINE void __##NAME##_at(NRP<channel_handler_context> const& ctx, NRP<promise<int>> const& intp, T1 a1, T2 a2) { \
+		__##NAME<J>(ctx, intp, a1, a2, std::integral_constant<bool, (J > 0)>()); \
+	} \
+public: \
+	void NAME(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, T1 a1, T2 a2) override { \
+		__##NAME##_at<sizeof...(H)>(ctx, intp, a1, a2); \
+	} \
+private: \
+
+namespace netp {
+
+	template <class SP, size_t I>
+	class static_handler_context final {
+		SP* m_sp;
+		NRP<channel_handler_context> const& m_ctx;
+
+	public:
+		typedef SP pipeline_t;
+
+		static_handler_context(SP* sp, NRP<channel_handler_context> const& ctx) :
+			m_sp(sp),
+			m_ctx(ctx)
+		{}
+
+		__NETP_FORCE_INLINE SP* pipeline() const { return m_sp; }
+		//the ctx of the whole static_pipeline in channel_pipeline
+		__NETP_FORCE_INLINE NRP<channel_handler_context> const& dynamic_ctx() const { return m_ctx; }
+		__NETP_FORCE_INLINE NRP<io_event_loop> const& L() const { return m_ctx->L; }
+		__NETP_FORCE_INLINE NRP<channel> const& ch() const { return m_ctx->ch; }
+
+		__NETP_FORCE_INLINE void fire_connected() { m_sp->template __connected_at<I + 1>(m_ctx); }
+		__NETP_FORCE_INLINE void fire_closed() { m_sp->template __closed_at<I + 1>(m_ctx); }
+		__NETP_FORCE_INLINE void fire_error(int err) { m_sp->template __error_at<I + 1>(m_ctx, err); }
+		__NETP_FORCE_INLINE void fire_read_closed() { m_sp->template __read_closed_at<I + 1>(m_ctx); }
+		__NETP_FORCE_INLINE void fire_write_closed() { m_sp->template __write_closed_at<I + 1>(m_ctx); }
+		__NETP_FORCE_INLINE void fire_loop_migrated(NRP<io_event_loop> const& from) { m_sp->template __loop_migrated_at<I + 1>(m_ctx, from); }
+		__NETP_FORCE_INLINE void fire_read(NRP<packet> const& income) { m_sp->template __read_at<I + 1>(m_ctx, income); }
+		__NETP_FORCE_INLINE void fire_read_complete() { m_sp->template __read_complete_at<I + 1>(m_ctx); }
+		__NETP_FORCE_INLINE void fire_readfrom(NRP<packet> const& income, NRP<address> const& from) { m_sp->template __readfrom_at<I + 1>(m_ctx, income, from); }
+		__NETP_FORCE_INLINE void fire_user_event(int evt) { m_sp->template __user_event_at<I + 1>(m_ctx, evt); }
+
+		//must be called in L, write_void passes void_promise()
+		__NETP_FORCE_INLINE void write(NRP<promise<int>> const& intp, NRP<packet> const& outlet) {
+			NETP_ASSERT(m_ctx->L->in_event_loop());
+			m_sp->template __write_at<I>(m_ctx, intp, outlet);
+		}
+		__NETP_FORCE_INLINE NRP<promise<int>> write(NRP<packet> const& outlet) {
+			NRP<promise<int>> intp = netp::make_ref<promise<int>>();
+			write(intp, outlet);
+			return intp;
+		}
+		__NETP_FORCE_INLINE void write_void(NRP<packet> const& outlet) {
+			write(void_promise(), outlet);
+		}
+		__NETP_FORCE_INLINE void write_to(NRP<promise<int>> const& intp, NRP<packet> const& outlet, NRP<address> const& to) {
+			NETP_ASSERT(m_ctx->L->in_event_loop());
+			m_sp->template __write_to_at<I>(m_ctx, intp, outlet, to);
+		}
+		__NETP_FORCE_INLINE void close(NRP<promise<int>> const& intp) {
+			NETP_ASSERT(m_ctx->L->in_event_loop());
+			m_sp->template __close_at<I>(m_ctx, intp);
+		}
+		__NETP_FORCE_INLINE NRP<promise<int>> close() {
+			NRP<promise<int>> intp = netp::make_ref<promise<int>>();
+			close(intp);
+			return intp;
+		}
+		__NETP_FORCE_INLINE void close_read(NRP<promise<int>> const& intp) {
+			NETP_ASSERT(m_ctx->L->in_event_loop());
+			m_sp->template __close_read_at<I>(m_ctx, intp);
+		}
+		__NETP_FORCE_INLINE void close_write(NRP<promise<int>> const& intp) {
+			NETP_ASSERT(m_ctx->L->in_event_loop());
+			m_sp->template __close_write_at<I>(m_ctx, intp);
+		}
+	};
+
+	//pass everything on, a stage hides what it cares about
+	struct static_handler {
+		enum { CH_FLAG = 0 };
+
+		template <class C> __NETP_FORCE_INLINE void connected(C& ctx) { ctx.fire_connected(); }
+		template <class C> __NETP_FORCE_INLINE void closed(C& ctx) { ctx.fire_closed(); }
+		template <class C> __NETP_FORCE_INLINE void error(C& ctx, int err) { ctx.fire_error(err); }
+		template <class C> __NETP_FORCE_INLINE void read_closed(C& ctx) { ctx.fire_read_closed(); }
+		template <class C> __NETP_FORCE_INLINE void write_closed(C& ctx) { ctx.fire_write_closed(); }
+		template <class C> __NETP_FORCE_INLINE void loop_migrated(C& ctx, NRP<io_event_loop> const& from) { ctx.fire_loop_migrated(from); }
+		template <class C> __NETP_FORCE_INLINE void read(C& ctx, NRP<packet> const& income) { ctx.fire_read(income); }
+		template <class C> __NETP_FORCE_INLINE void read_complete(C& ctx) { ctx.fire_read_complete(); }
+		template <class C> __NETP_FORCE_INLINE void readfrom(C& ctx, NRP<packet> const& income, NRP<address> const& from) { ctx.fire_readfrom(income, from); }
+		template <class C> __NETP_FORCE_INLINE void user_event(C& ctx, int evt) { ctx.fire_user_event(evt); }
+
+		template <class C> __NETP_FORCE_INLINE void write(NRP<promise<int>> const& intp, C& ctx, NRP<packet> const& outlet) { ctx.write(intp, outlet); }
+		template <class C> __NETP_FORCE_INLINE void write_to(NRP<promise<int>> const& intp, C& ctx, NRP<packet> const& outlet, NRP<address> const& to) { ctx.write_to(intp, outlet, to); }
+		template <class C> __NETP_FORCE_INLINE void close(NRP<promise<int>> const& intp, C& ctx) { ctx.close(intp); }
+		template <class C> __NETP_FORCE_INLINE void close_read(NRP<promise<int>> const& intp, C& ctx) { ctx.close_read(intp); }
+		template <class C> __NETP_FORCE_INLINE void close_write(NRP<promise<int>> const& intp, C& ctx) { ctx.close_write(intp); }
+	};
+
+	template <class... H>
+	struct __static_ch_flag;
+	template <>
+	struct __static_ch_flag<> {
+		static constexpr u32_t value = 0;
+	};
+	template <class H1, class... H>
+	struct __static_ch_flag<H1, H...> {
+		static constexpr u32_t value = u32_t(H1::CH_FLAG) | __static_ch_flag<H...>::value;
+	};
+
+	template <class... H>
+	class static_pipeline final :
+		public channel_handler_abstract
+	{
+		template <class SP, size_t I> friend class static_handler_context;
+		template <class SC> friend class __static_bridge;
+
+		std::tuple<H...> m_stages;
+
+		__STATIC_PIPELINE_INBOUND_0(connected)
+		__STATIC_PIPELINE_INBOUND_0(closed)
+		__STATIC_PIPELINE_INBOUND_1(error, int)
+		__STATIC_PIPELINE_INBOUND_0(read_closed)
+		__STATIC_PIPELINE_INBOUND_0(write_closed)
+		__STATIC_PIPELINE_INBOUND_1(loop_migrated, NRP<io_event_loop> const&)
+		__STATIC_PIPELINE_INBOUND_1(read, NRP<packet> const&)
+		__STATIC_PIPELINE_INBOUND_0(read_complete)
+		__STATIC_PIPELINE_INBOUND_2(readfrom, NRP<packet> const&, NRP<address> const&)
+		__STATIC_PIPELINE_INBOUND_1(user_event, int)
+
+		__STATIC_PIPELINE_OUTBOUND_1(write, NRP<packet> const&)
+		__STATIC_PIPELINE_OUTBOUND_2(write_to, NRP<packet> const&, NRP<address> const&)
+		__STATIC_PIPELINE_OUTBOUND_0(close)
+		__STATIC_PIPELINE_OUTBOUND_0(close_read)
+		__STATIC_PIPELINE_OUTBOUND_0(close_write)
+
+	public:
+		static_assert(sizeof...(H) > 0, "static_pipeline: at least one stage");
+		static constexpr u32_t CH_FLAG = __static_ch_flag<H...>::value;
+
+		static_pipeline() :
+			channel_handler_abstract(CH_FLAG)
+		{}
+
+		template <class... A>
+		explicit static_pipeline(A&&... stages) :
+			channel_handler_abstract(CH_FLAG),
+			m_stages(std::forward<A>(stages)...)
+		{}
+
+		template <size_t I>
+		typename std::tuple_element<I, std::tuple<H...>>::type& stage() { return std::get<I>(m_stages); }
+	};
+
+	//bridges the ctx of a dynamic_stage back to the static stages around it
+	//m_ctx keeps the static_pipeline (its H) alive, the cycle is broken by channel_pipeline::deinit() which drops ctx->H
+	template <class SC>
+	class __static_bridge final :
+		public channel_handler_abstract
+	{
+		typedef typename SC::pipeline_t SP;
+		SP* m_sp;
+		NRP<channel_handler_context> m_ctx;
+
+		__NETP_FORCE_INLINE SC _sctx() const { return SC(m_sp, m_ctx); }
+	public:
+		__static_bridge(u32_t flag, SP* sp, NRP<channel_handler_context> const& ctx) :
+			channel_handler_abstract(flag),
+			m_sp(sp),
+			m_ctx(ctx)
+		{}
+
+		void connected(NRP<channel_handler_context> const&) override { _sctx().fire_connected(); }
+		void closed(NRP<channel_handler_context> const&) override { _sctx().fire_closed(); }
+		void error(NRP<channel_handler_context> const&, int err) override { _sctx().fire_error(err); }
+		void read_closed(NRP<channel_handler_context> const&) override { _sctx().fire_read_closed(); }
+		void write_closed(NRP<channel_handler_context> const&) override { _sctx().fire_write_closed(); }
+		void loop_migrated(NRP<channel_handler_context> const&, NRP<io_event_loop> const& from) override { _sctx().fire_loop_migrated(from); }
+		void read(NRP<channel_handler_context> const&, NRP<packet> const& income) override { _sctx().fire_read(income); }
+		void read_complete(NRP<channel_handler_context> const&) override { _sctx().fire_read_complete(); }
+		void readfrom(NRP<channel_handler_context> const&, NRP<packet> const& income, NRP<address> const& from) override { _sctx().fire_readfrom(income, from); }
+		void user_event(NRP<channel_handler_context> const&, int evt) override { _sctx().fire_user_event(evt); }
+
+		void write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const&, NRP<packet> const& outlet) override { _sctx().write(intp, outlet); }
+		void write_to(NRP<promise<int>> const& intp, NRP<channel_handler_context> const&, NRP<packet> const& outlet, NRP<address> const& to) override { _sctx().write_to(intp, outlet, to); }
+		void close(NRP<promise<int>> const& intp, NRP<channel_handler_context> const&) override { _sctx().close(intp); }
+		void close_read(NRP<promise<int>> const& intp, NRP<channel_handler_context> const&) override { _sctx().close_read(intp); }
+		void close_write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const&) override { _sctx().close_write(intp); }
+	};
+
+	/*
+	 * @note
+	 * H gets a private ctx (m_self) linked to two bridge ctxs:
+	 *	inbound links of m_self go to m_next, which fires the stages on the tail side
+	 *	outbound links of m_self go to m_prev, which writes to the stages on the head side
+	 * outbound into H enters by m_next, whose outbound links go to m_self if H cares, m_prev otherwise
+	 * the ctxs are built on the first event, ctx->write from other threads works as usual
+	 */
+	template <class H>
+	class dynamic_stage final {
+		NETP_DECLARE_NONCOPYABLE(dynamic_stage)
+
+		NRP<H> m_h;
+		NRP<channel_handler_context> m_self;
+		NRP<channel_handler_context> m_prev;
+		NRP<channel_handler_context> m_next;
+
+		template <class SC>
+		void _init(SC& sctx) {
+			if (NETP_LIKELY(m_self != nullptr)) {
+				return;
+			}
+			NRP<channel_handler_context> const& ctx = sctx.dynamic_ctx();
+			typedef __static_bridge<SC> bridge_t;
+			m_self = netp::make_ref<channel_handler_context>(ctx->ch, m_h);
+			m_prev = netp::make_ref<channel_handler_context>(ctx->ch, netp::make_ref<bridge_t>(u32_t(CH_OUTBOUND), sctx.pipeline(), ctx));
+			m_next = netp::make_ref<channel_handler_context>(ctx->ch, netp::make_ref<bridge_t>(u32_t(CH_ACTIVITY | CH_INBOUND | CH_ACTIVITY_LOOP_MIGRATED | CH_INBOUND_USER_EVENT | CH_INBOUND_READ_COMPLETE), sctx.pipeline(), ctx));
+			m_self->S = &m_self;
+			m_prev->S = &m_prev;
+			m_next->S = &m_next;
+
+			m_prev->N = m_self.get();
+			m_self->P = m_prev.get();
+			m_self->N = m_next.get();
+			m_next->P = m_self.get();
+			for (int i = 0; i < CTX_LINK_INBOUND_MAX; ++i) {
+				m_self->NX[i] = m_next.get();
+			}
+			for (int i = CTX_LINK_INBOUND_MAX; i < CTX_LINK_MAX; ++i) {
+				m_self->NX[i] = m_prev.get();
+				m_next->NX[i] = (m_self->H_FLAG & __ctx_link_flag[i]) ? m_self.get() : m_prev.get();
+			}
+		}
+
+	public:
+		enum { CH_FLAG = CH_ACTIVITY | CH_INBOUND | CH_OUTBOUND | CH_ACTIVITY_LOOP_MIGRATED | CH_INBOUND_USER_EVENT | CH_INBOUND_READ_COMPLETE };
+
+		template <class... A>
+		explicit dynamic_stage(A&&... args) :
+			m_h(netp::make_ref<H>(std::forward<A>(args)...))
+		{}
+
+		~dynamic_stage() {
+			if (m_self == nullptr) {
+				return;
+			}
+			//pending ctx->write in L gets E_CHANNEL_CONTEXT_DEATTACHED, and H might hold m_self
+			NRP<channel_handler_context>* ctxs[] = { &m_self, &m_prev, &m_next };
+			for (NRP<channel_handler_context>* c : ctxs) {
+				(*c)->H_FLAG |= CH_CTX_DEATTACHED;
+				(*c)->P = nullptr;
+				(*c)->N = nullptr;
+				(*c)->S = nullptr;
+				(*c)->H = nullptr;
+				std::fill((*c)->NX, (*c)->NX + CTX_LINK_MAX, nullptr);
+			}
+		}
+
+		NRP<H> const& handler() const { return m_h; }
+
+		template <class C> void connected(C& ctx) { _init(ctx); m_self->invoke_connected(); }
+		template <class C> void closed(C& ctx) { _init(ctx); m_self->invoke_closed(); }
+		template <class C> void error(C& ctx, int err) { _init(ctx); m_self->invoke_error(err); }
+		template <class C> void read_closed(C& ctx) { _init(ctx); m_self->invoke_read_closed(); }
+		template <class C> void write_closed(C& ctx) { _init(ctx); m_self->invoke_write_closed(); }
+		template <class C> void loop_migrated(C& ctx, NRP<io_event_loop> const& from) { _init(ctx); m_self->invoke_loop_migrated(from); }
+		template <class C> void read(C& ctx, NRP<packet> const& income) { _init(ctx); m_self->invoke_read(income); }
+		template <class C> void read_complete(C& ctx) { _init(ctx); m_self->invoke_read_complete(); }
+		template <class C> void readfrom(C& ctx, NRP<packet> const& income, NRP<address> const& from) { _init(ctx); m_self->invoke_readfrom(income, from); }
+		template <class C> void user_event(C& ctx, int evt) { _init(ctx); m_self->invoke_user_event(evt); }
+
+		template <class C> void write(NRP<promise<int>> const& intp, C& ctx, NRP<packet> const& outlet) { _init(ctx); m_next->write(intp, outlet); }
+		template <class C> void write_to(NRP<promise<int>> const& intp, C& ctx, NRP<packet> const& outlet, NRP<address> const& to) { _init(ctx); m_next->write_to(intp, outlet, to); }
+		template <class C> void close(NRP<promise<int>> const& intp, C& ctx) { _init(ctx); m_next->close(intp); }
+		template <class C> void close_read(NRP<promise<int>> const& intp, C& ctx) { _init(ctx); m_next->close_read(intp); }
+		template <class C> void close_write(NRP<promise<int>> const& intp, C& ctx) { _init(ctx); m_next->close_write(intp); }
+	};
+}
+#endif
@@ -48,6 +48,21 @@ namespace netp {
 	typedef std::chrono::steady_clock timer_clock_t;
 	typedef std::chrono::time_point<timer_clock_t, timer_duration_t> timer_timepoint_t;
 
+	typedef std::chrono::system_clock wall_clock_t;
+	typedef std::chrono::time_point<wall_clock_t, std::chrono::microseconds> wall_timepoint_t;
+
+	//@note: the poller of io_event_loop refresh the snapshot once per wakeup before dispatch, the loop publish it by tls_set<clock_snapshot>
+	//tls_get<clock_snapshot>() returns nullptr in a non loop thread
+	struct clock_snapshot {
+		timer_timepoint_t steady;
+		wall_timepoint_t wall;
+
+		__NETP_FORCE_INLINE void update() {
+			steady = timer_clock_t::now();
+			wall = std::chrono::time_point_cast<std::chrono::microseconds>(wall_clock_t::now());
+		}
+	};
+
 	const long long TIMER_TIME_INFINITE(~0);
 	const timer_duration_t _TIMER_DURATION_INFINITE = timer_duration_t(TIMER_TIME_INFINITE);
 	const timer_timepoint_t _TIMER_TP_INFINITE = timer_timepoint_t() + _TIMER_DURATION_INFINITE;
@@ -94,9 +109,8 @@ namespace netp {
 			static_assert(std::is_class<std::remove_reference<_callable>>::value, "_callable must be lambda or std::function type");
 		}
 		//return expire - now
-		inline timer_duration_t invoke(bool force_expire = false) {
+		inline timer_duration_t invoke(timer_timepoint_t const& now, bool force_expire = false) {
 			NETP_ASSERT(expiration != timer_timepoint_t() && expiration != _TIMER_TP_INFINITE);
-			const timer_timepoint_t now = timer_clock_t::now();
 			const timer_duration_t left = expiration - now;
 			if (left.count() <= 0LL || force_expire) {
 				invocation = now;
@@ -177,22 +191,22 @@ namespace netp {
 			//NETP_INFO("[timer_broker]cancel timer: %d", m_tq.size() + m_heap.size() );
 		}
 
-		inline void launch(NRP<timer> const& t) {
+		inline void launch(NRP<timer> const& t, timer_timepoint_t const& now) {
 			NETP_ASSERT(t != nullptr);
 			NETP_ASSERT(t->delay >= timer_duration_t(0) && (t->delay != timer_duration_t(~0)));
-			t->expiration = timer_clock_t::now() + t->delay;
+			t->expiration = now + t->delay;
 			m_tq.push_back(t);
 		}
 
-		inline void launch(NRP<timer>&& t) {
+		inline void launch(NRP<timer>&& t, timer_timepoint_t const& now) {
 			NETP_ASSERT(t != nullptr);
 			NETP_ASSERT(t->delay >= timer_duration_t(0) && (t->delay != timer_duration_t(~0)));
-			t->expiration = timer_clock_t::now() + t->delay;
+			t->expiration = now + t->delay;
 			m_tq.push_back(std::move(t));
 		}
 
 		void expire_all();
-		void expire(timer_duration_t& ndelay);
+		void expire(timer_duration_t& ndelay, timer_timepoint_t const& now);
 		const netp::size_t size() { return m_tq.size() + m_heap.size(); }
 	};
 
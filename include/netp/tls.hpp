@@ -70,7 +70,7 @@ namespace netp {
 
 	template <class T>
 	class tls {
-		NETP_DECLARE_NONCOPYABLE(tls<T>)
+		NETP_DECLARE_NONCOPYABLE(tls)
 		static __NETP_TLS T* instance;
 
 		tls() {}
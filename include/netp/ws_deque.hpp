@@ -0,0 +1,138 @@
+#ifndef _NETP_WS_DEQUE_HPP_
+#define _NETP_WS_DEQUE_HPP_
+
+#include <atomic>
+#include <vector>
+
+#include <netp/core.hpp>
+
+namespace netp {
+
+	/*
+	 * @note
+	 * Chase-Lev work stealing deque, with the memory orders of
+	 * "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13)
+	 *
+	 * push/pop: owner thread only, LIFO
+	 * steal: any thread, FIFO
+	 *
+	 * T must be trivially copyable (a pointer usually)
+	 * grown arrays are kept until destruction, a thief might still read the old one
+	 */
+	template <class T>
+	class ws_deque final {
+		NETP_DECLARE_NONCOPYABLE(ws_deque)
+
+		struct _array {
+			i64_t cap;
+			std::atomic<T>* buf;
+
+			_array(i64_t cap_) :
+				cap(cap_),
+				buf(netp::allocator<std::atomic<T>>::make_array(netp::size_t(cap_)))
+			{
+				NETP_ALLOC_CHECK(buf, sizeof(std::atomic<T>) * cap_);
+			}
+			~_array() {
+				netp::allocator<std::atomic<T>>::trash_array(buf, netp::size_t(cap));
+			}
+
+			__NETP_FORCE_INLINE T get(i64_t i) const {
+				return buf[i & (cap - 1)].load(std::memory_order_relaxed);
+			}
+			__NETP_FORCE_INLINE void put(i64_t i, T v) {
+				buf[i & (cap - 1)].store(v, std::memory_order_relaxed);
+			}
+		};
+
+		//keep top (thieves) and bottom (owner) on different cache lines
+		std::atomic<i64_t> m_top;
+		byte_t __pad[64 - sizeof(std::atomic<i64_t>)];
+		std::atomic<i64_t> m_bottom;
+		std::atomic<_array*> m_array;
+		std::vector<_array*> m_retired;
+
+		_array* _grow(_array* a, i64_t b, i64_t t) {
+			_array* na = netp::allocator<_array>::make(a->cap << 1);
+			NETP_ALLOC_CHECK(na, sizeof(_array));
+			for (i64_t i = t; i < b; ++i) {
+				na->put(i, a->get(i));
+			}
+			m_retired.push_back(a);
+			m_array.store(na, std::memory_order_release);
+			return na;
+		}
+
+	public:
+		//cap must be power of 2
+		ws_deque(i64_t cap = 256) :
+			m_top(0),
+			m_bottom(0),
+			m_array(netp::allocator<_array>::make(cap))
+		{
+			NETP_ASSERT(cap > 0 && ((cap & (cap - 1)) == 0));
+		}
+
+		~ws_deque() {
+			for (_array* a : m_retired) {
+				netp::allocator<_array>::trash(a);
+			}
+			netp::allocator<_array>::trash(m_array.load(std::memory_order_relaxed));
+		}
+
+		//approximate if called by non-owner
+		inline i64_t size() const {
+			const i64_t b = m_bottom.load(std::memory_order_relaxed);
+			const i64_t t = m_top.load(std::memory_order_relaxed);
+			return b > t ? (b - t) : 0;
+		}
+
+		inline bool empty() const { return size() == 0; }
+
+		void push(T v) {
+			const i64_t b = m_bottom.load(std::memory_order_relaxed);
+			const i64_t t = m_top.load(std::memory_order_acquire);
+			_array* a = m_array.load(std::memory_order_relaxed);
+			if (NETP_UNLIKELY((b - t) > (a->cap - 1))) {
+				a = _grow(a, b, t);
+			}
+			a->put(b, v);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		bool pop(T& v) {
+			const i64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+			_array* a = m_array.load(std::memory_order_relaxed);
+			m_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			i64_t t = m_top.load(std::memory_order_relaxed);
+			if (t > b) {
+				//empty
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+			v = a->get(b);
+			if (t == b) {
+				//the last one, race against thieves
+				const bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		bool steal(T& v) {
+			i64_t t = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const i64_t b = m_bottom.load(std::memory_order_acquire);
+			if (t >= b) {
+				return false;
+			}
+			_array* a = m_array.load(std::memory_order_acquire);
+			v = a->get(t);
+			return m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+	};
+}
+#endif
@@ -87,8 +87,7 @@ namespace netp {
 		netp::tls_create<netp::impl::thread_data>();
 
 #ifdef NETP_MEMORY_USE_TLS_POOL
-		netp::global_pool_aligned_allocator::instance();
-		netp::tls_create<netp::pool_aligned_allocator_t>();
+		netp::global_pool_aligned_allocator::instance()->stat_attach(netp::tls_create<netp::pool_aligned_allocator_t>());
 #endif
 
 #if defined(_DEBUG_MUTEX) || defined(_DEBUG_SHARED_MUTEX)
@@ -133,6 +132,50 @@ namespace netp {
 		if (cfg_json.find("def_loop_channel_buf") != cfg_json.end()) {
 			cfg_channel_buf(NETP_DEFAULT_POLLER_TYPE, cfg_json["def_loop_channel_buf"].get<int>());
 		}
+
+		if (cfg_json.find("def_loop_busy_poll") != cfg_json.end()) {
+			int sock_busy_poll = 0;
+			if (cfg_json.find("def_loop_sock_busy_poll") != cfg_json.end()) {
+				sock_busy_poll = cfg_json["def_loop_sock_busy_poll"].get<int>();
+			}
+			cfg_busy_poll(NETP_DEFAULT_POLLER_TYPE, cfg_json["def_loop_busy_poll"].get<int>(), sock_busy_poll);
+		}
+
+		if (cfg_json.find("def_loop_mem_decay") != cfg_json.end()) {
+			cfg_memory_decay(NETP_DEFAULT_POLLER_TYPE, cfg_json["def_loop_mem_decay"].get<int>());
+		}
+
+		if (cfg_json.find("mem_tls_cached_bytes_max") != cfg_json.end() || cfg_json.find("mem_global_cached_bytes_max") != cfg_json.end()) {
+			size_t tls_max = 0;
+			size_t global_max = 0;
+			if (cfg_json.find("mem_tls_cached_bytes_max") != cfg_json.end()) {
+				tls_max = cfg_json["mem_tls_cached_bytes_max"].get<size_t>();
+			}
+			if (cfg_json.find("mem_global_cached_bytes_max") != cfg_json.end()) {
+				global_max = cfg_json["mem_global_cached_bytes_max"].get<size_t>();
+			}
+			cfg_memory_cached_bytes_max(tls_max, global_max);
+		}
+
+		if (cfg_json.find("mem_preallocate_eager") != cfg_json.end()) {
+			cfg_memory_preallocate(cfg_json["mem_preallocate_eager"].get<bool>());
+		}
+
+		if (cfg_json.find("mem_budget_max") != cfg_json.end() || cfg_json.find("mem_budget_channel_max") != cfg_json.end()) {
+			size_t process_max = 0;
+			u32_t channel_max = 0;
+			if (cfg_json.find("mem_budget_max") != cfg_json.end()) {
+				process_max = cfg_json["mem_budget_max"].get<size_t>();
+			}
+			if (cfg_json.find("mem_budget_channel_max") != cfg_json.end()) {
+				channel_max = cfg_json["mem_budget_channel_max"].get<u32_t>();
+			}
+			cfg_memory_budget(process_max, channel_max);
+		}
+
+		if (cfg_json.find("compute_worker_count") != cfg_json.end()) {
+			cfg_compute_worker_count(cfg_json["compute_worker_count"].get<int>());
+		}
 	}
 
 	void app_cfg::__parse_cfg(int argc, char** argv) {
@@ -209,6 +252,11 @@ namespace netp {
 			exit(-2);
 		}
 
+#ifdef NETP_MEMORY_USE_TLS_POOL
+		netp::allocator_cfg_cached_bytes_max(m_cfg.mem_tls_cached_bytes_max, m_cfg.mem_global_cached_bytes_max);
+		netp::allocator_cfg_preallocate(m_cfg.mem_preallocate_eager);
+#endif
+		netp::channel_mem_budget_cfg(m_cfg.mem_budget_max, m_cfg.mem_budget_channel_max);
 		__signal_init();
 		__net_init();
 	}
@@ -399,6 +447,7 @@ namespace netp {
 		if (m_app_event_loop_init_prev) {
 			m_app_event_loop_init_prev();
 		}	
+		netp::compute_pool::instance()->cfg_worker_count(u32_t(m_cfg.compute_worker_count));
 		___event_loop_init();
 		if (m_app_event_loop_init_post) {
 			m_app_event_loop_init_post();
@@ -411,6 +460,8 @@ namespace netp {
 		NETP_INFO("net deinit begin");
 		netp::io_event_loop_group::instance()->_notify_terminating_all();
 		netp::dns_resolver::instance()->stop();
+		//no result could be delivered to a terminated loop
+		netp::compute_pool::instance()->stop();
 		if (m_app_event_loop_deinit_prev) {
 			m_app_event_loop_deinit_prev();
 		}
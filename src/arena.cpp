@@ -0,0 +1,63 @@
+#include <netp/arena.hpp>
+
+namespace netp {
+
+	arena::arena(u32_t block_size) :
+		m_blocks(nullptr),
+		m_cur(nullptr),
+		m_end(nullptr),
+		m_block_size(block_size),
+		m_allocated(0),
+		m_live(0)
+	{
+		NETP_ASSERT(block_size > sizeof(block));
+	}
+
+	arena::~arena() {
+		NETP_ASSERT(m_live.load(std::memory_order_acquire) == 0, "live: %u", m_live.load(std::memory_order_relaxed));
+		__free_blocks(m_blocks);
+	}
+
+	void arena::__free_blocks(block* b) {
+		while (b != nullptr) {
+			block* next = b->next;
+			netp::allocator<byte_t>::free((byte_t*)b);
+			b = next;
+		}
+	}
+
+	void* arena::__allocate_slow(size_t size, size_t alignment) {
+		//a big one gets a block of its own, keep bumping on the current block
+		const size_t hdr = (sizeof(block) + (alignment - 1)) & ~(alignment - 1);
+		const bool own = (hdr + size) > (m_block_size >> 1);
+		const size_t bsize = own ? (hdr + size) : m_block_size;
+		block* b = (block*)netp::allocator<byte_t>::malloc(bsize);
+		NETP_ALLOC_CHECK(b, bsize);
+		b->size = bsize;
+		byte_t* p = (byte_t*)b + hdr;
+		if (own && m_blocks != nullptr) {
+			b->next = m_blocks->next;
+			m_blocks->next = b;
+		} else {
+			b->next = m_blocks;
+			m_blocks = b;
+			m_cur = p + size;
+			m_end = (byte_t*)b + bsize;
+		}
+		m_allocated += size;
+		m_live.fetch_add(1, std::memory_order_relaxed);
+		return p;
+	}
+
+	bool arena::reset() {
+		if (m_live.load(std::memory_order_acquire) != 0) {
+			return false;
+		}
+		//an idle connection keeps nothing, a block is a pooled item, the next request gets it back cheap
+		__free_blocks(m_blocks);
+		m_blocks = nullptr;
+		m_cur = m_end = nullptr;
+		m_allocated = 0;
+		return true;
+	}
+}
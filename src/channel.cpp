@@ -0,0 +1,73 @@
+#include <netp/channel.hpp>
+#include <netp/logger_broker.hpp>
+
+namespace netp {
+
+	std::atomic<size_t> channel_mem_budget::used(0);
+	std::atomic<size_t> channel_mem_budget::used_in(0);
+	std::atomic<size_t> channel_mem_budget::process_max(0);
+	std::atomic<u32_t> channel_mem_budget::channel_max(0);
+
+	void channel_mem_budget_cfg(size_t process_max, u32_t channel_max) {
+		channel_mem_budget::process_max.store(process_max, std::memory_order_relaxed);
+		channel_mem_budget::channel_max.store(channel_max, std::memory_order_relaxed);
+	}
+
+	bool channel::ch_mem_pause_read() {
+		NETP_ASSERT(L->in_event_loop());
+		//a custom reader drives its own read loop
+		const int default_read = int(channel_flag::F_WATCH_READ) | int(channel_flag::F_USE_DEFAULT_READ);
+		if ((m_chflag & default_read) != default_read) {
+			return false;
+		}
+		ch_io_end_read();
+		m_chflag |= int(channel_flag::F_MEM_PAUSED);
+		NETP_VERBOSE("[channel][%s]read paused, channel bytes: %u, process bytes: %llu", ch_info().c_str(), m_mem_bytes, (unsigned long long)channel_mem_budget_used());
+
+		//the bytes of other channels drain without telling us, poll for them
+		if ((m_chflag & int(channel_flag::F_MEM_PAUSE_TIMER)) == 0) {
+			m_chflag |= int(channel_flag::F_MEM_PAUSE_TIMER);
+			L->launch(netp::make_ref<netp::timer>(std::chrono::milliseconds(NETP_CHANNEL_MEM_RESUME_CHECK_DUR), &channel::_tmcb_mem_resume, NRP<channel>(this), std::placeholders::_1));
+		}
+		return true;
+	}
+
+	bool channel::ch_mem_resume_read() {
+		NETP_ASSERT(L->in_event_loop());
+		if ((m_chflag & int(channel_flag::F_MEM_PAUSED)) == 0) {
+			return true;
+		}
+		if (m_chflag & (int(channel_flag::F_READ_SHUTDOWNING) | int(channel_flag::F_READ_SHUTDOWN) | int(channel_flag::F_CLOSE_PENDING) | int(channel_flag::F_CLOSING) | int(channel_flag::F_CLOSED))) {
+			m_chflag &= ~int(channel_flag::F_MEM_PAUSED);
+			return true;
+		}
+		const u32_t ch_max = channel_mem_budget::channel_max.load(std::memory_order_relaxed);
+		if ((ch_max != 0) && ((m_mem_bytes - m_mem_in_bytes) > NETP_CHANNEL_MEM_RESUME_WATERMARK(ch_max))) {
+			return false;
+		}
+		const size_t process_max = channel_mem_budget::process_max.load(std::memory_order_relaxed);
+		if ((process_max != 0) && (channel_mem_budget_out_used() > NETP_CHANNEL_MEM_RESUME_WATERMARK(process_max))) {
+			return false;
+		}
+		m_chflag &= ~int(channel_flag::F_MEM_PAUSED);
+		NETP_VERBOSE("[channel][%s]read resumed, channel bytes: %u, process bytes: %llu", ch_info().c_str(), m_mem_bytes, (unsigned long long)channel_mem_budget_used());
+		ch_io_read();
+		return true;
+	}
+
+	void channel::_tmcb_mem_resume(NRP<timer> const& t) {
+		if (NETP_UNLIKELY(!m_loop_binding->in_event_loop())) {
+			//launched by the loop we migrated from, continue in the current loop
+			m_loop_binding->execute([ch = NRP<channel>(this), t]() {
+				ch->_tmcb_mem_resume(t);
+			});
+			return;
+		}
+		NETP_ASSERT(m_chflag & int(channel_flag::F_MEM_PAUSE_TIMER));
+		m_chflag &= ~int(channel_flag::F_MEM_PAUSE_TIMER);
+		if (!ch_mem_resume_read()) {
+			m_chflag |= int(channel_flag::F_MEM_PAUSE_TIMER);
+			L->launch(t, netp::make_ref<netp::promise<int>>());
+		}
+	}
+}
@@ -48,6 +48,13 @@ namespace netp {
 	VOID_FIRE_HANDLER_DEFAULT_IMPL_0(read_closed, CH_ACTIVITY_READ_CLOSED, channel_handler_abstract)
 	VOID_FIRE_HANDLER_DEFAULT_IMPL_0(write_closed, CH_ACTIVITY_WRITE_CLOSED, channel_handler_abstract)
 	
+	void channel_handler_abstract::loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from) {
+		NETP_ASSERT(CH_H_FLAG & CH_ACTIVITY_LOOP_MIGRATED);
+		NETP_THROW("CH_ACTIVITY_LOOP_MIGRATED MUST IMPL ITS OWN loop_migrated");
+		(void)ctx;
+		(void)from;
+	}
+
 	//VOID_FIRE_HANDLER_DEFAULT_IMPL_0(write_block, CH_ACTIVITY_WRITE_BLOCK, channel_handler_abstract)
 	//VOID_FIRE_HANDLER_DEFAULT_IMPL_0(write_unblock, CH_ACTIVITY_WRITE_UNBLOCK, channel_handler_abstract)
 
@@ -58,6 +65,8 @@ namespace netp {
 		(void)income;
 	}
 
+	VOID_FIRE_HANDLER_DEFAULT_IMPL_0(read_complete, CH_INBOUND_READ_COMPLETE, channel_handler_abstract)
+
 	void channel_handler_abstract::readfrom(NRP<channel_handler_context> const& ctx, NRP<packet> const& income, NRP<address> const& from) {
 		NETP_ASSERT(CH_H_FLAG & CH_INBOUND_READ_FROM);
 		NETP_THROW("CH_INBOUND_READ_FROM MUST IMPL ITS OWN readfrom");
@@ -66,6 +75,13 @@ namespace netp {
 		(void)from;
 	}
 	
+	void channel_handler_abstract::user_event(NRP<channel_handler_context> const& ctx, int evt) {
+		NETP_ASSERT(CH_H_FLAG & CH_INBOUND_USER_EVENT);
+		NETP_THROW("CH_INBOUND_USER_EVENT MUST IMPL ITS OWN user_event");
+		(void)ctx;
+		(void)evt;
+	}
+
 	void channel_handler_abstract::write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet) {
 		NETP_ASSERT(CH_H_FLAG & CH_OUTBOUND_WRITE);
 		NETP_THROW("CH_OUTBOUND_WRITE MUST IMPL ITS OWN write");
@@ -137,6 +153,12 @@ namespace netp {
 		(void)ctx;
 	}
 
+	void channel_handler_tail::loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from) {
+		NETP_TRACE_CHANNEL("[#%s][tail]channel loop migrated, no action", ctx->ch->ch_info().c_str());
+		(void)ctx;
+		(void)from;
+	}
+
 	void channel_handler_tail::read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
 		//NETP_ASSERT(ctx->ch != nullptr);
 		NETP_ERR("[#%s][tail]channel read, we reach the end of the pipeline , please check your pipeline configure, no action", ctx->ch->ch_info().c_str() );
@@ -144,10 +166,20 @@ namespace netp {
 		(void)income;
 	}
 
+	void channel_handler_tail::read_complete(NRP<channel_handler_context> const& ctx) {
+		(void)ctx;
+	}
+
 	void channel_handler_tail::readfrom(NRP<channel_handler_context> const& ctx, NRP<packet> const& income, NRP<address> const& from) {
 		//NETP_ASSERT(ctx->ch != nullptr);
 		NETP_ERR("[#%s][tail]channel readfrom, we reach the end of the pipeline , please check your pipeline configure, no action, from: %s", ctx->ch->ch_info().c_str(), from->to_string().c_str() );
 		(void)ctx;
 		(void)income;
 	}
+
+	void channel_handler_tail::user_event(NRP<channel_handler_context> const& ctx, int evt) {
+		NETP_TRACE_CHANNEL("[#%s][tail]channel user_event: %d, no action", ctx->ch->ch_info().c_str(), evt);
+		(void)ctx;
+		(void)evt;
+	}
 }
\ No newline at end of file
@@ -1,11 +1,30 @@
 #include <netp/channel.hpp>
 #include <netp/channel_handler.hpp>
 #include <netp/channel_handler_context.hpp>
+#include <netp/channel_pipeline.hpp>
 
 namespace netp {
 
 	channel_handler_context::channel_handler_context(NRP<netp::channel> const& ch_, NRP<channel_handler_abstract> const& h):
-		L(ch_->L), ch(ch_), H_FLAG(h->CH_H_FLAG), P(nullptr), N(nullptr), H(h)
+		L(ch_->L), ch(ch_), LB(ch_->ch_loop_binding().get()), H_FLAG(h->CH_H_FLAG), P(nullptr), N(nullptr), S(nullptr), H(h)
 	{
+		std::fill(NX, NX + CTX_LINK_MAX, nullptr);
+	}
+
+	void channel_handler_context::do_remove_from_pipeline(NRP<netp::promise<int>> const& p) {
+		NETP_ASSERT(L->in_event_loop());
+		//HEAD,TAIL will never BE REMOVED from outside
+		NETP_ASSERT(P != nullptr && N != nullptr );
+		H_FLAG |= CH_CTX_DEATTACHED;
+
+		//we might be in the middle of a fire, bypass it right now, unlink&release it later
+		NRP<channel_pipeline> const& ppl = ch->pipeline();
+		if (ppl != nullptr) {
+			ppl->__relink();
+			L->schedule([ppl]() {
+				ppl->__purge_deattached();
+			});
+		}
+		p->set(netp::OK);
 	}
 }
\ No newline at end of file
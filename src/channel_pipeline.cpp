@@ -4,7 +4,7 @@
 namespace netp {
 
 	channel_pipeline::channel_pipeline(NRP<channel> const& ch):
-		m_loop(ch->L),
+		m_loop_binding(ch->ch_loop_binding()),
 		m_ch(ch)
 	{
 		NETP_TRACE_CHANNEL("channel_pipeline::channel_pipeline()");
@@ -23,22 +23,80 @@ namespace netp {
 		NRP<channel_handler_tail> t = netp::make_ref<channel_handler_tail>();
 		m_tail = netp::make_ref<channel_handler_context>(m_ch, t);
 
+		m_head->S = &m_head;
+		m_tail->S = &m_tail;
+
 		m_head->P = nullptr;
-		m_head->N = m_tail;
-		m_tail->P = m_head;
+		m_head->N = m_tail.get();
+		m_tail->P = m_head.get();
 		m_tail->N = nullptr;
+		__relink();
+	}
+
+	void channel_pipeline::__relink()
+	{
+		channel_handler_context* _link[CTX_LINK_MAX];
+
+		//inbound: from tail to head, remember the nearest interested one on the tail side
+		std::fill(_link, _link + CTX_LINK_INBOUND_MAX, nullptr);
+		for (channel_handler_context* _hctx = m_tail.get(); _hctx != nullptr; _hctx = _hctx->P) {
+			for (int i = 0; i < CTX_LINK_INBOUND_MAX; ++i) {
+				_hctx->NX[i] = _link[i];
+				if ((_hctx->H_FLAG & (__ctx_link_flag[i] | CH_CTX_DEATTACHED)) == __ctx_link_flag[i]) {
+					_link[i] = _hctx;
+				}
+			}
+		}
+
+		//outbound: from head to tail, remember the nearest interested one on the head side
+		std::fill(_link + CTX_LINK_INBOUND_MAX, _link + CTX_LINK_MAX, nullptr);
+		for (channel_handler_context* _hctx = m_head.get(); _hctx != nullptr; _hctx = _hctx->N) {
+			for (int i = CTX_LINK_INBOUND_MAX; i < CTX_LINK_MAX; ++i) {
+				_hctx->NX[i] = _link[i];
+				if ((_hctx->H_FLAG & (__ctx_link_flag[i] | CH_CTX_DEATTACHED)) == __ctx_link_flag[i]) {
+					_link[i] = _hctx;
+				}
+			}
+		}
+	}
+
+	void channel_pipeline::__purge_deattached()
+	{
+		NETP_ASSERT(m_loop_binding->in_event_loop());
+		context_list_t::iterator it = m_ctxs.begin();
+		while (it != m_ctxs.end()) {
+			channel_handler_context* _hctx = it->get();
+			if (!(_hctx->H_FLAG & CH_CTX_DEATTACHED)) {
+				++it;
+				continue;
+			}
+			_hctx->P->N = _hctx->N;
+			_hctx->N->P = _hctx->P;
+			_hctx->P = nullptr;
+			_hctx->N = nullptr;
+			_hctx->S = nullptr;
+			std::fill(_hctx->NX, _hctx->NX + CTX_LINK_MAX, nullptr);
+			//break the ctx<->handler ref cycle if the handler holds its ctx
+			_hctx->H = nullptr;
+			it = m_ctxs.erase(it);
+		}
 	}
 
 	void channel_pipeline::deinit()
 	{
-		NRP<channel_handler_context> _hctx = m_tail;
+		channel_handler_context* _hctx = m_tail.get();
 		while (_hctx != nullptr ) {
+			channel_handler_context* _prev = _hctx->P;
 			_hctx->H_FLAG |= CH_CTX_DEATTACHED; //clear all
 
 			_hctx->N = nullptr;
+			_hctx->P = nullptr;
+			_hctx->S = nullptr;
 			_hctx->H = nullptr;
+			std::fill(_hctx->NX, _hctx->NX + CTX_LINK_MAX, nullptr);
 
-			_hctx = _hctx->P;
+			_hctx = _prev;
 		}
+		m_ctxs.clear();
 	}
 }
\ No newline at end of file
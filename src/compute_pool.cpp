@@ -0,0 +1,216 @@
+#include <netp/core.hpp>
+#include <netp/logger_broker.hpp>
+
+#include <netp/compute_pool.hpp>
+
+namespace netp {
+
+	//spin a little before parking, a task is usually around the corner under load
+	#define NETP_COMPUTE_WORKER_SPIN_ROUND (64)
+
+	void compute_worker::__run() {
+		tls_set<compute_worker>(this);
+		compute_pool* pool = m_pool;
+		fn_task_t* t = nullptr;
+		while (pool->m_state.load(std::memory_order_acquire) == u8_t(compute_pool::pool_state::S_RUNNING)) {
+			if (!pool->_take(this, t)) {
+				pool->_park();
+				continue;
+			}
+			pool->m_pending.fetch_sub(1, std::memory_order_relaxed);
+			try {
+				(*t)();
+			} catch (netp::exception& e) {
+				NETP_ERR("[compute_pool][#%u]task exception: [%d]%s\n%s(%d) %s\ncallstack: \n%s",
+					m_idx, e.code(), e.what(), e.file(), e.line(), e.function(), e.callstack());
+			} catch (std::exception& e) {
+				NETP_ERR("[compute_pool][#%u]task exception: %s", m_idx, e.what());
+			} catch (...) {
+				NETP_ERR("[compute_pool][#%u]task unknown exception", m_idx);
+			}
+			netp::allocator<fn_task_t>::trash(t);
+		}
+		tls_set<compute_worker>(nullptr);
+	}
+
+	compute_pool::compute_pool() :
+		m_state(u8_t(pool_state::S_IDLE)),
+		m_worker_count(0),
+		m_pending(0),
+		m_sleepers(0),
+		m_pushers(0)
+	{}
+
+	compute_pool::~compute_pool() {
+		stop();
+	}
+
+	void compute_pool::cfg_worker_count(u32_t count) {
+		lock_guard<mutex> lg(m_mtx);
+		m_worker_count = count;
+	}
+
+	int compute_pool::start() {
+		lock_guard<mutex> lg(m_mtx);
+		const u8_t s = m_state.load(std::memory_order_acquire);
+		NETP_RETURN_V_IF_MATCH(netp::OK, s == u8_t(pool_state::S_RUNNING));
+		NETP_RETURN_V_IF_MATCH(netp::E_INVALID_STATE, s == u8_t(pool_state::S_EXIT));
+
+		const u32_t count = m_worker_count > 0 ? m_worker_count : (std::max)(1u, std::thread::hardware_concurrency());
+		//workers read m_workers when stealing, fill it before any thread starts
+		m_workers.reserve(count);
+		for (u32_t i = 0; i < count; ++i) {
+			m_workers.push_back(netp::make_ref<compute_worker>(this, i));
+		}
+		m_state.store(u8_t(pool_state::S_RUNNING), std::memory_order_release);
+		for (u32_t i = 0; i < count; ++i) {
+			NRP<compute_worker>& w = m_workers[i];
+			w->m_th = netp::make_ref<netp::thread>();
+			int rt = w->m_th->start(&compute_worker::__run, w);
+			if (rt != netp::OK) {
+				//we can not shrink m_workers any more, the slot would be stolen from and never be pushed into
+				NETP_ERR("[compute_pool]start worker #%u failed: %d", i, rt);
+				w->m_th = nullptr;
+			}
+		}
+		NETP_INFO("[compute_pool]started, worker count: %u", count);
+		return netp::OK;
+	}
+
+	void compute_pool::stop() {
+		{
+			lock_guard<mutex> lg(m_mtx);
+			if (m_state.load(std::memory_order_acquire) != u8_t(pool_state::S_RUNNING)) {
+				m_state.store(u8_t(pool_state::S_EXIT), std::memory_order_release);
+				return;
+			}
+			m_state.store(u8_t(pool_state::S_EXIT), std::memory_order_seq_cst);
+			m_cond.no_interrupt_notify_all();
+		}
+
+		//pair with execute: pushers++ then check state, state=EXIT then wait for the pushers that passed the check
+		u32_t k = 0;
+		while (m_pushers.load(std::memory_order_seq_cst) != 0) {
+			netp::this_thread::no_interrupt_yield(++k);
+		}
+
+		for (NRP<compute_worker>& w : m_workers) {
+			if (w->m_th != nullptr) {
+				w->m_th->join();
+				w->m_th = nullptr;
+			}
+		}
+
+		i64_t dropped = 0;
+		fn_task_t* t = nullptr;
+		for (NRP<compute_worker>& w : m_workers) {
+			while (w->m_q.pop(t)) {
+				netp::allocator<fn_task_t>::trash(t);
+				++dropped;
+			}
+		}
+		{
+			lock_guard<spin_mutex> lg(m_inject_mtx);
+			while (!m_inject.empty()) {
+				netp::allocator<fn_task_t>::trash(m_inject.front());
+				m_inject.pop_front();
+				++dropped;
+			}
+		}
+		m_workers.clear();
+		m_pending.store(0, std::memory_order_relaxed);
+		NETP_INFO("[compute_pool]stopped, dropped task: %lld", dropped);
+	}
+
+	bool compute_pool::_take(compute_worker* w, fn_task_t*& t) {
+		if (w->m_q.pop(t)) {
+			return true;
+		}
+		{
+			lock_guard<spin_mutex> lg(m_inject_mtx);
+			if (!m_inject.empty()) {
+				t = m_inject.front();
+				m_inject.pop_front();
+				return true;
+			}
+		}
+
+		const u32_t n = u32_t(m_workers.size());
+		if (n < 2) {
+			return false;
+		}
+		//xorshift32, start from a random victim to spread the contention
+		w->m_seed ^= w->m_seed << 13;
+		w->m_seed ^= w->m_seed >> 17;
+		w->m_seed ^= w->m_seed << 5;
+		const u32_t begin = w->m_seed % n;
+		for (u32_t i = 0; i < n; ++i) {
+			compute_worker* victim = m_workers[(begin + i) % n].get();
+			if (victim == w) {
+				continue;
+			}
+			//a failed cas means someone else got one, the victim may have more
+			while (!victim->m_q.empty()) {
+				if (victim->m_q.steal(t)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void compute_pool::_park() {
+		for (u32_t k = 0; k < NETP_COMPUTE_WORKER_SPIN_ROUND; ++k) {
+			if (m_pending.load(std::memory_order_acquire) > 0) {
+				return;
+			}
+			netp::this_thread::no_interrupt_yield(k);
+		}
+
+		unique_lock<mutex> ulk(m_mtx);
+		//pair with _push: pending++ then check sleepers, sleepers++ then check pending
+		m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+		while (m_pending.load(std::memory_order_seq_cst) == 0 && m_state.load(std::memory_order_acquire) == u8_t(pool_state::S_RUNNING)) {
+			m_cond.no_interrupt_wait(ulk);
+		}
+		m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void compute_pool::_push(fn_task_t* t) {
+		compute_worker* w = tls_get<compute_worker>();
+		if (w != nullptr && w->m_pool == this) {
+			w->m_q.push(t);
+		} else {
+			lock_guard<spin_mutex> lg(m_inject_mtx);
+			m_inject.push_back(t);
+		}
+
+		m_pending.fetch_add(1, std::memory_order_seq_cst);
+		if (m_sleepers.load(std::memory_order_seq_cst) > 0) {
+			lock_guard<mutex> lg(m_mtx);
+			m_cond.no_interrupt_notify_one();
+		}
+	}
+
+	int compute_pool::execute(fn_task_t&& f) {
+		if (NETP_UNLIKELY(m_state.load(std::memory_order_acquire) != u8_t(pool_state::S_RUNNING))) {
+			int rt = start();
+			if (rt != netp::OK) {
+				return rt;
+			}
+		}
+		fn_task_t* t = netp::allocator<fn_task_t>::make(std::move(f));
+		NETP_ALLOC_CHECK(t, sizeof(fn_task_t));
+
+		//a task pushed after stop() drained would never be run nor freed
+		m_pushers.fetch_add(1, std::memory_order_seq_cst);
+		if (NETP_UNLIKELY(m_state.load(std::memory_order_seq_cst) != u8_t(pool_state::S_RUNNING))) {
+			m_pushers.fetch_sub(1, std::memory_order_seq_cst);
+			netp::allocator<fn_task_t>::trash(t);
+			return netp::E_INVALID_STATE;
+		}
+		_push(t);
+		m_pushers.fetch_sub(1, std::memory_order_seq_cst);
+		return netp::OK;
+	}
+}
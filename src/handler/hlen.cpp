@@ -1,5 +1,6 @@
 #include <netp/handler/hlen.hpp>
 #include <netp/channel_handler_context.hpp>
+#include <netp/channel.hpp>
 
 namespace netp { namespace handler {
 
@@ -7,25 +8,116 @@ namespace netp { namespace handler {
 		m_read_closed = false;
 		ctx->fire_connected();
 	}
+	void hlen::closed(NRP<channel_handler_context> const& ctx) {
+		m_batching = false;
+		m_batch = nullptr;
+		promise_vector_t ps;
+		ps.swap(m_batch_ps);
+		for (NRP<promise<int>> const& p : ps) {
+			p->set(netp::E_CHANNEL_WRITE_CLOSED);
+		}
+		ctx->fire_closed();
+	}
+
 	void hlen::read_closed(NRP<channel_handler_context> const& ctx) {
+		m_batching = false;
+		__batch_flush(ctx);
 		m_read_closed = true;
+		m_tmp = nullptr;
+		m_ring = nullptr;
+		ctx->ch->ch_mem_account_in(m_mem_charged, 0);
 		ctx->fire_read_closed();
 	}
 
+	//complete the pending len or frame in the ring with income, return false if income runs out first
+	bool hlen::__ring_fill(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
+		const u32_t want = (m_state == parse_state::S_READ_LEN) ? u32_t(sizeof(u32_t)) : m_size;
+		NETP_ASSERT(m_ring->count() < want);
+		const u32_t c = NETP_MIN(want - m_ring->count(), income->len());
+		m_ring->write(income->head(), c);
+		income->skip(c);
+		if (m_ring->count() < want) {
+			return false;
+		}
+		if (m_state == parse_state::S_READ_LEN) {
+			m_size = m_ring->read<u32_t>();
+			m_state = parse_state::S_READ_CONTENT;
+			return true;
+		}
+		//the frame is contiguous in the ring, one copy out
+		NRP<netp::packet> frame = netp::make_ref<netp::packet>(m_ring->head(), m_size);
+		m_ring->skip(m_size);
+		m_state = parse_state::S_READ_LEN;
+		ctx->fire_read(frame);
+		return true;
+	}
+
+	//the same as __ring_fill for m_tmp, the frame is copied out once it completes
+	bool hlen::__tmp_fill(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
+		const u32_t want = (m_state == parse_state::S_READ_LEN) ? u32_t(sizeof(u32_t)) : m_size;
+		NETP_ASSERT(m_tmp->len() < want);
+		const u32_t c = NETP_MIN(want - m_tmp->len(), income->len());
+		m_tmp->append(netp::make_ref<netp::packet>(income->head(), c));
+		income->skip(c);
+		if (m_tmp->len() < want) {
+			return false;
+		}
+		NRP<composite_packet> partial;
+		partial.swap(m_tmp);
+		if (m_state == parse_state::S_READ_LEN) {
+			m_size = partial->read<u32_t>();
+			m_state = parse_state::S_READ_CONTENT;
+			return true;
+		}
+		m_state = parse_state::S_READ_LEN;
+		ctx->fire_read(partial->flatten());
+		return true;
+	}
+
+	void hlen::__keep_partial(NRP<packet> const& income) {
+		NETP_ASSERT(m_tmp == nullptr);
+		if (m_ring_capacity != 0 && (m_state == parse_state::S_READ_LEN || m_size <= m_ring_capacity)) {
+			if (m_ring == nullptr) {
+				m_ring = netp::make_ref<netp::mirror_ringbuffer>();
+				const int rt = m_ring->init(m_ring_capacity);
+				if (rt != netp::OK) {
+					NETP_WARN("[hlen]mirror ringbuffer init failed: %d, fall back to packet", rt);
+					m_ring = nullptr;
+					m_ring_capacity = 0;
+				} else {
+					m_ring_capacity = m_ring->capacity();
+				}
+			}
+			if (m_ring != nullptr) {
+				NETP_ASSERT(m_ring->is_empty());
+				const u32_t c = m_ring->write(income->head(), income->len());
+				NETP_ASSERT(c == income->len());
+				(void)c;
+				return;
+			}
+		}
+		//income is the read buffer of the loop, copy it out
+		if (income->len() != 0) {
+			m_tmp = netp::make_ref<composite_packet>(netp::make_ref<netp::packet>(income->head(), income->len()));
+		}
+	}
+
 	void hlen::read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
 		NETP_ASSERT(income != nullptr);
 
+		m_batching = m_read_complete_seen;
 		NRP<packet> _income = income;
-		if (NETP_UNLIKELY(m_tmp != nullptr)) {
-			if (m_tmp->len() < _income->left_left_capacity()) {
-				_income->write_left(m_tmp->head(), m_tmp->len());
-			} else {
-				NRP<netp::packet> __income = netp::make_ref<netp::packet>(m_tmp->len() + income->len() );
-				__income->write(m_tmp->head(), m_tmp->len());
-				__income->write(income->head(), income->len());
-				_income = __income;
+		if (m_ring != nullptr && !m_ring->is_empty()) {
+			NETP_ASSERT(m_tmp == nullptr);
+			if (!__ring_fill(ctx, _income)) {
+				__mem_account(ctx, m_ring->count());
+				return;
+			}
+		} else if (NETP_UNLIKELY(m_tmp != nullptr)) {
+			if (!__tmp_fill(ctx, _income)) {
+				__mem_account(ctx, m_tmp->len());
+				return;
 			}
-			m_tmp = nullptr;
 		}
 
 		bool bExit = false;
@@ -34,8 +126,7 @@ namespace netp { namespace handler {
 			case parse_state::S_READ_LEN:
 			{
 				if (_income->len() < sizeof(u32_t)) {
-					NETP_ASSERT(m_tmp == nullptr);
-					m_tmp = netp::make_ref<netp::packet>(_income->head(), _income->len());
+					__keep_partial(_income);
 					bExit = true;
 					break;
 				}
@@ -46,24 +137,98 @@ namespace netp { namespace handler {
 			case parse_state::S_READ_CONTENT:
 			{
 				if (_income->len() >= m_size) {
-					NRP<netp::packet> __income_for_fire = netp::make_ref<netp::packet>(_income->head(), m_size);
+					//zero copy for a big frame or the last one, the frame shares the buffer of _income
+					NRP<netp::packet> __income_for_fire = (m_size >= NETP_HLEN_SLICE_MIN || m_size == _income->len()) ?
+						_income->retained_slice(0, m_size) :
+						netp::make_ref<netp::packet>(_income->head(), m_size);
 					_income->skip(m_size);
 					ctx->fire_read(__income_for_fire);
 					m_state = parse_state::S_READ_LEN;
 				} else {
-					NETP_ASSERT(m_tmp == nullptr);
-					m_tmp = netp::make_ref<netp::packet>(_income->head(), _income->len());
+					__keep_partial(_income);
 					bExit = true;
 				}
 			}
 			break;
 			}
 		}
+		__mem_account(ctx, m_tmp != nullptr ? m_tmp->len() : (m_ring != nullptr ? m_ring->count() : 0));
+	}
+
+	//a frame over the channel budget could never complete without it, give up on the channel
+	void hlen::__mem_account(NRP<channel_handler_context> const& ctx, u32_t now) {
+		const int rt = ctx->ch->ch_mem_account_in(m_mem_charged, now);
+		if (NETP_UNLIKELY(rt != netp::OK)) {
+			NETP_WARN("[hlen][%s]partial frame over the memory budget, frame size: %u, buffered: %u, close", ctx->ch->ch_info().c_str(), m_size, now);
+			ctx->ch->ch_errno() = rt;
+			ctx->close();
+		}
+	}
+
+	void hlen::read_complete(NRP<channel_handler_context> const& ctx) {
+		m_read_complete_seen = true;
+		//the handlers above write in their read_complete, still batched
+		ctx->fire_read_complete();
+		m_batching = false;
+		__batch_flush(ctx);
+	}
+
+	void hlen::__batch_flush(NRP<channel_handler_context> const& ctx) {
+		if (m_batch == nullptr) {
+			return;
+		}
+		NRP<packet> outlet;
+		outlet.swap(m_batch);
+		if (m_batch_ps.size() == 0) {
+			ctx->write_void(outlet);
+			return;
+		}
+		if (m_batch_ps.size() == 1) {
+			NRP<promise<int>> intp;
+			intp.swap(m_batch_ps[0]);
+			m_batch_ps.clear();
+			ctx->write(intp, outlet);
+			return;
+		}
+		NRP<promise<int>> intp = netp::make_ref<promise<int>>();
+		intp->if_done([ps = std::move(m_batch_ps)](int const& rt) {
+			for (NRP<promise<int>> const& p : ps) {
+				p->set(rt);
+			}
+		});
+		m_batch_ps = promise_vector_t();
+		ctx->write(intp, outlet);
 	}
 
 	void hlen::write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet) {
+		if (m_batching) {
+			if (m_batch == nullptr) {
+				m_batch = netp::make_ref<netp::packet>();
+			}
+			m_batch->write<u32_t>(outlet->len() & 0xFFFFFFFF);
+			m_batch->write(outlet->head(), outlet->len());
+			if (!intp->is_void()) {
+				m_batch_ps.push_back(intp);
+			}
+			if (m_batch->len() >= NETP_HLEN_BATCH_MAX) {
+				__batch_flush(ctx);
+			}
+			return;
+		}
 		NRP<netp::packet> lenoutlet = netp::make_ref<netp::packet>(outlet->head(), outlet->len());
 		lenoutlet->write_left<u32_t>(outlet->len() & 0xFFFFFFFF);
 		ctx->write(intp, lenoutlet);
 	}
-}}
\ No newline at end of file
+
+	void hlen::close(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx) {
+		m_batching = false;
+		__batch_flush(ctx);
+		ctx->close(intp);
+	}
+
+	void hlen::close_write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx) {
+		m_batching = false;
+		__batch_flush(ctx);
+		ctx->close_write(intp);
+	}
+}}
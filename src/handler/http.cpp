@@ -5,10 +5,11 @@
 
 namespace netp { namespace handler {
 
-		void http::__setup_parser(bool is_httpu) {
+		void http::__setup_parser(NRP<netp::channel_handler_context> const& ctx, bool is_httpu) {
 			NETP_ASSERT(m_http_parser == nullptr);
 			m_http_parser = netp::make_ref<netp::http::parser>();
 			m_http_parser->init(netp::http::HPT_BOTH);
+			m_http_parser->arena = ctx->arena();
 
 			if (NETP_UNLIKELY(is_httpu)) {
 				m_http_parser->on_headers_complete = std::bind(&http::http_on_headers_complete_from, NRP<http>(this), std::placeholders::_1, std::placeholders::_2);
@@ -24,9 +25,24 @@ namespace netp { namespace handler {
 			m_http_parser->on_chunk_complete = std::bind(&http::http_on_chunk_complete, NRP<http>(this), std::placeholders::_1);
 		}
 
+		//a message kept by the user outlives the request, even with an empty header it might allocate from the arena on any thread
+		//the arena is left to it then, the loop never touches that arena again
+		void http::__message_done(NRP<netp::http::parser> const& p) {
+			NRP<netp::http::message> const& m = p->message_tmp;
+			const bool held = (m != nullptr) && ((m.use_count() > 1) || (m->H != nullptr && m->H.use_count() > 1));
+			p->message_tmp = nullptr;
+			if (held) {
+				m_ctx_tmp->arena_release();
+			} else {
+				m_ctx_tmp->arena_reset();
+			}
+			p->arena = m_ctx_tmp->arena();
+		}
+
 		void http::__unsetup_parser() {
 			NETP_ASSERT(m_http_parser != nullptr);
 			m_http_parser->cb_reset();
+			m_http_parser->arena = nullptr;
 			m_http_parser = nullptr;
 		}
 
@@ -54,7 +70,7 @@ namespace netp { namespace handler {
 		}
 
 	void http::connected(NRP<netp::channel_handler_context> const& ctx) {
-		__setup_parser();
+		__setup_parser(ctx);
 		event_broker_any::invoke<fn_http_activity_t>(E_CONNECTED, ctx);
 	}
 
@@ -112,7 +128,7 @@ namespace netp { namespace handler {
 		*/
 
 		m_from_tmp = from->clone();
-		__setup_parser(true); 
+		__setup_parser(ctx, true); 
 		m_ctx_tmp = ctx;
 		NRP<netp::http::parser> parser = m_http_parser;
 		if (NETP_HTTP_IS_PARSE_ERROR(__http_parse(parser, income))) {
@@ -140,7 +156,9 @@ namespace netp { namespace handler {
 	int http::http_on_message_complete(NRP<netp::http::parser> const& p) {
 		NETP_ASSERT(m_ctx_tmp != nullptr);
 		event_broker_any::invoke<fn_http_message_end_t>(E_MESSAGE_END, m_ctx_tmp);
-		(void)p;
+
+		//the message is done, give its header back in one go
+		__message_done(p);
 		return netp::OK;
 	}
 
@@ -162,8 +180,8 @@ namespace netp { namespace handler {
 		//NETP_INFO("[http][recvfrom]invoke E_MESSAGE_FROM: \n%s", m_from_tmp.to_string().c_str() );
 
 		event_broker_any::invoke<fn_http_message_end_from_t>(E_MESSAGE_END_FROM, m_ctx_tmp, m_from_tmp );
-		(void)p;
 		m_message_tmp = nullptr;
+		__message_done(p);
 		return netp::OK;
 	}
 
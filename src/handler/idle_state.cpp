@@ -0,0 +1,245 @@
+#include <vector>
+
+#include <netp/tls.hpp>
+#include <netp/handler/idle_state.hpp>
+#include <netp/channel_handler_context.hpp>
+#include <netp/channel.hpp>
+
+namespace netp { namespace handler {
+
+	/*
+	 * @note
+	 * one per loop thread, published by tls_set<idle_state_wheel>, kept alive by its own repeating timer
+	 * the timer stops and the wheel goes away once the last channel has been dropped
+	 *
+	 * an entry is removed in place by idle_state::closed(), the closed handler graph is released at once
+	 * other entries are rechecked when their slot is swept:
+	 *	a) stale (migrated, re-watched): dropped
+	 *	b) deadline not reached (io happened in the meantime): reinserted at the new deadline
+	 *	c) due: idle event fired, reinserted at the next deadline
+	 *
+	 * a migrated entry is only dropped by the sweep of the old loop, it checks the loop binding of the channel, which is safe from any loop
+	 */
+	class idle_state_wheel final :
+		public netp::ref_base
+	{
+		struct entry {
+			NRP<idle_state> h;
+			NRP<channel_handler_context> ctx;
+			u32_t seq;
+		};
+		typedef std::vector<entry> slot_t;
+
+		io_event_loop* m_loop;
+		slot_t m_slots[NETP_IDLE_STATE_WHEEL_SLOTS];
+		slot_t m_due; //the slot being swept
+		u32_t m_due_slot;
+		u64_t m_tick; //last swept tick
+		netp::size_t m_count;
+
+		static __NETP_FORCE_INLINE u64_t _tick_of(timer_timepoint_t const& tp) {
+			return u64_t(tp.time_since_epoch() / std::chrono::milliseconds(NETP_IDLE_STATE_WHEEL_TICK_MS));
+		}
+
+		void _insert(entry&& e, timer_timepoint_t const& deadline) {
+			//round up, a slot is swept only if its tick has been fully passed
+			u64_t t = _tick_of(deadline) + 1;
+			if (t <= m_tick) { t = m_tick + 1; }
+			slot_t& slot = m_slots[t % NETP_IDLE_STATE_WHEEL_SLOTS];
+			e.h->m_wheel_slot = u32_t(t % NETP_IDLE_STATE_WHEEL_SLOTS);
+			e.h->m_wheel_pos = u32_t(slot.size());
+			slot.push_back(std::move(e));
+			++m_count;
+		}
+
+		static __NETP_FORCE_INLINE bool _is(slot_t const& slot, idle_state const* h) {
+			return h->m_wheel_pos < slot.size() && slot[h->m_wheel_pos].h.get() == h && slot[h->m_wheel_pos].seq == h->m_wheel_seq;
+		}
+
+		void _remove(idle_state const* h) {
+			if (h->m_wheel_slot >= NETP_IDLE_STATE_WHEEL_SLOTS) {
+				return;
+			}
+			slot_t& slot = m_slots[h->m_wheel_slot];
+			if (_is(slot, h)) {
+				slot[h->m_wheel_pos] = {};
+				--m_count;
+			} else if (h->m_wheel_slot == m_due_slot && _is(m_due, h)) {
+				//swept right now, m_count has been decreased already
+				m_due[h->m_wheel_pos] = {};
+			}
+		}
+
+		void _recheck(entry& e, timer_timepoint_t const& now) {
+			//the ctx may have been rebound by ch_migrate_to, the handler is not ours anymore
+			if (!e.ctx->ch->ch_loop_binding()->in_event_loop() || e.h->m_wheel_seq != e.seq) {
+				return;
+			}
+			const timer_timepoint_t deadline = e.h->_check(now);
+			if (deadline == _TIMER_TP_INFINITE || e.h->m_wheel_seq != e.seq) {
+				return;
+			}
+			_insert(std::move(e), deadline);
+		}
+
+		void _sweep(timer_timepoint_t const& now) {
+			const u64_t to = _tick_of(now);
+			if (to > m_tick + NETP_IDLE_STATE_WHEEL_SLOTS) {
+				//lagged more than one round, sweep every slot once
+				m_tick = to - NETP_IDLE_STATE_WHEEL_SLOTS;
+			}
+			while (m_tick < to) {
+				const u32_t idx = u32_t((++m_tick) % NETP_IDLE_STATE_WHEEL_SLOTS);
+				if (m_slots[idx].empty()) {
+					continue;
+				}
+				//user_event might close any channel of this slot, _remove looks into m_due then
+				NETP_ASSERT(m_due.empty());
+				std::swap(m_due, m_slots[idx]);
+				m_due_slot = idx;
+				//the ones removed by closed() have been taken off m_count already
+				for (entry const& e : m_due) {
+					if (e.h != nullptr) { --m_count; }
+				}
+				for (netp::size_t i = 0; i < m_due.size(); ++i) {
+					if (m_due[i].h != nullptr) {
+						_recheck(m_due[i], now);
+					}
+				}
+				m_due.clear();
+				m_due_slot = NETP_IDLE_STATE_WHEEL_SLOTS;
+			}
+		}
+
+		void _stop() {
+			for (slot_t& slot : m_slots) {
+				slot_t().swap(slot);
+			}
+			slot_t().swap(m_due);
+			m_count = 0;
+			idle_state_wheel*& w = tls_get<idle_state_wheel>();
+			if (w == this) {
+				w = nullptr;
+			}
+		}
+
+		void _tmcb_sweep(NRP<timer> const& t) {
+			NETP_ASSERT(m_loop->in_event_loop());
+			_sweep(m_loop->now());
+			if (m_count == 0 || m_loop->is_terminated()) {
+				_stop();
+				return;
+			}
+			m_loop->launch(t);
+		}
+
+	public:
+		idle_state_wheel(io_event_loop* L) :
+			m_loop(L),
+			m_due_slot(NETP_IDLE_STATE_WHEEL_SLOTS),
+			m_tick(_tick_of(L->now())),
+			m_count(0)
+		{}
+
+		static void watch(NRP<idle_state> const& h, NRP<channel_handler_context> const& ctx, timer_timepoint_t const& deadline) {
+			NETP_ASSERT(ctx->L->in_event_loop());
+			idle_state_wheel*& w = tls_get<idle_state_wheel>();
+			if (w == nullptr) {
+				NRP<idle_state_wheel> _w = netp::make_ref<idle_state_wheel>(ctx->L.get());
+				if (ctx->L->is_terminated()) {
+					NETP_WARN("[idle_state]launch wheel timer failed: %d", netp::E_IO_EVENT_LOOP_TERMINATED);
+					return;
+				}
+				ctx->L->launch(netp::make_ref<netp::timer>(std::chrono::milliseconds(NETP_IDLE_STATE_WHEEL_TICK_MS), &idle_state_wheel::_tmcb_sweep, _w, std::placeholders::_1));
+				w = _w.get();
+			}
+			NETP_ASSERT(w->m_loop == ctx->L.get());
+			w->_insert({ h, ctx, h->m_wheel_seq }, deadline);
+		}
+
+		static void unwatch(idle_state const* h) {
+			idle_state_wheel* w = tls_get<idle_state_wheel>();
+			if (w != nullptr) {
+				w->_remove(h);
+			}
+		}
+	};
+
+	//@note: _TIMER_TP_INFINITE is the smallest timepoint, never std::min against it
+	timer_timepoint_t idle_state::_next_deadline() const {
+		timer_timepoint_t deadline = _TIMER_TP_INFINITE;
+		if (m_read_idle.count() > 0) {
+			deadline = m_last_read + m_read_idle;
+		}
+		if (m_write_idle.count() > 0 && (deadline == _TIMER_TP_INFINITE || (m_last_write + m_write_idle) < deadline)) {
+			deadline = m_last_write + m_write_idle;
+		}
+		if (m_all_idle.count() > 0 && (deadline == _TIMER_TP_INFINITE || (m_last_all + m_all_idle) < deadline)) {
+			deadline = m_last_all + m_all_idle;
+		}
+		return deadline;
+	}
+
+	timer_timepoint_t idle_state::_check(timer_timepoint_t const& now) {
+		//user may close the channel in user_event
+		NRP<channel_handler_context> ctx = m_ctx;
+		if (m_read_idle.count() > 0 && m_ctx != nullptr && (now - m_last_read) >= m_read_idle) {
+			m_last_read = now;
+			ctx->fire_user_event(IDLE_STATE_READ_IDLE);
+		}
+		if (m_write_idle.count() > 0 && m_ctx != nullptr && (now - m_last_write) >= m_write_idle) {
+			m_last_write = now;
+			ctx->fire_user_event(IDLE_STATE_WRITE_IDLE);
+		}
+		if (m_all_idle.count() > 0 && m_ctx != nullptr && (now - m_last_all) >= m_all_idle) {
+			m_last_all = now;
+			ctx->fire_user_event(IDLE_STATE_ALL_IDLE);
+		}
+		return m_ctx == nullptr ? _TIMER_TP_INFINITE : _next_deadline();
+	}
+
+	void idle_state::_watch() {
+		NETP_ASSERT(m_ctx != nullptr);
+		++m_wheel_seq;
+		const timer_timepoint_t deadline = _next_deadline();
+		if (deadline == _TIMER_TP_INFINITE) {
+			return;
+		}
+		idle_state_wheel::watch(NRP<idle_state>(this), m_ctx, deadline);
+	}
+
+	void idle_state::connected(NRP<channel_handler_context> const& ctx) {
+		NETP_ASSERT(m_ctx == nullptr);
+		m_ctx = ctx;
+		m_last_read = m_last_write = m_last_all = ctx->L->now();
+		_watch();
+		ctx->fire_connected();
+	}
+
+	void idle_state::closed(NRP<channel_handler_context> const& ctx) {
+		idle_state_wheel::unwatch(this);
+		++m_wheel_seq;
+		m_wheel_slot = NETP_IDLE_STATE_WHEEL_SLOTS;
+		m_ctx = nullptr;
+		ctx->fire_closed();
+	}
+
+	void idle_state::loop_migrated(NRP<channel_handler_context> const& ctx, NRP<io_event_loop> const& from) {
+		//the entry in <from> is dropped by its own sweep
+		if (m_ctx != nullptr) {
+			_watch();
+		}
+		ctx->fire_loop_migrated(from);
+	}
+
+	void idle_state::read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
+		m_last_read = m_last_all = ctx->L->now();
+		ctx->fire_read(income);
+	}
+
+	//@note: stamped on write request, not on write done, to save a promise per write
+	void idle_state::write(NRP<promise<int>> const& intp, NRP<channel_handler_context> const& ctx, NRP<packet> const& outlet) {
+		m_last_write = m_last_all = ctx->L->now();
+		ctx->write(intp, outlet);
+	}
+}}
@@ -174,7 +174,6 @@ namespace netp { namespace handler {
 
 		NETP_ASSERT(m_outlets_to_tls_ch.size());
 		tls_ch_outlet& outlet = m_outlets_to_tls_ch.front();
-		NETP_ASSERT(outlet.write_p != nullptr);
 
 		if (--(outlet.record_count) > 0) {
 			return;
@@ -456,8 +455,8 @@ namespace netp { namespace handler {
 
 			socket_ch_outlet& outlet = m_outlets_to_socket_ch.front();
 			NRP<netp::promise<int>> f = netp::make_ref<netp::promise<int>>();
-			f->if_done([TLS_H = NRP<tls_handler>(this), L = m_ctx->L](int const& rt) {
-				NETP_ASSERT(L->in_event_loop());
+			f->if_done([TLS_H = NRP<tls_handler>(this), ctx = m_ctx](int const& rt) {
+				NETP_ASSERT(ctx->L->in_event_loop());
 				TLS_H->_socket_ch_flush_done(rt);
 			});
 			m_ctx->write(f,outlet.data);
@@ -50,10 +50,24 @@ namespace netp { namespace handler {
 			m_http_parser->cb_reset();
 			m_http_parser = nullptr;
 		}
-		(void)ctx;
+		ctx->ch->ch_mem_account_in(m_mem_charged, 0);
 	}
 
-	void websocket::read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income)
+	void websocket::read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income) {
+		_do_read(ctx, income);
+		if (ctx->ch->ch_flag() & int(channel_flag::F_CLOSED)) {
+			return;//given back in closed()
+		}
+		const u32_t now = u32_t(m_income_prev->len() + m_tmp_frame->appdata->len() + m_tmp_message->len());
+		if (NETP_UNLIKELY(ctx->ch->ch_mem_account_in(m_mem_charged, now) != netp::OK)) {
+			//a frame or message over the channel budget could never complete without it
+			NETP_WARN("[websocket][%s]partial message over the memory budget, buffered: %u, close", ctx->ch->ch_info().c_str(), now);
+			ctx->ch->ch_errno() = netp::E_CHANNEL_MEM_LIMIT;
+			ctx->close();
+		}
+	}
+
+	void websocket::_do_read(NRP<channel_handler_context> const& ctx, NRP<packet> const& income)
 	{
 		if (income->len() == 0) {
 			NETP_WARN("[websocket][#%u]empty message, return", ctx->ch->ch_id() );
@@ -112,7 +126,7 @@ _CHECK:
 					NETP_WARN("[websocket]missing %s, or not websocket, force close", _H_Upgrade);
 					NRP<packet> out = netp::make_ref<packet>();
 					out->write((byte_t*)WEBSOCKET_UPGRADE_REPLY_400, u32_t(netp::strlen(WEBSOCKET_UPGRADE_REPLY_400)));
-					ctx->write(out);
+					ctx->write_void(out);
 					ctx->close();
 					return ;
 				}
@@ -121,7 +135,7 @@ _CHECK:
 					NETP_WARN("[websocket]missing %s, or not Upgrade, force close", _H_Connection);
 					NRP<packet> out = netp::make_ref<packet>();
 					out->write((byte_t*)WEBSOCKET_UPGRADE_REPLY_400, u32_t(netp::strlen(WEBSOCKET_UPGRADE_REPLY_400)));
-					ctx->write(out);
+					ctx->write_void(out);
 					ctx->close();
 					return;
 				}
@@ -130,7 +144,7 @@ _CHECK:
 					NETP_WARN("[websocket]missing Sec-WebSocket-Key, force close");
 					NRP<packet> out = netp::make_ref<packet>();
 					out->write((byte_t*) WEBSOCKET_UPGRADE_REPLY_400, u32_t(netp::strlen(WEBSOCKET_UPGRADE_REPLY_400)) );
-					ctx->write(out);
+					ctx->write_void(out);
 					ctx->close();
 					return;
 				}
@@ -139,7 +153,7 @@ _CHECK:
 					NETP_WARN("[websocket]missing Sec-WebSocket-Version, force close");
 					NRP<packet> out = netp::make_ref<packet>();
 					out->write((byte_t*)WEBSOCKET_UPGRADE_REPLY_400, u32_t(netp::strlen(WEBSOCKET_UPGRADE_REPLY_400)));
-					ctx->write(out);
+					ctx->write_void(out);
 					ctx->close();
 					return;
 				}
@@ -168,7 +182,7 @@ _CHECK:
 				NRP<packet> outp;
 				reply->encode(outp);
 				NETP_INFO("reply H: \n%s", string_t((char*)outp->head(), outp->len()).c_str());
-				ctx->write(outp);
+				ctx->write_void(outp);
 				m_state = state::S_MESSAGE_BEGIN;
 				ctx->fire_connected();
 				goto _CHECK;
@@ -327,7 +341,7 @@ _CHECK:
 						outp_PONG->write(m_tmp_frame->appdata->head(), m_tmp_frame->appdata->len());
 						m_tmp_frame->appdata->reset();
 
-						ctx->write(outp_PONG);
+						ctx->write_void(outp_PONG);
 						m_state = state::S_FRAME_BEGIN;
 						goto _CHECK;
 					}
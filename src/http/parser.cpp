@@ -48,7 +48,7 @@ namespace netp { namespace http {
 		parser* p = (parser*)p_->data;
 		NETP_ASSERT(p != nullptr);
 		p->message_tmp = netp::make_ref<netp::http::message>();
-		p->message_tmp->H = netp::make_ref<netp::http::header>();
+		p->message_tmp->H = netp::make_ref<netp::http::header>(p->arena);
 		return 0;
 	}
 
@@ -101,8 +101,11 @@ namespace netp {
 					else {
 						m_tq.clear();
 					}
+					//restart the spin budget
+					m_busy_polling = false;
 				}
 				//@_calc_wait_dur_in_nano must happen before poll..
+				//the poller refreshes m_clock on its return from wait, before the dispatch
 				m_poller->poll(_calc_wait_dur_in_nano(), m_waiting);
 			}
 		}
@@ -130,6 +133,15 @@ namespace netp {
 		deinit();
 	}
 
+	void io_event_loop::__tmcb_mem_decay(NRP<timer> const& t) {
+		NETP_ASSERT(in_event_loop());
+		//the global pool is decayed by whichever loop comes first in an interval
+		netp::allocator_decay(m_cfg.mem_decay_interval);
+		if (m_state.load(std::memory_order_acquire) < u8_t(loop_state::S_TERMINATED)) {
+			m_tb->launch(t, m_clock.steady);
+		}
+	}
+
 	void io_event_loop::__do_notify_terminating() {
 		NETP_ASSERT( in_event_loop() );
 		io_do(io_action::NOTIFY_TERMINATING, 0);
@@ -209,7 +221,7 @@ namespace netp {
 		}
 
 		void io_event_loop_group::launch_loop(io_poller_type t, int count, event_loop_cfg const& cfg, fn_event_loop_maker_t const& fn_maker ) {
-			NETP_VERBOSE("[io_event_loop_group]alloc poller: %u, count: %u, ch_buf_size: %u", t, count, cfg.ch_buf_size );
+			NETP_VERBOSE("[io_event_loop_group]alloc poller: %u, count: %u, ch_buf_size: %u, busy_poll_budget: %u, sock_busy_poll: %u", t, count, cfg.ch_buf_size, cfg.busy_poll_budget, cfg.sock_busy_poll );
 			lock_guard<shared_mutex> lg(m_loop_mtx[t]);
 			m_curr_loop_idx[t] = 0;
 			while (count-- > 0) {
@@ -237,7 +249,7 @@ namespace netp {
 				bye_event_loop_state idle = bye_event_loop_state::S_IDLE;
 				if (m_bye_state.compare_exchange_strong(idle, bye_event_loop_state::S_PREPARING, std::memory_order_acq_rel, std::memory_order_acquire)) {
 					NETP_ASSERT(m_bye_event_loop == nullptr, "m_bye_event_loop check failed");
-					m_bye_event_loop = default_event_loop_maker(NETP_DEFAULT_POLLER_TYPE, { 0 });
+					m_bye_event_loop = default_event_loop_maker(NETP_DEFAULT_POLLER_TYPE, { 0,0,0,0 });
 					int rt = m_bye_event_loop->__launch();
 					NETP_ASSERT(rt == netp::OK);
 					m_bye_ref_count = m_bye_event_loop.ref_count();
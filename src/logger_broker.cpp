@@ -14,6 +14,7 @@
 #endif
 
 #include <netp/thread.hpp>
+#include <netp/timer.hpp>
 
 namespace netp {
 
@@ -73,15 +74,27 @@ namespace netp {
 		(void)line;
 		NETP_ASSERT(m_isInited);
 		const netp::u64_t tid = netp::this_thread::get_id();
+
+		//use the cached wall clock of the loop if we're in a loop thread
+		struct timeval tv;
+		clock_snapshot* const cs = tls_get<clock_snapshot>();
+		if (cs != nullptr) {
+			const i64_t us = i64_t(cs->wall.time_since_epoch().count());
+			tv.tv_sec = long(us / 1000000);
+			tv.tv_usec = long(us % 1000000);
+		} else {
+			time_of_day(tv, nullptr);
+		}
+		const std::string datatime_str = netp::to_local_datatime_str(tv);
+
 		const ::size_t lc = m_loggers.size();
 		for(::size_t i=0;i<lc;++i) {
 			if (!m_loggers[i]->test_mask(mask)) { continue; }
 			NETP_ASSERT(m_loggers[i] != nullptr);
 
 			char log_buffer[LOG_BUFFER_SIZE_MAX] = { 0 };
-			netp::curr_local_datatime_str();
 			int idx_tid = 0;
-			int snwrite = snprintf(log_buffer + idx_tid, LOG_BUFFER_SIZE_MAX - idx_tid, "[%s][%c][%llu]", netp::curr_local_datatime_str().c_str(), logger::__log_mask_char[mask], tid);
+			int snwrite = snprintf(log_buffer + idx_tid, LOG_BUFFER_SIZE_MAX - idx_tid, "[%s][%c][%llu]", datatime_str.c_str(), logger::__log_mask_char[mask], tid);
 			if (snwrite == -1) {
 				NETP_THROW("snprintf failed for loggerManager::write");
 			}
@@ -1,5 +1,20 @@
+#include <cstdio>
+#include <chrono>
 #include <netp/memory.hpp>
 
+#if defined(__GLIBC__)
+	#include <malloc.h>
+#endif
+
+#if defined(NETP_MEMORY_USE_SLAB) && !defined(_NETP_WIN)
+	#include <sys/mman.h>
+#endif
+
+#ifdef _NETP_GNU_LINUX
+	#include <unistd.h>
+	#include <sys/syscall.h>
+#endif
+
 namespace netp {
 
 //ALIGN_SIZE SHOUDL BE LESS THAN 256bit
@@ -14,7 +29,7 @@ namespace netp {
 				u8_t size_H;
 				u8_t t : 4;
 				u8_t s : 4;
-				u8_t alignment;
+				u8_t node; //numa node of the thread that malloc the item
 				u8_t offset;
 			} AH_4_7;
 		} hdr;
@@ -28,8 +43,7 @@ namespace netp {
 		//@note: pls refer to https://en.wikipedia.org/wiki/Data_structure_alignment 
 		const u8_t offset = u8_t(sizeof(aligned_hdr)) + ((alignment == alignof(std::max_align_t)) ? 0 : u8_t((~(std::size_t(a_hdr) + sizeof(aligned_hdr) - 1)) & ((alignment)-1)));
 		NETP_ASSERT(alignment<=32 && offset <= 32 && offset>=sizeof(aligned_hdr));
-		
-		a_hdr->hdr.AH_4_7.alignment = u8_t(alignment);
+
 		a_hdr->hdr.AH_4_7.offset = (offset);
 		/*in case if the offset is not sizeof(aligned_hdr), no cmp, just set */
 		*(reinterpret_cast<u8_t*>(a_hdr) + (offset) - 1) = (offset);
@@ -240,27 +254,409 @@ namespace netp {
 	} \
 }while(false);\
 
+#ifdef NETP_MEMORY_ENABLE_STAT
+	#define __NETP_MEM_STAT_ADD(c,n) ((c).store((c).load(std::memory_order_relaxed) + (n), std::memory_order_relaxed))
+	#define __NETP_MEM_STAT_SET(c,n) ((c).store((n), std::memory_order_relaxed))
+	#define __NETP_MEM_SLOT_STAT_ADD(t,s,field,n) __NETP_MEM_STAT_ADD(m_stats[t][s].field,n)
+	#define __NETP_MEM_SLOT_STAT_CACHED(t,s,tst) __NETP_MEM_STAT_SET(m_stats[t][s].cached,(tst)->count)
+#else
+	#define __NETP_MEM_STAT_ADD(c,n) ((void)0)
+	#define __NETP_MEM_STAT_SET(c,n) ((void)0)
+	#define __NETP_MEM_SLOT_STAT_ADD(t,s,field,n) ((void)0)
+	#define __NETP_MEM_SLOT_STAT_CACHED(t,s,tst) ((void)0)
+#endif
+
+#ifdef NETP_MEMORY_USE_SLAB
+	//@note: a slab chunk is dedicated to one TABLE/slot, [slab_chunk][item][item]...
+	//the items are carved lazily by bump, so a new chunk does not touch all of its pages at once
+	//tables beyond the edge (>16K) std::malloc-ed as usual
+	#define NETP_SLAB_CHUNK_SIZE (2*1024*1024)
+	#define NETP_SLAB_TABLE_EDGE T7
+
+	struct slab_chunk {
+		slab_chunk* prev;
+		slab_chunk* next;
+		u8_t* free_list;
+		u8_t* bump;
+		u8_t* end;
+		u32_t stride;
+		u32_t used;
+		u8_t t;
+		u8_t s;
+		bool huge;
+	};
+	#define NETP_SLAB_CHUNK_HDR_SIZE ((sizeof(slab_chunk) + 63) & ~size_t(63))
+
+	struct slab_class {
+		spin_mutex mtx;
+		slab_chunk* partial; //chunks that have free item
+		slab_chunk* spare; //keep one empty chunk to avoid map/unmap thrash
+	};
+
+	class slab_pool {
+		slab_class m_classes[NETP_SLAB_TABLE_EDGE][NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT];
+		std::atomic<u32_t> m_chunk_count;
+		std::atomic<u32_t> m_huge_chunk_count;
+		std::atomic<bool> m_hugetlb_failed;
+
+		slab_chunk* __chunk_map() {
+			bool huge = false;
+			void* p = 0;
+#if defined(_NETP_WIN)
+			p = ::_aligned_malloc(NETP_SLAB_CHUNK_SIZE, NETP_SLAB_CHUNK_SIZE);
+#elif defined(MAP_ANONYMOUS)
+	#ifdef MAP_HUGETLB
+			//hugetlb mapping is aligned to the huge page size, most of the hosts have no reserved huge page, try it until the first failure
+			if (!m_hugetlb_failed.load(std::memory_order_relaxed)) {
+				p = ::mmap(0, NETP_SLAB_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if (p == MAP_FAILED) {
+					p = 0;
+					m_hugetlb_failed.store(true, std::memory_order_relaxed);
+				} else {
+					huge = true;
+				}
+			}
+	#endif
+			if (p == 0) {
+				u8_t* raw = (u8_t*)::mmap(0, NETP_SLAB_CHUNK_SIZE << 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if ((void*)raw == MAP_FAILED) {
+					return 0;
+				}
+				u8_t* aligned = (u8_t*)((std::size_t(raw) + (NETP_SLAB_CHUNK_SIZE - 1)) & ~std::size_t(NETP_SLAB_CHUNK_SIZE - 1));
+				if (aligned != raw) {
+					::munmap(raw, aligned - raw);
+				}
+				const size_t tail = (raw + (NETP_SLAB_CHUNK_SIZE << 1)) - (aligned + NETP_SLAB_CHUNK_SIZE);
+				if (tail != 0) {
+					::munmap(aligned + NETP_SLAB_CHUNK_SIZE, tail);
+				}
+	#ifdef MADV_HUGEPAGE
+				::madvise(aligned, NETP_SLAB_CHUNK_SIZE, MADV_HUGEPAGE);
+	#endif
+				p = aligned;
+			}
+#else
+			if (::posix_memalign(&p, NETP_SLAB_CHUNK_SIZE, NETP_SLAB_CHUNK_SIZE) != 0) {
+				p = 0;
+			}
+#endif
+			if (p == 0) {
+				return 0;
+			}
+			NETP_ASSERT((std::size_t(p) & (NETP_SLAB_CHUNK_SIZE - 1)) == 0);
+			slab_chunk* c = (slab_chunk*)p;
+			c->huge = huge;
+			m_chunk_count.fetch_add(1, std::memory_order_relaxed);
+			huge ? (void)m_huge_chunk_count.fetch_add(1, std::memory_order_relaxed) : (void)0;
+			return c;
+		}
+
+		void __chunk_unmap(slab_chunk* c) {
+			m_chunk_count.fetch_sub(1, std::memory_order_relaxed);
+			c->huge ? (void)m_huge_chunk_count.fetch_sub(1, std::memory_order_relaxed) : (void)0;
+#if defined(_NETP_WIN)
+			::_aligned_free(c);
+#elif defined(MAP_ANONYMOUS)
+			::munmap(c, NETP_SLAB_CHUNK_SIZE);
+#else
+			::free(c);
+#endif
+		}
+
+		__NETP_FORCE_INLINE static void __chunk_reset(slab_chunk* c, u8_t t, u8_t s, u32_t stride) {
+			c->prev = 0;
+			c->next = 0;
+			c->free_list = 0;
+			c->bump = (u8_t*)c + NETP_SLAB_CHUNK_HDR_SIZE;
+			c->end = (u8_t*)c + NETP_SLAB_CHUNK_SIZE;
+			c->stride = stride;
+			c->used = 0;
+			c->t = t;
+			c->s = s;
+		}
+
+		__NETP_FORCE_INLINE static bool __chunk_full(slab_chunk* c) {
+			return (c->free_list == 0) && ((c->bump + c->stride) > c->end);
+		}
+
+		__NETP_FORCE_INLINE static void __partial_unlink(slab_class& cls, slab_chunk* c) {
+			(c->prev != 0) ? (c->prev->next = c->next) : (cls.partial = c->next);
+			(c->next != 0) ? (c->next->prev = c->prev) : 0;
+			c->prev = 0;
+			c->next = 0;
+		}
+
+		__NETP_FORCE_INLINE static void __partial_link(slab_class& cls, slab_chunk* c) {
+			c->prev = 0;
+			c->next = cls.partial;
+			(cls.partial != 0) ? (cls.partial->prev = c) : 0;
+			cls.partial = c;
+		}
+
+	public:
+		slab_pool() :
+			m_chunk_count(0),
+			m_huge_chunk_count(0),
+			m_hugetlb_failed(false)
+		{
+			for (u8_t t = 0; t < NETP_SLAB_TABLE_EDGE; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT; ++s) {
+					m_classes[t][s].partial = 0;
+					m_classes[t][s].spare = 0;
+				}
+			}
+		}
+
+		//return the start of a item that has at least sizeof(aligned_hdr) + slot_size bytes, aligned to 16 like std::malloc does
+		u8_t* malloc(u8_t t, u8_t s, size_t slot_size) {
+			NETP_ASSERT(t < NETP_SLAB_TABLE_EDGE);
+			const u32_t stride = u32_t((sizeof(aligned_hdr) + slot_size + 15) & ~size_t(15));
+			slab_class& cls = m_classes[t][s];
+			lock_guard<spin_mutex> lg(cls.mtx);
+			slab_chunk* c = cls.partial;
+			if (c == 0) {
+				if (cls.spare != 0) {
+					c = cls.spare;
+					cls.spare = 0;
+				} else {
+					c = __chunk_map();
+					if (c == 0) {
+						return 0;
+					}
+				}
+				__chunk_reset(c, t, s, stride);
+				__partial_link(cls, c);
+			}
+			NETP_ASSERT(c->stride == stride);
+			u8_t* item;
+			if (c->free_list != 0) {
+				item = c->free_list;
+				c->free_list = *(u8_t**)item;
+			} else {
+				item = c->bump;
+				c->bump += stride;
+			}
+			++c->used;
+			if (__chunk_full(c)) {
+				__partial_unlink(cls, c);
+			}
+			return item;
+		}
+
+		void free(u8_t* item) {
+			slab_chunk* c = (slab_chunk*)(std::size_t(item) & ~std::size_t(NETP_SLAB_CHUNK_SIZE - 1));
+			slab_class& cls = m_classes[c->t][c->s];
+			lock_guard<spin_mutex> lg(cls.mtx);
+			NETP_ASSERT(c->used > 0);
+			const bool was_full = __chunk_full(c);
+			*(u8_t**)item = c->free_list;
+			c->free_list = item;
+			--c->used;
+			if (was_full) {
+				__partial_link(cls, c);
+			}
+			if (c->used == 0) {
+				__partial_unlink(cls, c);
+				if (cls.spare == 0) {
+					cls.spare = c;
+				} else {
+					__chunk_unmap(c);
+				}
+			}
+		}
+
+		void trim() {
+			for (u8_t t = 0; t < NETP_SLAB_TABLE_EDGE; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT; ++s) {
+					slab_class& cls = m_classes[t][s];
+					lock_guard<spin_mutex> lg(cls.mtx);
+					if (cls.spare != 0) {
+						__chunk_unmap(cls.spare);
+						cls.spare = 0;
+					}
+				}
+			}
+		}
+
+		inline u32_t chunk_count() const { return m_chunk_count.load(std::memory_order_relaxed); }
+		inline u32_t huge_chunk_count() const { return m_huge_chunk_count.load(std::memory_order_relaxed); }
+	};
+
+	//never destructed, items might be freed by static destructors
+	static slab_pool* __slab_pool() {
+		static slab_pool* _pool = ::new slab_pool();
+		return _pool;
+	}
+#endif
+
+	//the backend of the pooled items
+	__NETP_FORCE_INLINE static aligned_hdr* __item_malloc(u8_t t, u8_t s, size_t slot_size) {
+#ifdef NETP_MEMORY_USE_SLAB
+		if (t < NETP_SLAB_TABLE_EDGE) {
+			return (aligned_hdr*)__slab_pool()->malloc(t, s, slot_size);
+		}
+#else
+		(void)s;
+#endif
+		(void)t;
+		return (aligned_hdr*)std::malloc(sizeof(aligned_hdr) + slot_size);
+	}
+
+	__NETP_FORCE_INLINE static void __item_free(void* item) {
+#ifdef NETP_MEMORY_USE_SLAB
+		if (((aligned_hdr*)item)->hdr.AH_4_7.t < NETP_SLAB_TABLE_EDGE) {
+			__slab_pool()->free((u8_t*)item);
+			return;
+		}
+#endif
+		std::free(item);
+	}
+
+	//items of a batch, at most half of a tls slot
+	#define NETP_TRANSFER_BATCH_ITEMS(t) (NETP_MIN(u32_t(NETP_TRANSFER_BATCH_MAX), (TABLE_SLOT_ENTRIES_INIT_LIMIT[t]>>1)))
+	//batches in the global pool per thread
+	#define NETP_TRANSFER_BATCHES_PER_THREAD(t) (TABLE_SLOT_ENTRIES_INIT_LIMIT[t]/NETP_TRANSFER_BATCH_ITEMS(t))
+
+	//items of one TABLE/slot freed by this thread that belong to another node
+	struct remote_slot_t {
+		u32_t count;
+		u8_t* items[NETP_TRANSFER_BATCH_MAX];
+	};
+
+	//the possible nodes, i.e: "0-1", from sysfs
+	static u32_t __numa_node_count_probe() {
+		u32_t count = 1;
+#ifdef _NETP_GNU_LINUX
+		std::FILE* fp = std::fopen("/sys/devices/system/node/possible", "r");
+		if (fp == nullptr) {
+			return count;
+		}
+		char buf[64] = { 0 };
+		if (std::fgets(buf, sizeof(buf), fp) != nullptr) {
+			const char* last = buf;
+			for (const char* c = buf; *c != 0; ++c) {
+				if (*c == '-' || *c == ',') { last = c + 1; }
+			}
+			count = u32_t(std::atoi(last)) + 1;
+		}
+		std::fclose(fp);
+#endif
+		return NETP_MIN(NETP_MAX(count, u32_t(1)), u32_t(NETP_MEMORY_NUMA_NODE_MAX));
+	}
+
+	u32_t allocator_numa_node_count() {
+		static const u32_t _count = __numa_node_count_probe();
+		return _count;
+	}
+
+	//the node of the cpu the calling thread is running on
+	static u8_t __numa_node_current() {
+		const u32_t count = allocator_numa_node_count();
+		if (count == 1) {
+			return 0;
+		}
+#ifdef _NETP_GNU_LINUX
+		unsigned cpu = 0;
+		unsigned node = 0;
+		if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+			return u8_t(node % count);
+		}
+#endif
+		return 0;
+	}
+
+	//0 means no limit
+	static std::atomic<size_t> s_tls_cached_bytes_max(0);
+	static std::atomic<size_t> s_global_cached_bytes_max(0);
+	static std::atomic<bool> s_preallocate_eager(false);
+
+	bool allocator_preallocate_eager() {
+		return s_preallocate_eager.load(std::memory_order_relaxed);
+	}
+
+	//the bottom of the slot is the coldest part, release from there, return the count released
+	__NETP_FORCE_INLINE static u32_t __table_slot_release_bottom(table_slot_t* tst, u32_t n) {
+		NETP_ASSERT(n <= tst->count);
+		for (u32_t i = 0; i < n; ++i) {
+			__item_free((void*)(tst->ptr[i]));
+		}
+		tst->count -= n;
+		if (tst->count) {
+			std::memmove(tst->ptr, tst->ptr + n, sizeof(u8_t*) * tst->count);
+		}
+		tst->low = tst->count;
+		return n;
+	}
+
+	//fill the slot up to item_count with new items, they go to the slot directly, no alloc/free traffic
 	void pool_aligned_allocator::preallocate_table_slot_item(table_slot_t* tst, u8_t t, u8_t slot, size_t item_count) {
-		(void)tst;
-		u8_t** ptr = (u8_t**)std::malloc(sizeof(u8_t*) * (item_count));
-		size_t size = calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), slot);
-		size_t i;
-		for (i = 0; i < (item_count); ++i) {
-			ptr[i] = (u8_t*) pool_aligned_allocator::malloc((size), NETP_DEFAULT_ALIGN);
+		NETP_ASSERT(item_count <= tst->max);
+		const size_t size = calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), slot);
+		const u32_t count = tst->count;
+		while (tst->count < item_count) {
+			aligned_hdr* a_hdr = __item_malloc(t, slot, size);
+			if (NETP_UNLIKELY(a_hdr == 0)) {
+				break;
+			}
+			a_hdr->hdr.AH_4_7.t = t;
+			a_hdr->hdr.AH_4_7.s = slot;
+			a_hdr->hdr.AH_4_7.node = m_node;
+			tst->ptr[tst->count++] = (u8_t*)a_hdr;
+		}
+		m_cached_bytes += (tst->count - count) * size;
+		__NETP_MEM_SLOT_STAT_CACHED(t, slot, tst);
+	}
+
+	//@note: a slot is warmed only when it misses, a class that never sees traffic costs nothing
+	//the count to warm doubles on every miss up to half of the slot, decay halves it back
+	void pool_aligned_allocator::__table_slot_warm(table_slot_t* tst, u8_t t, u8_t s, size_t slot_size) {
+		NETP_ASSERT(tst->count == 0);
+		u32_t n = tst->warm;
+		tst->warm = (n == 0) ? 1 : NETP_MIN((n << 1), (tst->max >> 1));
+		const size_t tls_max = s_tls_cached_bytes_max.load(std::memory_order_relaxed);
+		if (tls_max != 0) {
+			const size_t room = (tls_max > m_cached_bytes) ? ((tls_max - m_cached_bytes) / slot_size) : 0;
+			(n > room) ? (n = u32_t(room)) : 0;
 		}
-		for (size_t j = 0; j < i; ++j) {
-			pool_aligned_allocator::free(ptr[j]);
+		if (n) {
+			preallocate_table_slot_item(tst, t, s, n);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, warmed, tst->count);
+		}
+	}
+
+	void pool_aligned_allocator::preallocate() {
+		for (u8_t t = 0; t < NETP_ALIGNED_ALLOCATOR_16_SLOT_EDGE_T /*<1k*/; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				table_slot_t* tst = m_tables[t][s];
+				preallocate_table_slot_item(tst, t, s, (tst->max >> 1));
+				tst->low = tst->count;
+				tst->warm = (tst->max >> 1);
+			}
 		}
-		std::free(ptr);
 	}
 
 	void pool_aligned_allocator::deallocate_table_slot_item(table_slot_t* tst) {
 		while (tst->count) {//stop at 0
-			std::free( (void*)(tst->ptr[--tst->count]) );
+			__item_free( (void*)(tst->ptr[--tst->count]) );
 		}
 	}
 
 	void pool_aligned_allocator::init( bool preallocate ) {
+		m_cached_bytes = 0;
+		m_node = __numa_node_current();
+		const u32_t node_count = allocator_numa_node_count();
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			m_remote[t] = (node_count == 1) ? nullptr : (remote_slot_t**)std::calloc(NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t) * node_count, sizeof(remote_slot_t*));
+		}
+#ifdef NETP_MEMORY_ENABLE_STAT
+		static_assert(NETP_ALIGNED_ALLOCATOR_SLOT_MAX(0) <= NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT, "check slot limit failed");
+		m_large_alloc = 0;
+		m_large_free = 0;
+		m_stat_attached = false;
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			m_stats[t] = ::new table_slot_stat_t[NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t)]();
+		}
+#endif
 		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
 			const u8_t slot_max = NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t);
 			m_tables[t] = (table_slot_t**) std::malloc(sizeof(table_slot_t**) * slot_max);
@@ -269,16 +665,26 @@ namespace netp {
 				m_tables[t][s] = (table_slot_t*)__ptr;
 				m_tables[t][s]->max = TABLE_SLOT_ENTRIES_INIT_LIMIT[t];
 				m_tables[t][s]->count = 0;
+				m_tables[t][s]->low = 0;
+				m_tables[t][s]->warm = 0;
 				m_tables[t][s]->ptr = (u8_t**)(__ptr + (sizeof(table_slot_t)));
-
-				if (preallocate && (t< NETP_ALIGNED_ALLOCATOR_16_SLOT_EDGE_T /*<1k*/) ) {
-					preallocate_table_slot_item(m_tables[t][s], t, s, (TABLE_SLOT_ENTRIES_INIT_LIMIT[t]>>1) );
-				}
 			}
 		}
+		if (preallocate) {
+			pool_aligned_allocator::preallocate();
+		}
 	}
 
 	void pool_aligned_allocator::deinit() {
+		__flush_remote();
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			if (m_remote[t] != nullptr) {
+				for (u32_t i = 0; i < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t) * allocator_numa_node_count(); ++i) {
+					std::free(m_remote[t][i]);
+				}
+				std::free(m_remote[t]);
+			}
+		}
 		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
 			const u8_t slot_max = NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t);
 			for (u8_t s = 0; s < slot_max; ++s) {
@@ -288,6 +694,15 @@ namespace netp {
 			}
 			std::free(m_tables[t]);
 		}
+#ifdef NETP_MEMORY_ENABLE_STAT
+		//the remote flush and the release above are counted, fold them all
+		if (m_stat_attached) {
+			global_pool_aligned_allocator::instance()->stat_detach(this);
+		}
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			::delete[] m_stats[t];
+		}
+#endif
 	}
 
 	pool_aligned_allocator::pool_aligned_allocator( bool preallocate ) {
@@ -329,24 +744,35 @@ __fast_path:
 				NETP_ASSERT(tst->ptr[tst->count-1] != 0);
 	#endif
 				 a_hdr = (aligned_hdr*) (tst->ptr[--tst->count]);
+				 (tst->count < tst->low) ? (tst->low = tst->count) : 0;
+				 m_cached_bytes -= calc_SIZE_by_TABLE_SLOT(t, f, s);
+				 __NETP_MEM_SLOT_STAT_ADD(t, s, alloc_hit, 1);
+				 __NETP_MEM_SLOT_STAT_CACHED(t, s, tst);
 
 				 //update new size
 				 __AH_UPDATE_SIZE(a_hdr, size);
 				 return (u8_t*)a_hdr + __AH_UPDATE_OFFSET__(a_hdr, alignment);
 			}
 			//borrow
-			size_t c = global_pool_aligned_allocator::instance()->borrow(t, s, tst);
+			size_t c = global_pool_aligned_allocator::instance()->borrow(m_node, t, s, tst);
 			NETP_ASSERT(c == tst->count);
+			m_cached_bytes += c * calc_SIZE_by_TABLE_SLOT(t, f, s);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, borrow, 1);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, borrow_items, c);
 			if (c != 0) {
 				goto __fast_path;	
 			}
 
 			//update size for new malloc
 			slot_size = calc_SIZE_by_TABLE_SLOT(t,f,s);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, alloc_miss, 1);
+			__table_slot_warm(tst, t, s, slot_size);
+		} else {
+			__NETP_MEM_STAT_ADD(m_large_alloc, 1);
 		}
 
 		//std::malloc alwasy return ptr aligned to alignof(std::max_align_t), so ,we do not need to worry about the hdr access
-		a_hdr = (aligned_hdr*)std::malloc(sizeof(aligned_hdr)+ slot_size );
+		a_hdr = __item_malloc(t, s, slot_size);
 		NETP_ASSERT(std::size_t(a_hdr) % alignof(std::max_align_t) == 0);
 
 		if (NETP_UNLIKELY(a_hdr == 0)) {
@@ -356,6 +782,7 @@ __fast_path:
 		__AH_UPDATE_SIZE(a_hdr, size);
 		a_hdr->hdr.AH_4_7.t = t;
 		a_hdr->hdr.AH_4_7.s = s;
+		a_hdr->hdr.AH_4_7.node = m_node;
 		return (u8_t*)a_hdr + __AH_UPDATE_OFFSET__(a_hdr, alignment);
 	}
 
@@ -369,19 +796,74 @@ __fast_path:
 
 		if (NETP_LIKELY(t < T_COUNT)) {
 			u8_t s = a_hdr->hdr.AH_4_7.s;
+			if (NETP_UNLIKELY(a_hdr->hdr.AH_4_7.node != m_node)) {
+				__free_remote((u8_t*)a_hdr, t, s, a_hdr->hdr.AH_4_7.node);
+				return;
+			}
 
 			table_slot_t*& tst = (m_tables[t][s]);
-			if ((tst->count < tst->max)) {
+			const size_t item_size = calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s);
+			const size_t tls_max = s_tls_cached_bytes_max.load(std::memory_order_relaxed);
+			if ((tst->count < tst->max) && ((tls_max == 0) || ((m_cached_bytes + item_size) <= tls_max)) ) {
 				tst->ptr[tst->count++] = (u8_t*)a_hdr;
+				m_cached_bytes += item_size;
+				__NETP_MEM_SLOT_STAT_ADD(t, s, free_cached, 1);
 				if (tst->count == tst->max) {
-					global_pool_aligned_allocator::instance()->commit(t, s, tst);
+					const u32_t c = global_pool_aligned_allocator::instance()->commit(m_node, t, s, tst);
+					(tst->count < tst->low) ? (tst->low = tst->count) : 0;
+					m_cached_bytes -= c * item_size;
+					__NETP_MEM_SLOT_STAT_ADD(t, s, commit, 1);
+					__NETP_MEM_SLOT_STAT_ADD(t, s, commit_items, c);
 				}
+				__NETP_MEM_SLOT_STAT_CACHED(t, s, tst);
+				return;
+			}
+			__NETP_MEM_SLOT_STAT_ADD(t, s, free_released, 1);
+		} else {
+			__NETP_MEM_STAT_ADD(m_large_free, 1);
+		}
+		__item_free((void*)a_hdr);
+	}
+
+
+	void pool_aligned_allocator::__free_remote(u8_t* item, u8_t t, u8_t s, u8_t node) {
+		NETP_ASSERT(m_remote[t] != nullptr && node < allocator_numa_node_count());
+		remote_slot_t*& rs = m_remote[t][s * allocator_numa_node_count() + node];
+		if (NETP_UNLIKELY(rs == nullptr)) {
+			rs = (remote_slot_t*)std::malloc(sizeof(remote_slot_t));
+			if (rs == nullptr) {
+				__item_free(item);
 				return;
 			}
+			rs->count = 0;
+		}
+		rs->items[rs->count++] = item;
+		if (rs->count == NETP_TRANSFER_BATCH_ITEMS(t)) {
+			global_pool_aligned_allocator::instance()->commit_remote(node, t, s, rs->items, rs->count);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, remote, rs->count);
+			rs->count = 0;
 		}
-		std::free((void*)a_hdr);
 	}
 
+	//send the partial batches home
+	void pool_aligned_allocator::__flush_remote() {
+		const u32_t node_count = allocator_numa_node_count();
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			if (m_remote[t] == nullptr) {
+				continue;
+			}
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				for (u32_t node = 0; node < node_count; ++node) {
+					remote_slot_t* rs = m_remote[t][s * node_count + node];
+					if (rs != nullptr && rs->count != 0) {
+						global_pool_aligned_allocator::instance()->commit_remote(u8_t(node), t, s, rs->items, rs->count);
+						__NETP_MEM_SLOT_STAT_ADD(t, s, remote, rs->count);
+						rs->count = 0;
+					}
+				}
+			}
+		}
+	}
 
 	//alloc, then copy
 	void* pool_aligned_allocator::realloc(void* old_ptr, size_t size, size_t alignment) {
@@ -406,84 +888,469 @@ __fast_path:
 		return newptr;
 	}
 
+	size_t pool_aligned_allocator::decay() {
+		__flush_remote();
+		size_t bytes = 0;
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				table_slot_t* tst = m_tables[t][s];
+				const u32_t n = __table_slot_release_bottom(tst, (tst->low >> 1));
+				if (n) {
+					tst->warm >>= 1;
+					bytes += n * calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s);
+					__NETP_MEM_SLOT_STAT_ADD(t, s, trimmed, n);
+					__NETP_MEM_SLOT_STAT_CACHED(t, s, tst);
+				}
+			}
+		}
+		m_cached_bytes -= bytes;
+		return bytes;
+	}
+
+	size_t pool_aligned_allocator::trim() {
+		__flush_remote();
+		size_t bytes = 0;
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				table_slot_t* tst = m_tables[t][s];
+				const u32_t n = __table_slot_release_bottom(tst, tst->count);
+				tst->warm = 0;
+				if (n) {
+					bytes += n * calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s);
+					__NETP_MEM_SLOT_STAT_ADD(t, s, trimmed, n);
+					__NETP_MEM_SLOT_STAT_CACHED(t, s, tst);
+				}
+			}
+		}
+		m_cached_bytes -= bytes;
+		return bytes;
+	}
+
+#ifdef NETP_MEMORY_ENABLE_STAT
+	void pool_aligned_allocator::stat_load(allocator_stat& st) const {
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				table_slot_stat_t const& from = m_stats[t][s];
+				allocator_slot_stat& to = st.slots[t][s];
+				to.alloc_hit += from.alloc_hit.load(std::memory_order_relaxed);
+				to.alloc_miss += from.alloc_miss.load(std::memory_order_relaxed);
+				to.free_cached += from.free_cached.load(std::memory_order_relaxed);
+				to.free_released += from.free_released.load(std::memory_order_relaxed);
+				to.borrow += from.borrow.load(std::memory_order_relaxed);
+				to.borrow_items += from.borrow_items.load(std::memory_order_relaxed);
+				to.commit += from.commit.load(std::memory_order_relaxed);
+				to.commit_items += from.commit_items.load(std::memory_order_relaxed);
+				to.trimmed += from.trimmed.load(std::memory_order_relaxed);
+				to.warmed += from.warmed.load(std::memory_order_relaxed);
+				to.remote += from.remote.load(std::memory_order_relaxed);
+				to.tls_cached += from.cached.load(std::memory_order_relaxed);
+			}
+		}
+		st.large_alloc += m_large_alloc.load(std::memory_order_relaxed);
+		st.large_free += m_large_free.load(std::memory_order_relaxed);
+	}
+
+	//the cached items of other are released by its deinit, only the traffic is kept
+	void pool_aligned_allocator::stat_fold(pool_aligned_allocator const& other) {
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				table_slot_stat_t const& from = other.m_stats[t][s];
+				table_slot_stat_t& to = m_stats[t][s];
+				__NETP_MEM_STAT_ADD(to.alloc_hit, from.alloc_hit.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.alloc_miss, from.alloc_miss.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.free_cached, from.free_cached.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.free_released, from.free_released.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.borrow, from.borrow.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.borrow_items, from.borrow_items.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.commit, from.commit.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.commit_items, from.commit_items.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.trimmed, from.trimmed.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.warmed, from.warmed.load(std::memory_order_relaxed));
+				__NETP_MEM_STAT_ADD(to.remote, from.remote.load(std::memory_order_relaxed));
+			}
+		}
+		__NETP_MEM_STAT_ADD(m_large_alloc, other.m_large_alloc.load(std::memory_order_relaxed));
+		__NETP_MEM_STAT_ADD(m_large_free, other.m_large_free.load(std::memory_order_relaxed));
+	}
+#endif
+
 	global_pool_aligned_allocator::global_pool_aligned_allocator():
-		pool_aligned_allocator(false)
+		pool_aligned_allocator(false),
+		m_node_count(allocator_numa_node_count()),
+		m_free_batches(0),
+		m_batch_segment_count(0),
+		m_global_cached_bytes(0),
+		m_last_decay(0)
 	{
-		for (size_t t = 0; t < sizeof(m_tables) / sizeof(m_tables[0]); ++t) {
-			m_table_slots_mtx[t] = ::new spin_mutex[NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t)];
+		for (size_t i = 0; i < NETP_TRANSFER_SEGMENT_MAX; ++i) {
+			m_batch_segments[i].store(0, std::memory_order_relaxed);
+		}
+		for (u32_t node = 0; node < NETP_MEMORY_NUMA_NODE_MAX; ++node) {
+			for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+				if (node >= m_node_count) {
+					m_transfer[node][t] = nullptr;
+					continue;
+				}
+				m_transfer[node][t] = ::new transfer_class[NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t)];
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+					transfer_class& tc = m_transfer[node][t][s];
+					tc.head.store(0, std::memory_order_relaxed);
+					tc.count.store(0, std::memory_order_relaxed);
+					tc.low.store(0, std::memory_order_relaxed);
+					//default: one thread -- main thread, or the first thread of the node
+					tc.limit.store(NETP_TRANSFER_BATCHES_PER_THREAD(t), std::memory_order_relaxed);
+				}
+			}
 		}
 	}
 
 	global_pool_aligned_allocator::~global_pool_aligned_allocator() {
-		for (size_t t = 0; t < sizeof(m_tables) / sizeof(m_tables[0]); ++t) {
-			for (size_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
-				lock_guard<spin_mutex> lg(m_table_slots_mtx[t][s]);
-				u32_t& _gcount = m_tables[t][s]->count;
-				while ( _gcount>0) {
-					std::free(m_tables[t][s]->ptr[ --_gcount ]);
+		for (u32_t node = 0; node < m_node_count; ++node) {
+			for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+					__release_batches(u8_t(node), t, s, u32_t(-1));
 				}
+				::delete[] m_transfer[node][t];
 			}
 		}
-		//deallocate mutex
-		for (size_t t = 0; t < sizeof(m_tables) / sizeof(m_tables[0]); ++t) {
-			::delete[] m_table_slots_mtx[t];
+		const u32_t segs = m_batch_segment_count.load(std::memory_order_acquire);
+		for (u32_t i = 0; i < segs; ++i) {
+			::delete[] m_batch_segments[i].load(std::memory_order_relaxed);
 		}
 	}
 
-	//default: one thread -- main thread
-	void global_pool_aligned_allocator::incre_thread_count() {
-		for (size_t t = 0; t < sizeof(m_tables) / sizeof(m_tables[0]); ++t) {
-			for (size_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
-				lock_guard<spin_mutex> lg(m_table_slots_mtx[t][s] );
-				u32_t max_n = m_tables[t][s]->max + TABLE_SLOT_ENTRIES_INIT_LIMIT[t];
-				u8_t* __ptr = (u8_t*)(std::realloc(m_tables[t][s], sizeof(table_slot_t) + sizeof(u8_t*) * max_n));
-				m_tables[t][s] = (table_slot_t*)__ptr;
-				m_tables[t][s]->max = max_n;
-				m_tables[t][s]->ptr = (u8_t**) (__ptr + sizeof(table_slot_t));
+	u32_t global_pool_aligned_allocator::__stack_pop(std::atomic<u64_t>& head) {
+		u64_t h = head.load(std::memory_order_acquire);
+		u32_t id;
+		do {
+			id = u32_t(h);
+			if (id == 0) {
+				return 0;
+			}
+			//might be stale, then the tag of head must have been changed, cas fails
+		} while (!head.compare_exchange_weak(h, ((((h >> 32) + 1) << 32) | __batch_at(id)->next.load(std::memory_order_relaxed)), std::memory_order_acq_rel, std::memory_order_acquire));
+		return id;
+	}
+
+	void global_pool_aligned_allocator::__stack_push(std::atomic<u64_t>& head, u32_t id) {
+		NETP_ASSERT(id != 0);
+		transfer_batch* b = __batch_at(id);
+		u64_t h = head.load(std::memory_order_relaxed);
+		do {
+			b->next.store(u32_t(h), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(h, ((((h >> 32) + 1) << 32) | id), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	u32_t global_pool_aligned_allocator::__batch_alloc() {
+		u32_t id = __stack_pop(m_free_batches);
+		if (NETP_LIKELY(id != 0)) {
+			return id;
+		}
+		lock_guard<spin_mutex> lg(m_batch_segment_mtx);
+		id = __stack_pop(m_free_batches);
+		if (id != 0) {
+			return id;
+		}
+		const u32_t seg = m_batch_segment_count.load(std::memory_order_relaxed);
+		if (seg == NETP_TRANSFER_SEGMENT_MAX) {
+			return 0;
+		}
+		m_batch_segments[seg].store(::new transfer_batch[NETP_TRANSFER_SEGMENT_BATCHES], std::memory_order_release);
+		m_batch_segment_count.store(seg + 1, std::memory_order_release);
+		const u32_t first = seg * NETP_TRANSFER_SEGMENT_BATCHES + 1;
+		for (u32_t i = 1; i < NETP_TRANSFER_SEGMENT_BATCHES; ++i) {
+			__stack_push(m_free_batches, first + i);
+		}
+		return first;
+	}
+
+	size_t global_pool_aligned_allocator::__release_batches(u8_t node, u8_t t, u8_t s, u32_t n) {
+		transfer_class& tc = m_transfer[node][t][s];
+		u32_t items = 0;
+		while (n-- > 0) {
+			const u32_t id = __stack_pop(tc.head);
+			if (id == 0) {
+				break;
+			}
+			tc.count.fetch_sub(1, std::memory_order_relaxed);
+			transfer_batch* b = __batch_at(id);
+			for (u32_t i = 0; i < b->count; ++i) {
+				__item_free(b->items[i]);
+			}
+			items += b->count;
+			__stack_push(m_free_batches, id);
+		}
+		const size_t bytes = items * calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s);
+		m_global_cached_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+#ifdef NETP_MEMORY_ENABLE_STAT
+		if (items != 0) {
+			lock_guard<spin_mutex> lg_stat(m_stat_mtx);
+			__NETP_MEM_SLOT_STAT_ADD(t, s, trimmed, items);
+		}
+#endif
+		return bytes;
+	}
+
+	void global_pool_aligned_allocator::incre_thread_count(u8_t node) {
+		NETP_ASSERT(node < m_node_count);
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				m_transfer[node][t][s].limit.fetch_add(NETP_TRANSFER_BATCHES_PER_THREAD(t), std::memory_order_relaxed);
 			}
 		}
 	}
 
-	void global_pool_aligned_allocator::decre_thread_count() {
-		for (size_t t = 0; t < sizeof(m_tables) / sizeof(m_tables[0]); ++t) {
-			for (size_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
-				lock_guard<spin_mutex> lg(m_table_slots_mtx[t][s]);
-				NETP_ASSERT(m_tables[t][s]->max >= TABLE_SLOT_ENTRIES_INIT_LIMIT[t]);
-				u32_t max_n = m_tables[t][s]->max - TABLE_SLOT_ENTRIES_INIT_LIMIT[t];
-				u32_t& _gcount = m_tables[t][s]->count;
-				//purge exceed count first
-				while (_gcount > max_n) {
-					std::free(m_tables[t][s]->ptr[--_gcount]);
+	void global_pool_aligned_allocator::decre_thread_count(u8_t node) {
+		NETP_ASSERT(node < m_node_count);
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				transfer_class& tc = m_transfer[node][t][s];
+				const u32_t limit = tc.limit.fetch_sub(NETP_TRANSFER_BATCHES_PER_THREAD(t), std::memory_order_relaxed) - NETP_TRANSFER_BATCHES_PER_THREAD(t);
+				//purge exceed count
+				const u32_t count = tc.count.load(std::memory_order_relaxed);
+				if (count > limit) {
+					__release_batches(node, t, s, count - limit);
 				}
-				u8_t* __ptr = (u8_t*)(std::realloc(m_tables[t][s], sizeof(table_slot_t) + sizeof(u8_t*) * max_n));
-				m_tables[t][s] = (table_slot_t*)__ptr;
-				m_tables[t][s]->max = max_n;
-				m_tables[t][s]->ptr = (u8_t**)(__ptr + sizeof(table_slot_t));
 			}
 		}
 	}
 
-	u32_t global_pool_aligned_allocator::commit(u8_t t, u8_t s, table_slot_t* tst) {
-		lock_guard<spin_mutex> lg(m_table_slots_mtx[t][s]);
-		u32_t& _gcount = m_tables[t][s]->count;
-		u32_t& _tcount = tst->count;
-		u32_t tt = 0;
-		if ( (_gcount < (m_tables[t][s]->max - 1)) && ( _tcount > ( (tst->max)>>1) ) ) {
-			m_tables[t][s]->ptr[_gcount++] = tst->ptr[--_tcount];
-			++tt;
+	bool global_pool_aligned_allocator::__push_batch(u8_t node, u8_t t, u8_t s, u8_t** items, u32_t n) {
+		transfer_class& tc = m_transfer[node][t][s];
+		const size_t bytes = n * calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s);
+		const size_t global_max = s_global_cached_bytes_max.load(std::memory_order_relaxed);
+		if ( (tc.count.load(std::memory_order_relaxed) >= tc.limit.load(std::memory_order_relaxed)) ||
+			((global_max != 0) && ((m_global_cached_bytes.load(std::memory_order_relaxed) + bytes) > global_max))
+		) {
+			return false;
+		}
+		const u32_t id = __batch_alloc();
+		if (NETP_UNLIKELY(id == 0)) {
+			return false;
+		}
+		transfer_batch* b = __batch_at(id);
+		std::memcpy(b->items, items, sizeof(u8_t*) * n);
+		b->count = n;
+		m_global_cached_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		tc.count.fetch_add(1, std::memory_order_relaxed);
+		__stack_push(tc.head, id);
+		return true;
+	}
+
+	//hand over the top batch of the tls slot with a single cas
+	u32_t global_pool_aligned_allocator::commit(u8_t node, u8_t t, u8_t s, table_slot_t* tst) {
+		const u32_t n = NETP_TRANSFER_BATCH_ITEMS(t);
+		NETP_ASSERT(tst->count >= n);
+		if (!__push_batch(node, t, s, tst->ptr + (tst->count - n), n)) {
+			return 0;
+		}
+		tst->count -= n;
+		return n;
+	}
+
+	void global_pool_aligned_allocator::commit_remote(u8_t node, u8_t t, u8_t s, u8_t** items, u32_t n) {
+		NETP_ASSERT(node < m_node_count && n <= NETP_TRANSFER_BATCH_ITEMS(t));
+		if (!__push_batch(node, t, s, items, n)) {
+			for (u32_t i = 0; i < n; ++i) {
+				__item_free(items[i]);
+			}
 		}
-		return tt;
 	}
 
-	u32_t global_pool_aligned_allocator::borrow(u8_t t, u8_t s, table_slot_t* tst) {
+	u32_t global_pool_aligned_allocator::borrow(u8_t node, u8_t t, u8_t s, table_slot_t* tst) {
 		NETP_ASSERT( tst->count ==0 );
-		NETP_ASSERT(tst->max > 0);
-		lock_guard<spin_mutex> lg(m_table_slots_mtx[t][s]);
-		u32_t& _gcount = m_tables[t][s]->count;
-		u32_t& _tcount = tst->count;
-		while ((_gcount > 0) && (_tcount < ((tst->max) >> 1))) {
-			tst->ptr[_tcount++] = m_tables[t][s]->ptr[--_gcount];
+		NETP_ASSERT(tst->max >= NETP_TRANSFER_BATCH_ITEMS(t));
+		transfer_class& tc = m_transfer[node][t][s];
+		const u32_t id = __stack_pop(tc.head);
+		if (id == 0) {
+			return 0;
+		}
+		const u32_t count = tc.count.fetch_sub(1, std::memory_order_relaxed) - 1;
+		u32_t low = tc.low.load(std::memory_order_relaxed);
+		while ((count < low) && !tc.low.compare_exchange_weak(low, count, std::memory_order_relaxed, std::memory_order_relaxed)) {}
+
+		transfer_batch* b = __batch_at(id);
+		std::memcpy(tst->ptr, b->items, sizeof(u8_t*) * b->count);
+		tst->count = b->count;
+		m_global_cached_bytes.fetch_sub(b->count * calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s), std::memory_order_relaxed);
+		__stack_push(m_free_batches, id);
+		return tst->count;
+	}
+
+	//@note: the batches unused in the interval are released from the top, a lock free stack has no bottom access
+	size_t global_pool_aligned_allocator::decay(u32_t min_interval_ms) {
+		const i64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		i64_t last = m_last_decay.load(std::memory_order_relaxed);
+		if (((now - last) < i64_t(min_interval_ms)) || !m_last_decay.compare_exchange_strong(last, now, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+			return 0;
+		}
+		size_t bytes = 0;
+		for (u32_t node = 0; node < m_node_count; ++node) {
+			for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+					transfer_class& tc = m_transfer[node][t][s];
+					const u32_t n = tc.low.load(std::memory_order_relaxed) >> 1;
+					if (n) {
+						bytes += __release_batches(u8_t(node), t, s, n);
+					}
+					tc.low.store(tc.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				}
+			}
+		}
+		return bytes;
+	}
+
+	size_t global_pool_aligned_allocator::trim() {
+		size_t bytes = 0;
+		for (u32_t node = 0; node < m_node_count; ++node) {
+			for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+					bytes += __release_batches(u8_t(node), t, s, u32_t(-1));
+					m_transfer[node][t][s].low.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+		return bytes;
+	}
+
+	void global_pool_aligned_allocator::stat_attach(pool_aligned_allocator* allocator) {
+#ifdef NETP_MEMORY_ENABLE_STAT
+		NETP_ASSERT(allocator != nullptr && allocator != this);
+		lock_guard<spin_mutex> lg(m_stat_mtx);
+		m_stat_allocators.push_back(allocator);
+		allocator->m_stat_attached = true;
+#else
+		(void)allocator;
+#endif
+	}
+
+	void global_pool_aligned_allocator::stat_detach(pool_aligned_allocator* allocator) {
+#ifdef NETP_MEMORY_ENABLE_STAT
+		lock_guard<spin_mutex> lg(m_stat_mtx);
+		std::vector<pool_aligned_allocator*>::iterator it = std::find(m_stat_allocators.begin(), m_stat_allocators.end(), allocator);
+		if (it != m_stat_allocators.end()) {
+			stat_fold(*allocator);
+			m_stat_allocators.erase(it);
+			allocator->m_stat_attached = false;
+		}
+#else
+		(void)allocator;
+#endif
+	}
+
+	void global_pool_aligned_allocator::stat_collect(allocator_stat& st) {
+		std::memset((void*)&st, 0, sizeof(allocator_stat));
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				st.slots[t][s].size = u32_t(calc_SIZE_by_TABLE_SLOT(t, calc_F_by_slot(t), s));
+			}
+		}
+#ifdef NETP_MEMORY_ENABLE_STAT
+		{
+			lock_guard<spin_mutex> lg(m_stat_mtx);
+			st.thread_count = u32_t(m_stat_allocators.size());
+			for (std::vector<pool_aligned_allocator*>::const_iterator it = m_stat_allocators.begin(); it != m_stat_allocators.end(); ++it) {
+				(*it)->stat_load(st);
+			}
+			//exited threads
+			stat_load(st);
+		}
+#endif
+		st.numa_nodes = m_node_count;
+		for (u32_t node = 0; node < m_node_count; ++node) {
+			for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+				for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+					st.slots[t][s].global_cached += m_transfer[node][t][s].count.load(std::memory_order_relaxed) * NETP_TRANSFER_BATCH_ITEMS(t);
+				}
+			}
+		}
+#ifdef NETP_MEMORY_USE_SLAB
+		st.slab_chunks = __slab_pool()->chunk_count();
+		st.slab_huge_chunks = __slab_pool()->huge_chunk_count();
+#endif
+	}
+
+	void allocator_cfg_cached_bytes_max(size_t tls_max, size_t global_max) {
+		s_tls_cached_bytes_max.store(tls_max, std::memory_order_relaxed);
+		s_global_cached_bytes_max.store(global_max, std::memory_order_relaxed);
+	}
+
+	void allocator_cfg_preallocate(bool eager) {
+		s_preallocate_eager.store(eager, std::memory_order_relaxed);
+		pool_aligned_allocator* allocator = tls_get<pool_aligned_allocator>();
+		if (eager && allocator != nullptr) {
+			allocator->preallocate();
+		}
+	}
+
+	size_t allocator_decay(u32_t global_min_interval_ms) {
+		size_t bytes = 0;
+		pool_aligned_allocator* allocator = tls_get<pool_aligned_allocator>();
+		if (allocator != nullptr) {
+			bytes += allocator->decay();
+		}
+		return bytes + global_pool_aligned_allocator::instance()->decay(global_min_interval_ms);
+	}
+
+	size_t allocator_trim() {
+		size_t bytes = 0;
+		pool_aligned_allocator* allocator = tls_get<pool_aligned_allocator>();
+		if (allocator != nullptr) {
+			bytes += allocator->trim();
+		}
+		bytes += global_pool_aligned_allocator::instance()->trim();
+#ifdef NETP_MEMORY_USE_SLAB
+		__slab_pool()->trim();
+#endif
+#if defined(__GLIBC__)
+		::malloc_trim(0);
+#endif
+		return bytes;
+	}
+
+	void allocator_stat_collect(allocator_stat& st) {
+		global_pool_aligned_allocator::instance()->stat_collect(st);
+	}
+
+	std::string allocator_stat_dump(allocator_stat const& st) {
+		std::string dump;
+		char line[512];
+		u64_t alloc_total = 0, hit_total = 0, free_total = 0, tls_bytes = 0, global_bytes = 0, transfer_total = 0;
+
+		int n = snprintf(line, sizeof(line), "[allocator]threads: %u, numa nodes: %u\n%-4s %-4s %8s %12s %12s %7s %12s %12s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n", st.thread_count, st.numa_nodes,
+			"T", "S", "size", "alloc", "miss", "hit%", "free", "released", "borrow", "b_items", "commit", "c_items", "trimmed", "warmed", "remote", "tls", "global");
+		dump.append(line, n);
+		for (u8_t t = 0; t < TABLE::T_COUNT; ++t) {
+			for (u8_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_MAX(t); ++s) {
+				allocator_slot_stat const& ss = st.slots[t][s];
+				const u64_t alloc = ss.alloc_hit + ss.alloc_miss;
+				const u64_t free_ = ss.free_cached + ss.free_released;
+				alloc_total += alloc;
+				hit_total += ss.alloc_hit;
+				free_total += free_;
+				transfer_total += ss.borrow_items + ss.commit_items;
+				tls_bytes += ss.tls_cached * ss.size;
+				global_bytes += ss.global_cached * ss.size;
+				if (alloc == 0 && free_ == 0 && ss.tls_cached == 0 && ss.global_cached == 0) {
+					continue;
+				}
+				n = snprintf(line, sizeof(line), "%-4u %-4u %8u %12llu %12llu %6.2f%% %12llu %12llu %10llu %10llu %10llu %10llu %10llu %10llu %10llu %10llu %10llu\n",
+					t, s, ss.size, (unsigned long long)alloc, (unsigned long long)ss.alloc_miss, (alloc == 0 ? 0.0 : (ss.alloc_hit * 100.0) / alloc),
+					(unsigned long long)free_, (unsigned long long)ss.free_released,
+					(unsigned long long)ss.borrow, (unsigned long long)ss.borrow_items, (unsigned long long)ss.commit, (unsigned long long)ss.commit_items, (unsigned long long)ss.trimmed,
+					(unsigned long long)ss.warmed, (unsigned long long)ss.remote, (unsigned long long)ss.tls_cached, (unsigned long long)ss.global_cached);
+				dump.append(line, n);
+			}
 		}
-		return _tcount;
+		n = snprintf(line, sizeof(line), "[allocator]pooled alloc: %llu, hit: %.2f%%, free: %llu, global transfer items: %llu, large alloc: %llu, large free: %llu, tls cached: %llu bytes, global cached: %llu bytes\n",
+			(unsigned long long)alloc_total, (alloc_total == 0 ? 0.0 : (hit_total * 100.0) / alloc_total), (unsigned long long)free_total, (unsigned long long)transfer_total,
+			(unsigned long long)st.large_alloc, (unsigned long long)st.large_free, (unsigned long long)tls_bytes, (unsigned long long)global_bytes);
+		dump.append(line, n);
+#ifdef NETP_MEMORY_USE_SLAB
+		n = snprintf(line, sizeof(line), "[allocator]slab chunks: %u, hugetlb chunks: %u, mapped: %llu bytes\n",
+			st.slab_chunks, st.slab_huge_chunks, (unsigned long long)st.slab_chunks * NETP_SLAB_CHUNK_SIZE);
+		dump.append(line, n);
+#endif
+		return dump;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,176 @@
+#include <netp/mirror_ringbuffer.hpp>
+#include <netp/socket_api.hpp>
+
+#if !defined(_NETP_WIN)
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+#endif
+
+#ifdef _NETP_GNU_LINUX
+	#include <sys/syscall.h>
+#endif
+
+namespace netp {
+
+	static u32_t __mirror_granularity() {
+#if defined(_NETP_WIN)
+		SYSTEM_INFO si;
+		::GetSystemInfo(&si);
+		return u32_t(si.dwAllocationGranularity);
+#else
+		return u32_t(::sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+#if !defined(_NETP_WIN)
+	//an unlinked shared memory object of size bytes, closed by the caller once mapped
+	static int __mirror_shm_open(u32_t size, int& fd_o) {
+		int fd = -1;
+#if defined(_NETP_GNU_LINUX) && defined(SYS_memfd_create)
+		fd = (int)::syscall(SYS_memfd_create, "netp_mirror_ringbuffer", 1U/*MFD_CLOEXEC*/);
+#endif
+		if (fd == -1) {
+#if defined(_NETP_GNU_LINUX) || defined(_NETP_ANDROID)
+			char path[] = "/dev/shm/netp_mirror_XXXXXX";
+			fd = ::mkstemp(path);
+			if (fd == -1) {
+				return netp_last_errno();
+			}
+			::unlink(path);
+#else
+			static std::atomic<u32_t> _seq(0);
+			char name[64];
+			snprintf(name, sizeof(name), "/netp_mirror_%d_%u", int(::getpid()), _seq.fetch_add(1, std::memory_order_relaxed));
+			fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+			if (fd == -1) {
+				return netp_last_errno();
+			}
+			::shm_unlink(name);
+#endif
+		}
+		if (::ftruncate(fd, off_t(size)) == -1) {
+			const int ec = netp_last_errno();
+			::close(fd);
+			return ec;
+		}
+		fd_o = fd;
+		return netp::OK;
+	}
+#endif
+
+	mirror_ringbuffer::mirror_ringbuffer() :
+		m_buffer(nullptr),
+		m_capacity(0),
+		m_begin(0),
+		m_end(0)
+	{}
+
+	mirror_ringbuffer::~mirror_ringbuffer() {
+		__unmap();
+	}
+
+	void mirror_ringbuffer::__unmap() {
+		if (m_buffer == nullptr) {
+			return;
+		}
+#if defined(_NETP_WIN)
+		::UnmapViewOfFile(m_buffer + m_capacity);
+		::UnmapViewOfFile(m_buffer);
+#else
+		::munmap(m_buffer, size_t(m_capacity) << 1);
+#endif
+		m_buffer = nullptr;
+		m_capacity = 0;
+		m_begin = m_end = 0;
+	}
+
+	int mirror_ringbuffer::init(u32_t capacity) {
+		NETP_ASSERT(m_buffer == nullptr);
+		NETP_ASSERT(capacity > 0 && capacity <= MAX_MIRROR_RINGBUFFER_SIZE);
+		const u32_t g = __mirror_granularity();
+		capacity = ((capacity + (g - 1)) / g) * g;
+		const size_t vsize = size_t(capacity) << 1;
+
+#if defined(_NETP_WIN)
+		HANDLE h = ::CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, DWORD(capacity), NULL);
+		if (h == NULL) {
+			return netp_last_errno();
+		}
+		//reserve, release, then map both views into the hole, another thread might take the hole in between, retry a few times
+		int ec = netp::E_MEMORY_ALLOC_FAILED;
+		for (int i = 0; i < 8; ++i) {
+			byte_t* base = (byte_t*)::VirtualAlloc(NULL, vsize, MEM_RESERVE, PAGE_NOACCESS);
+			if (base == NULL) {
+				ec = netp_last_errno();
+				break;
+			}
+			::VirtualFree(base, 0, MEM_RELEASE);
+			byte_t* a = (byte_t*)::MapViewOfFileEx(h, FILE_MAP_ALL_ACCESS, 0, 0, capacity, base);
+			if (a == NULL) {
+				continue;
+			}
+			byte_t* b = (byte_t*)::MapViewOfFileEx(h, FILE_MAP_ALL_ACCESS, 0, 0, capacity, base + capacity);
+			if (b == NULL) {
+				::UnmapViewOfFile(a);
+				continue;
+			}
+			m_buffer = base;
+			break;
+		}
+		//the views keep the section alive
+		::CloseHandle(h);
+		if (m_buffer == nullptr) {
+			return ec;
+		}
+#else
+		int fd = -1;
+		int rt = __mirror_shm_open(capacity, fd);
+		if (rt != netp::OK) {
+			return rt;
+		}
+		byte_t* base = (byte_t*)::mmap(0, vsize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if ((void*)base == MAP_FAILED) {
+			rt = netp_last_errno();
+			::close(fd);
+			return rt;
+		}
+		if ( (::mmap(base, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+			(::mmap(base + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+		) {
+			rt = netp_last_errno();
+			::munmap(base, vsize);
+			::close(fd);
+			return rt;
+		}
+		//the mappings keep the pages alive
+		::close(fd);
+		m_buffer = base;
+#endif
+		m_capacity = capacity;
+		m_begin = m_end = 0;
+		return netp::OK;
+	}
+
+	u32_t mirror_ringbuffer::recv(SOCKET fd, int& ec) {
+		const u32_t left = left_capacity();
+		if (NETP_UNLIKELY(left == 0)) {
+			ec = netp::E_EWOULDBLOCK;
+			return 0;
+		}
+		const u32_t nbytes = netp::recv(fd, tail(), left, ec, 0);
+		m_end += nbytes;
+		return nbytes;
+	}
+
+	u32_t mirror_ringbuffer::send(SOCKET fd, int& ec) {
+		const u32_t c = count();
+		if (NETP_UNLIKELY(c == 0)) {
+			ec = netp::OK;
+			return 0;
+		}
+		const u32_t nbytes = netp::send(fd, head(), c, ec, 0);
+		skip(nbytes);
+		return nbytes;
+	}
+}
@@ -49,7 +49,7 @@ namespace netp {
 	}
 
 	void rpc::_do_reply(NRP<netp::rpc_message> const& reply) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		TRACE_RPC("[rpc]call done, id: %u, call rt: %d, data len: %u", reply->id, reply->code, reply->data == nullptr ? 0 : reply->data->len());
 		if(m_wstate ==rpc_write_state::S_WRITE_CLOSED) {
@@ -61,45 +61,51 @@ namespace netp {
 		_do_flush();
 	}
 
-	//for a one by one write call, we would not get E_CHANNEL_WRITE_BLOCK
-	void rpc::_do_reply_done(int rt) {
-		NETP_ASSERT(m_loop->in_event_loop());
+	//a blocked write puts itself and the ones written after it back to the queue, in order, they are retried on the next write done or timer tick
+	void rpc::_do_reply_done(NRP<netp::rpc_message> const& reply, int rt) {
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		if (m_wstate == rpc_write_state::S_WRITE_CLOSED) { return; }
 
-		NETP_ASSERT(m_reply_q.size());
-		NRP<rpc_message>& _reply = m_reply_q.front();
+		rpc_message_reply_queue_t::iterator it = std::find(m_replying_q.begin(), m_replying_q.end(), reply);
+		if (it == m_replying_q.end()) {
+			//moved back by a blocked write ahead of it
+			return;
+		}
 		if (rt == netp::OK) {
-			TRACE_RPC("[rpc]reply ok, write rt: %d, id: %d, call rt: %d, reply data len: %u", rt, _reply->id, _reply->code, _reply->data == nullptr ? 0 : _reply->data->len());
-			m_wstate = rpc_write_state::S_WRITE_IDLE;
-			m_reply_q.pop_front();
-			if (m_reply_q.empty()) {
-				rpc_message_reply_queue_t().swap(m_reply_q);
+			TRACE_RPC("[rpc]reply ok, write rt: %d, id: %d, call rt: %d, reply data len: %u", rt, reply->id, reply->code, reply->data == nullptr ? 0 : reply->data->len());
+			NETP_ASSERT(it == m_replying_q.begin());
+			m_replying_q.pop_front();
+			if (m_replying_q.empty()) {
+				rpc_message_reply_queue_t().swap(m_replying_q);
 			}
 			_do_flush();
+		} else if (rt == netp::E_CHANNEL_WRITE_BLOCK) {
+			m_reply_q.insert(m_reply_q.begin(), it, m_replying_q.end());
+			m_replying_q.erase(it, m_replying_q.end());
+			m_write_blocked = true;
 		} else {
-			NETP_ASSERT(rt != netp::E_CHANNEL_WRITE_BLOCK);
 			NETP_ASSERT(m_ctx != nullptr);
-			NETP_ERR("[rpc]reply failed, write rt: %d, id: %d, call rt: %d, reply data len: %u",rt, _reply->id, _reply->code, _reply->data == nullptr ? 0 : _reply->data->len() );
+			NETP_ERR("[rpc]reply failed, write rt: %d, id: %d, call rt: %d, reply data len: %u",rt, reply->id, reply->code, reply->data == nullptr ? 0 : reply->data->len() );
 			m_ctx->close();
 		}
 	}
 
-	void rpc::_do_write_req_done(int rt) {
-		NETP_ASSERT(m_loop->in_event_loop());
+	void rpc::_do_write_req_done(NRP<netp::rpc_req_message> const& _req, int rt) {
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		if(m_wstate == rpc_write_state::S_WRITE_CLOSED) {return;}
 
-		NETP_ASSERT(m_write_list.size() );
-		NRP<rpc_req_message> _req = m_write_list.front();
+		rpc_message_req_list_t::iterator it = std::find(m_writing_list.begin(), m_writing_list.end(), _req);
+		if (it == m_writing_list.end()) {
+			NETP_ASSERT(_req->state == rpc_req_message_state::S_WAIT_WRITE || _req->state == rpc_req_message_state::S_TIMEOUT);
+			return;
+		}
+		NETP_ASSERT(_req->state == rpc_req_message_state::S_WRITING);
 		if (rt == netp::OK) {
 			TRACE_RPC("[rpc]write ok, write rt: %d, type: %d, id: %d, data len: %u", rt, _req->m->type, _req->m->id, _req->m->data == nullptr ? 0 : _req->m->data->len());
-			NETP_ASSERT(_req->state == rpc_req_message_state::S_WRITING);
-
-			m_write_list.pop_front();
-			if (m_write_list.empty()) {
-				rpc_message_req_list_t().swap(m_write_list);
-			}
+			NETP_ASSERT(it == m_writing_list.begin());
+			m_writing_list.pop_front();
 
 			if (_req->m->type == rpc_message_type::T_REQ) {
 				_req->state = rpc_req_message_state::S_WAIT_RESPOND;
@@ -109,77 +115,98 @@ namespace netp {
 				NETP_ASSERT(_req->m->type == rpc_message_type::T_DATA);
 				_req->pushp->set(netp::OK);
 			}
-			m_wstate = rpc_write_state::S_WRITE_IDLE;
 			_do_flush();
+		} else if (rt == netp::E_CHANNEL_WRITE_BLOCK) {
+			for (rpc_message_req_list_t::iterator it_ = it; it_ != m_writing_list.end(); ++it_) {
+				(*it_)->state = rpc_req_message_state::S_WAIT_WRITE;
+			}
+			m_write_list.splice(m_write_list.begin(), m_writing_list, it, m_writing_list.end());
+			m_write_blocked = true;
 		} else {
 			NETP_ASSERT(m_ctx != nullptr);
-			NETP_ASSERT(rt != netp::E_CHANNEL_WRITE_BLOCK);
 			_req->state = rpc_req_message_state::S_WAIT_WRITE;
 			NETP_ERR("[rpc]write req failed, write rt: %d, id: %d, data len: %u", rt, _req->m->id, _req->m->data == nullptr ? 0 : _req->m->data->len() );
 			m_ctx->close();
 		} 
 	}
 
+	//write every queued message without waiting for the previous write done, the writes below are batched by hlen in a read round
 	void rpc::_do_flush() {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		NETP_ASSERT((m_wstate != rpc_write_state::S_WRITE_CLOSED) ) ;
-		if (m_wstate != rpc_write_state::S_WRITE_IDLE ) {
+		//a write done in a write comes back here
+		if (m_wstate != rpc_write_state::S_WRITE_IDLE || m_flush_deferred) {
 			return;
 		}
 
 		NETP_ASSERT(m_ctx != nullptr);
-		while (!m_reply_q.empty()) {
-			m_wstate = rpc_write_state::S_WRITING;
-			NRP<rpc_message>& reply_r = m_reply_q.front();
+		m_wstate = rpc_write_state::S_WRITING;
+		m_write_blocked = false;
+		while (!m_reply_q.empty() && !m_write_blocked && m_wstate == rpc_write_state::S_WRITING) {
+			NRP<rpc_message> reply_r = m_reply_q.front();
+			m_reply_q.pop_front();
+			m_replying_q.push_back(reply_r);
 			NRP<netp::packet> outp;
 			reply_r->encode(outp);
 
 			NRP<netp::promise<int>> wp = netp::make_ref<netp::promise<int>>();
-			wp->if_done([R = NRP<netp::rpc>(this)](int const& rt) {
-				R->_do_reply_done(rt);
+			wp->if_done([R = NRP<netp::rpc>(this), reply_r](int const& rt) {
+				R->_do_reply_done(reply_r, rt);
 			});
-
 			m_ctx->write(wp, outp);
-			return;
 		}
 
-		while (!m_write_list.empty()) {
-			NRP<rpc_req_message>& _req = m_write_list.front();
+		while (!m_write_list.empty() && !m_write_blocked && m_wstate == rpc_write_state::S_WRITING) {
+			NRP<rpc_req_message> _req = m_write_list.front();
+			m_write_list.pop_front();
 
 			if ( (_req->m->type == rpc_message_type::T_REQ && _req->callp->is_cancelled())
 				|| (_req->m->type == rpc_message_type::T_DATA && _req->pushp->is_cancelled())
 				) {
-				m_write_list.pop_front();
 				continue;
 			}
 
 			NETP_ASSERT(_req->state == rpc_req_message_state::S_WAIT_WRITE);
 			_req->state = rpc_req_message_state::S_WRITING;
-			m_wstate = rpc_write_state::S_WRITING;
+			m_writing_list.push_back(_req);
 			NRP<netp::packet> outp;
 			_req->m->encode(outp);
 			NRP<netp::promise<int>> wp = netp::make_ref<netp::promise<int>>();
-			wp->if_done([R = NRP<netp::rpc>(this)](int const& rt) {
-				R->_do_write_req_done(rt);
+			wp->if_done([R = NRP<netp::rpc>(this), _req](int const& rt) {
+				R->_do_write_req_done(_req, rt);
 			});
 			m_ctx->write(wp,outp);
-			return;
+		}
+		if (m_wstate == rpc_write_state::S_WRITING) {
+			m_wstate = rpc_write_state::S_WRITE_IDLE;
 		}
 	}
 
-	void rpc::_timer_timeout(NRP<netp::timer> const& t) {
+	void rpc::_timer_launch() {
+		NRP<netp::timer> tm_TIMEOUT = netp::make_ref<netp::timer>(std::chrono::seconds(1), &rpc::_timer_timeout, NRP<rpc>(this), std::placeholders::_1, ++m_tm_seq);
+		m_loop_binding->L()->launch(tm_TIMEOUT, netp::make_ref<promise<int>>());
+	}
+
+	void rpc::_timer_timeout(NRP<netp::timer> const& t, u32_t seq) {
+		//launched by the loop we migrated from, loop_migrated has launched a new one
+		if (NETP_UNLIKELY(!m_loop_binding->in_event_loop() || seq != m_tm_seq)) {
+			return;
+		}
 		_do_timer_timeout();
+		if (m_write_blocked && m_wstate == rpc_write_state::S_WRITE_IDLE) {
+			_do_flush();
+		}
 		if (m_wstate != rpc_write_state::S_WRITE_CLOSED) {
-			m_loop->launch(t, netp::make_ref<promise<int>>());
+			m_loop_binding->L()->launch(t, netp::make_ref<promise<int>>());
 			return;
 		}
 	}
 
 	void rpc::_do_timer_timeout() {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		rpc_message_req_list_t::iterator&& it = m_wait_respond_list.begin();
-		const timer_timepoint_t now = timer_clock_t::now();
+		const timer_timepoint_t now = m_loop_binding->L()->now();
 		while (it != m_wait_respond_list.end()) {
 			NRP<rpc_req_message> _req = *it;
 			if (now > _req->tp_timeout) {
@@ -199,11 +226,7 @@ namespace netp {
 		while (it_to_write != m_write_list.end()) {
 			NRP<rpc_req_message> _req = *it_to_write;
 			if (now > _req->tp_timeout) {
-				if (_req->state == rpc_req_message_state::S_WRITING) {
-					++it_to_write;
-					continue;
-				}
-
+				//the written ones are in m_writing_list
 				if (_req->state == rpc_req_message_state::S_WAIT_WRITE) {
 					it_to_write = m_write_list.erase(it_to_write);
 					_req->state = rpc_req_message_state::S_TIMEOUT;
@@ -225,7 +248,7 @@ namespace netp {
 	}
 
 	void rpc::_do_close(NRP<netp::promise<int>> const& tf) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		NETP_ASSERT(m_ctx != nullptr);
 		m_ctx->close(tf);
@@ -233,13 +256,13 @@ namespace netp {
 
 	void rpc::_do_call(NRP<netp::rpc_call_promise> const& callp, int api_id, NRP<netp::packet> const& data, netp::timer_duration_t const& timeout) {
 
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		if (m_wstate == rpc_write_state::S_WRITE_CLOSED) {
 			callp->set(std::make_tuple(netp::E_RPC_NO_WRITE_CHANNEL, nullptr));
 			return;
 		}
 
-		if (m_write_list.size() >= m_queue_size) {
+		if ((m_write_list.size() + m_writing_list.size()) >= m_queue_size) {
 			callp->set(std::make_tuple(netp::E_CHANNEL_WRITE_BLOCK, nullptr));
 			return;
 		}
@@ -249,20 +272,20 @@ namespace netp {
 		req_r->state = netp::rpc_req_message_state::S_WAIT_WRITE;
 		req_r->m = m;
 		req_r->callp = callp;
-		req_r->tp_timeout = timer_clock_t::now() + timeout;
+		req_r->tp_timeout = m_loop_binding->L()->now() + timeout;
 		m_write_list.push_back(req_r);
 		_do_flush();
 	}
 
 	void rpc::_do_push(NRP<netp::rpc_push_promise> const& pushp, NRP<netp::packet> const& data,  timer_duration_t const& timeout) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 
 		if (m_wstate == rpc_write_state::S_WRITE_CLOSED) {
 			pushp->set(netp::E_RPC_NO_WRITE_CHANNEL);
 			return;
 		}
 
-		if (m_write_list.size() >= m_queue_size) {
+		if ((m_write_list.size() + m_writing_list.size()) >= m_queue_size) {
 			pushp->set(netp::E_CHANNEL_WRITE_BLOCK);
 			return;
 		}
@@ -272,14 +295,14 @@ namespace netp {
 		req_r->state = netp::rpc_req_message_state::S_WAIT_WRITE;
 		req_r->m = m;
 		req_r->pushp = pushp;
-		req_r->tp_timeout = timer_clock_t::now() + timeout;
+		req_r->tp_timeout = m_loop_binding->L()->now() + timeout;
 		m_write_list.push_back(req_r);
 
 		_do_flush();
 	}
 
 	void rpc::connected(NRP<netp::channel_handler_context> const& ctx) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		m_ctx = ctx;
 
 		NETP_ASSERT(m_wstate == rpc_write_state::S_WRITE_CLOSED);
@@ -289,23 +312,33 @@ namespace netp {
 		unbind(E_RPC_CONNECTED);
 		unbind(E_RPC_ERROR);
 
-		NRP<netp::timer> tm_TIMEOUT = netp::make_ref<netp::timer>(std::chrono::seconds(1), &rpc::_timer_timeout, NRP<rpc>(this), std::placeholders::_1 ) ;
-		m_loop->launch(tm_TIMEOUT,netp::make_ref<promise<int>>());
+		_timer_launch();
+	}
+
+	void rpc::loop_migrated(NRP<netp::channel_handler_context> const& ctx, NRP<netp::io_event_loop> const& from) {
+		NETP_ASSERT(m_loop_binding->in_event_loop());
+		if (m_wstate != rpc_write_state::S_WRITE_CLOSED) {
+			_timer_launch();
+		}
+		ctx->fire_loop_migrated(from);
 	}
 
 	void rpc::closed(NRP<netp::channel_handler_context> const& ctx) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		TRACE_RPC("[rpc][#%u]rpc closed", ctx->ch->ch_id());
 		(void)ctx;
 
 		NETP_ASSERT(m_wstate == netp::rpc_write_state::S_WRITE_CLOSED);
 
+		m_reply_q.insert(m_reply_q.begin(), m_replying_q.begin(), m_replying_q.end());
+		rpc_message_reply_queue_t().swap(m_replying_q);
 		while (m_reply_q.size()) {
 			NRP<netp::rpc_message>& reply = m_reply_q.front();
-			NETP_WARN("[rpc]cancel reply, id: %d, code: %d, nbytes: %d", reply->id, reply->code, reply->data->len());
+			NETP_WARN("[rpc]cancel reply, id: %d, code: %d, nbytes: %d", reply->id, reply->code, reply->data == nullptr ? 0 : reply->data->len());
 			m_reply_q.pop_front();
 		}
 
+		m_write_list.splice(m_write_list.begin(), m_writing_list);
 		while (m_write_list.size()) {
 			NRP<netp::rpc_req_message>& req = m_write_list.front();
 			if (req->m->type == rpc_message_type::T_REQ) {
@@ -329,7 +362,7 @@ namespace netp {
 	}
 
 	void rpc::error(NRP<netp::channel_handler_context> const& ctx, int err) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		NETP_ERR("[rpc][#%u]rpc error: %d", ctx->ch->ch_id(), err );
 		NETP_ASSERT(m_close_promise == nullptr);
 		invoke<fn_rpc_activity_notify_error_t>(E_RPC_ERROR, NRP<rpc>(this), err );
@@ -339,7 +372,7 @@ namespace netp {
 	}
 
 	void rpc::read_closed(NRP<netp::channel_handler_context> const& ctx) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
 		TRACE_RPC("[rpc][#%u]read closed, close ch", ctx->ch->ch_id());
 		ctx->close();
 	}
@@ -350,8 +383,20 @@ namespace netp {
 		ctx->close();
 	}
 
+	void rpc::read_complete(NRP<netp::channel_handler_context> const& ctx) {
+		NETP_ASSERT(m_loop_binding->in_event_loop());
+		m_read_complete_seen = true;
+		m_flush_deferred = false;
+		if (m_wstate == rpc_write_state::S_WRITE_IDLE) {
+			_do_flush();
+		}
+		ctx->fire_read_complete();
+	}
+
 	void rpc::read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income) {
-		NETP_ASSERT(m_loop->in_event_loop());
+		NETP_ASSERT(m_loop_binding->in_event_loop());
+		//a transport without read_complete flushes at once
+		m_flush_deferred = m_read_complete_seen;
 		NRP<rpc_message> in;
 		int rt = rpc_message::from_packet(income,in);
 
@@ -447,12 +492,16 @@ namespace netp {
 		}
 	}
 
-	rpc::rpc(NRP<netp::io_event_loop> const& L):
-		channel_handler_abstract(netp::CH_ACTIVITY|netp::CH_INBOUND_READ),
-		m_loop(L),
+	rpc::rpc(NRP<netp::channel> const& ch):
+		channel_handler_abstract(netp::CH_ACTIVITY|netp::CH_INBOUND_READ|netp::CH_INBOUND_READ_COMPLETE|netp::CH_ACTIVITY_LOOP_MIGRATED),
+		m_loop_binding(ch->ch_loop_binding()),
 		m_wstate(rpc_write_state::S_WRITE_CLOSED),
 		m_fn_on_push(nullptr),
-		m_queue_size(NETP_RPC_QUEUE_SIZE)
+		m_queue_size(NETP_RPC_QUEUE_SIZE),
+		m_read_complete_seen(false),
+		m_flush_deferred(false),
+		m_write_blocked(false),
+		m_tm_seq(0)
 	{
 	}
 
@@ -471,7 +520,7 @@ namespace netp {
 
 	NRP<netp::promise<int>> rpc::close() {
 		NRP<netp::promise<int>> tf = netp::make_ref<netp::promise<int>>();
-		m_loop->execute([R = NRP<netp::rpc>(this), tf](){
+		m_loop_binding->execute([R = NRP<netp::rpc>(this), tf](){
 			R->_do_close(tf);
 		});
 		return tf;
@@ -487,7 +536,7 @@ namespace netp {
 			NRP<netp::channel_handler_abstract> h_hlen = netp::make_ref<netp::handler::hlen>();
 			ch->pipeline()->add_last(h_hlen);
 
-			NRP<netp::rpc> rpc = netp::make_ref<netp::rpc>(ch->L);
+			NRP<netp::rpc> rpc = netp::make_ref<netp::rpc>(ch);
 			ch->pipeline()->add_last(rpc);
 
 			if (fn_notify_err != nullptr) {
@@ -218,6 +218,13 @@ int socket_base::get_left_snd_queue() const {
 	}
 
 	void socket_channel::_tmcb_BDL(NRP<timer> const& t) {
+		if (NETP_UNLIKELY(!m_loop_binding->in_event_loop())) {
+			//launched by the loop we migrated from, continue in the current loop
+			m_loop_binding->execute([so = NRP<socket_channel>(this), t]() {
+				so->_tmcb_BDL(t);
+			});
+			return;
+		}
 		NETP_ASSERT(L->in_event_loop());
 		NETP_ASSERT(m_outbound_limit > 0);
 		NETP_ASSERT(m_chflag&int(channel_flag::F_BDLIMIT_TIMER) );
@@ -243,6 +250,10 @@ int socket_base::get_left_snd_queue() const {
 		if (m_chflag & int(channel_flag::F_BDLIMIT)) {
 			NETP_ASSERT( !(m_chflag & (int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE))));
 			m_chflag &= ~int(channel_flag::F_BDLIMIT);
+			if (m_chflag & int(channel_flag::F_MIGRATING)) {
+				//__ch_do_migrate_done would flush the outbound entries
+				return;
+			}
 
 #ifdef NETP_ENABLE_FAST_WRITE
 			m_chflag |= int(channel_flag::F_WRITE_BARRIER);
@@ -254,13 +265,9 @@ int socket_base::get_left_snd_queue() const {
 		}
 	}
 
-	void socket_channel::do_listen_on(NRP<promise<int>> const& intp, NRP<address> const& addr, fn_channel_initializer_t const& fn_accepted_initializer, NRP<socket_cfg> const& listener_cfg, int backlog ) {
-		if (!L->in_event_loop()) {
-			L->schedule([_this=NRP<socket_channel>(this), addr, fn_accepted_initializer, intp, listener_cfg, backlog]() ->void {
-				_this->do_listen_on(intp, addr, fn_accepted_initializer, listener_cfg, backlog);
-			});
-			return;
-		}
+	void socket_channel::do_listen_on(NRP<loop_promise<int>> const& intp, NRP<address> const& addr, fn_channel_initializer_t const& fn_accepted_initializer, NRP<socket_cfg> const& listener_cfg, int backlog ) {
+		//intp is loop local
+		NETP_ASSERT(L->in_event_loop());
 
 		//int rt = -10043;
 		int rt = socket_channel::bind(addr);
@@ -298,7 +305,7 @@ int socket_base::get_left_snd_queue() const {
 		});
 	}
 
-	void socket_channel::do_dial(NRP<promise<int>> const& dialp, NRP<address> const& addr, fn_channel_initializer_t const& fn_initializer ) {
+	void socket_channel::do_dial(NRP<loop_promise<int>> const& dialp, NRP<address> const& addr, fn_channel_initializer_t const& fn_initializer ) {
 		NETP_ASSERT(L->in_event_loop());
 		ch_io_begin([dialp, so=NRP<socket_channel>(this),addr, fn_initializer](int status, io_ctx*) {
 			NETP_ASSERT(so->L->in_event_loop());
@@ -341,9 +348,9 @@ int socket_base::get_left_snd_queue() const {
 		return socket_accept_impl(raddr, laddr);
 	}
 
-	void socket_channel::__do_io_dial_done(fn_channel_initializer_t const& fn_initializer, NRP<promise<int>> const& dialp_, int status, io_ctx*) {
+	void socket_channel::__do_io_dial_done(fn_channel_initializer_t const& fn_initializer, NRP<loop_promise<int>> const& dialp_, int status, io_ctx*) {
 		NETP_ASSERT(L->in_event_loop());
-		NRP<promise<int>> dialp = dialp_;
+		NRP<loop_promise<int>> dialp = dialp_;
 
 		if (status != netp::OK) {
 		_set_fail_and_return:
@@ -351,7 +358,7 @@ int socket_base::get_left_snd_queue() const {
 			m_chflag |= int(channel_flag::F_WRITE_ERROR);
 			m_cherrno = status;
 			ch_io_end_connect();
-			ch_close_impl(netp::make_ref<netp::promise<int>>());
+			ch_close_impl(nullptr);
 			NETP_ERR("[socket][%s]socket dial error: %d", ch_info().c_str(), status);
 			dialp->set(status);
 			return;
@@ -450,8 +457,14 @@ int socket_base::get_left_snd_queue() const {
 				}
 			}
 			
+			if (NETP_UNLIKELY(channel_mem_budget_exceeds())) {
+				NETP_WARN("[socket][%s]accept, reject for memory budget, buffered bytes: %llu", ch_info().c_str(), (unsigned long long)channel_mem_budget_used());
+				NETP_CLOSE_SOCKET(nfd);
+				continue;
+			}
+
 			NRP<io_event_loop> LL = io_event_loop_group::instance()->next(L->poller_type());
-			LL->execute([LL,fn_initializer,nfd, laddr, raddr, listener_cfg]() {
+			auto fn_accepted = [LL,fn_initializer,nfd, laddr, raddr, listener_cfg]() {
 				NRP<socket_cfg> cfg_ = netp::make_ref<socket_cfg>();
 				cfg_->fd = nfd;
 				cfg_->family = listener_cfg->family;
@@ -474,7 +487,13 @@ int socket_base::get_left_snd_queue() const {
 				}
 				NETP_ASSERT(so != nullptr);
 				so->__do_accept_fire(fn_initializer);
-			});
+			};
+			//@note: no std::function for a fd accepted by its own loop
+			if (LL->in_event_loop()) {
+				fn_accepted();
+			} else {
+				LL->schedule(std::move(fn_accepted));
+			}
 		}
 
 		if (netp::E_EWOULDBLOCK==(status)) {
@@ -496,14 +515,19 @@ int socket_base::get_left_snd_queue() const {
 
 	void socket_channel::__do_io_read_from(int status, io_ctx* ) {
 		NETP_ASSERT(m_protocol == u8_t(NETP_PROTOCOL_UDP));
+		u32_t nread = 0;
 		while (status == netp::OK) {
 			NETP_ASSERT((m_chflag & (int(channel_flag::F_READ_SHUTDOWNING))) == 0);
-			if (NETP_UNLIKELY(m_chflag & (int(channel_flag::F_READ_SHUTDOWN) | int(channel_flag::F_CLOSE_PENDING)/*ignore the left read buffer, cuz we're closing it*/))) { return; }
+			if (NETP_UNLIKELY(m_chflag & (int(channel_flag::F_READ_SHUTDOWN) | int(channel_flag::F_CLOSE_PENDING)/*ignore the left read buffer, cuz we're closing it*/))) { break; }
 			netp::u32_t nbytes = socket_recvfrom_impl(m_rcv_buf_ptr, m_rcv_buf_size, m_raddr, status);
 			if (NETP_LIKELY(nbytes > 0)) {
 				channel::ch_fire_readfrom(netp::make_ref<netp::packet>(m_rcv_buf_ptr, nbytes), m_raddr) ;
+				++nread;
 			}
 		}
+		if (nread > 0) {
+			channel::ch_fire_read_complete();
+		}
 		___do_io_read_done(status);
 	}
 
@@ -513,14 +537,22 @@ int socket_base::get_left_snd_queue() const {
 		NETP_ASSERT(!ch_is_listener());
 
 		//in case socket object be destructed during ch_read
+		u32_t nread = 0;
 		while (status == netp::OK) {
 			NETP_ASSERT( (m_chflag&(int(channel_flag::F_READ_SHUTDOWNING))) == 0);
-			if (NETP_UNLIKELY(m_chflag & (int(channel_flag::F_READ_SHUTDOWN)|int(channel_flag::F_READ_ERROR) | int(channel_flag::F_CLOSE_PENDING) | int(channel_flag::F_CLOSING)/*ignore the left read buffer, cuz we're closing it*/))) { return; }
+			if (NETP_UNLIKELY(m_chflag & (int(channel_flag::F_READ_SHUTDOWN)|int(channel_flag::F_READ_ERROR) | int(channel_flag::F_CLOSE_PENDING) | int(channel_flag::F_CLOSING)/*ignore the left read buffer, cuz we're closing it*/))) { break; }
 			netp::u32_t nbytes = socket_recv_impl(m_rcv_buf_ptr, m_rcv_buf_size, status);
 			if (NETP_LIKELY(nbytes > 0)) {
 				channel::ch_fire_read(netp::make_ref<netp::packet>(m_rcv_buf_ptr, nbytes));
+				++nread;
+				if (NETP_UNLIKELY(ch_mem_out_exceeds()) && ch_mem_pause_read()) {
+					break;
+				}
 			}
 		}
+		if (nread > 0) {
+			channel::ch_fire_read_complete();
+		}
 		___do_io_read_done(status);
 	}
 
@@ -562,6 +594,10 @@ int socket_base::get_left_snd_queue() const {
 		int _errno = netp::OK;
 		while ( _errno == netp::OK && m_outbound_entry_q.size() ) {
 			NETP_ASSERT( (m_noutbound_bytes) > 0);
+			if (m_outbound_limit == 0 && m_outbound_entry_q.size() > 1) {
+				_errno = ___do_io_writev();
+				continue;
+			}
 			socket_outbound_entry& entry = m_outbound_entry_q.front();
 			u32_t dlen = u32_t(entry.data->len());
 			u32_t wlen = (dlen);
@@ -577,6 +613,7 @@ int socket_base::get_left_snd_queue() const {
 			netp::u32_t nbytes = socket_send_impl( entry.data->head(), u32_t(wlen), _errno);
 			if (NETP_LIKELY(nbytes > 0)) {
 				m_noutbound_bytes -= nbytes;
+				ch_mem_release(nbytes);
 				if (m_outbound_limit != 0 ) {
 					m_outbound_budget -= nbytes;
 
@@ -588,7 +625,7 @@ int socket_base::get_left_snd_queue() const {
 
 				if (NETP_LIKELY(nbytes == dlen)) {
 					NETP_ASSERT(_errno == netp::OK);
-					entry.write_promise->set(netp::OK);
+					if (entry.write_promise != nullptr) { entry.write_promise->set(netp::OK); }
 					m_outbound_entry_q.pop_front();
 				} else {
 					entry.data->skip(nbytes); //ewouldblock or bdlimit
@@ -599,6 +636,38 @@ int socket_base::get_left_snd_queue() const {
 		return _errno;
 	}
 
+	//gather the queued entries into one syscall, no bdlimit
+	int socket_channel::___do_io_writev() {
+		NETP_ASSERT(m_outbound_limit == 0);
+		iov_t iov[NETP_SOCKET_SENDV_IOV_MAX];
+		u32_t n = 0;
+		socket_outbound_entry_t::iterator it = m_outbound_entry_q.begin();
+		while (it != m_outbound_entry_q.end() && n < NETP_SOCKET_SENDV_IOV_MAX) {
+			iov_set(iov[n++], it->data->head(), u32_t(it->data->len()));
+			++it;
+		}
+
+		int _errno = netp::OK;
+		netp::u32_t nbytes = socket_sendv_impl(iov, n, _errno);
+		NETP_ASSERT(nbytes <= m_noutbound_bytes);
+		m_noutbound_bytes -= nbytes;
+		ch_mem_release(nbytes);
+		while (nbytes > 0) {
+			socket_outbound_entry& entry = m_outbound_entry_q.front();
+			const u32_t dlen = u32_t(entry.data->len());
+			if (nbytes < dlen) {
+				entry.data->skip(nbytes);
+				break;
+			}
+			nbytes -= dlen;
+			//the promise might write more, it's queued at the back
+			NRP<promise<int>> wp = std::move(entry.write_promise);
+			m_outbound_entry_q.pop_front();
+			if (wp != nullptr) { wp->set(netp::OK); }
+		}
+		return _errno;
+	}
+
 	int socket_channel::___do_io_write_to() {
 
 		NETP_ASSERT(m_outbound_entry_q.size(), "%s, flag: %u", ch_info().c_str(), m_chflag);
@@ -615,7 +684,8 @@ int socket_base::get_left_snd_queue() const {
 			//hold a copy before we do pop it from queue
 			nbytes == entry.data->len() ? NETP_ASSERT(_errno == netp::OK):NETP_ASSERT(_errno != netp::OK);
 			m_noutbound_bytes -= u32_t(entry.data->len());
-			entry.write_promise->set(_errno);
+			ch_mem_release(u32_t(entry.data->len()));
+			if (entry.write_promise != nullptr) { entry.write_promise->set(_errno); }
 			m_outbound_entry_q.pop_front();
 		}
 		return _errno;
@@ -657,6 +727,13 @@ int socket_base::get_left_snd_queue() const {
 
 	void socket_channel::ch_close_read_impl(NRP<promise<int>> const& closep) {
 		NETP_ASSERT(L->in_event_loop());
+		if (NETP_UNLIKELY(m_chflag & int(channel_flag::F_MIGRATING))) {
+			//retry after __ch_do_migrate_done
+			L->schedule([so = NRP<socket_channel>(this), closep]() {
+				so->ch_close_read_impl(closep);
+			});
+			return;
+		}
 		NETP_TRACE_SOCKET("[socket][%s]ch_close_read_impl, _ch_do_close_read, errno: %d, flag: %d", ch_info().c_str(), ch_errno(), m_chflag);
 		int prt = netp::OK;
 		if ((m_chflag & int(channel_flag::F_READ_SHUTDOWN)) != 0) {
@@ -674,6 +751,13 @@ int socket_base::get_left_snd_queue() const {
 	//if there is no erorr, just pending shutdown
 	void socket_channel::ch_close_write_impl(NRP<promise<int>> const& closep) {
 		NETP_ASSERT(L->in_event_loop());
+		if (NETP_UNLIKELY(m_chflag & int(channel_flag::F_MIGRATING))) {
+			//retry after __ch_do_migrate_done
+			L->schedule([so = NRP<socket_channel>(this), closep]() {
+				so->ch_close_write_impl(closep);
+			});
+			return;
+		}
 		NETP_ASSERT(!ch_is_listener());
 		int prt = netp::OK;
 		if (m_chflag & int(channel_flag::F_WRITE_SHUTDOWN)) {
@@ -709,6 +793,13 @@ int socket_base::get_left_snd_queue() const {
 	//ERROR FIRST
 	void socket_channel::ch_close_impl(NRP<promise<int>> const& closep) {
 		NETP_ASSERT(L->in_event_loop());
+		if (NETP_UNLIKELY(m_chflag & int(channel_flag::F_MIGRATING))) {
+			//retry after __ch_do_migrate_done
+			L->schedule([so = NRP<socket_channel>(this), closep]() {
+				so->ch_close_impl(closep);
+			});
+			return;
+		}
 		int prt = netp::OK;
 		if (m_chflag&int(channel_flag::F_CLOSED)) {
 			prt = (netp::E_CHANNEL_CLOSED);
@@ -746,9 +837,9 @@ __act_label_close_read_write:
 		if (closep) { closep->set(prt); }
 	}
 
+//a void write (chp->is_void()) rejected here is dropped, the channel is on its close path already, set() on it does nothing
 #define __CH_WRITEABLE_CHECK__( outlet, chp)  \
 		NETP_ASSERT(outlet->len() > 0); \
-		NETP_ASSERT(chp != nullptr); \
  \
 		if (m_chflag&(int(channel_flag::F_READ_ERROR) | int(channel_flag::F_WRITE_ERROR))) { \
 			chp->set(netp::E_CHANNEL_READ_WRITE_ERROR); \
@@ -767,10 +858,15 @@ __act_label_close_read_write:
  \
 		const u32_t outlet_len = (u32_t)outlet->len(); \
 		/*set the threshold arbitrarily high, the writer have to check the return value if */ \
-		if ( (m_noutbound_bytes > 0) && ( (m_noutbound_bytes + outlet_len) > /*m_sock_buf.sndbuf_size,*/u32_t(channel_buf_range::CH_BUF_SND_MAX_SIZE))) { \
+		/*the memory budget blocks the writer who could back off only, the reads of a void writer are paused instead*/ \
+		if ( (m_noutbound_bytes > 0) && ( ((m_noutbound_bytes + outlet_len) > /*m_sock_buf.sndbuf_size,*/u32_t(channel_buf_range::CH_BUF_SND_MAX_SIZE)) || \
+			(!chp->is_void() && ch_mem_exceeds(outlet_len)) )) { \
 			NETP_ASSERT(m_noutbound_bytes > 0); \
-			NETP_ASSERT(m_chflag&(int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE))); \
-			chp->set(netp::E_CHANNEL_WRITE_BLOCK); \
+			NETP_ASSERT(m_chflag&(int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE)|int(channel_flag::F_BDLIMIT)|int(channel_flag::F_MIGRATING))); \
+			if (!chp->is_void()) { chp->set(netp::E_CHANNEL_WRITE_BLOCK); return; } \
+			/*a void writer could not back off, dropping one in the middle would corrupt the stream*/ \
+			NETP_WARN("[socket][%s]void write blocked, outbound bytes: %u, close", ch_info().c_str(), m_noutbound_bytes); \
+			ch_close_impl(nullptr); \
 			return; \
 		} \
 
@@ -782,11 +878,12 @@ __act_label_close_read_write:
 		NETP_ASSERT( (m_chflag& (int(channel_flag::F_WATCH_WRITE) | int(channel_flag::F_BDLIMIT))) ? m_outbound_entry_q.size() : true, "[#%s]flag: %d, errno: %d", ch_info().c_str(), m_chflag, m_cherrno);
 		m_outbound_entry_q.push_back({
 			netp::make_ref<netp::non_atomic_ref_packet>(outlet->head(), outlet_len,0),
-			intp
+			intp->is_void() ? nullptr : intp
 		});
 		m_noutbound_bytes += outlet_len;
+		ch_mem_charge(outlet_len);
 
-		if (m_chflag&(int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE)|int(channel_flag::F_BDLIMIT))) {
+		if (m_chflag&(int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE)|int(channel_flag::F_BDLIMIT)|int(channel_flag::F_MIGRATING))) {
 			return;
 		}
 
@@ -806,12 +903,13 @@ __act_label_close_read_write:
 		__CH_WRITEABLE_CHECK__(outlet, intp)
 		m_outbound_entry_q.push_back({
 			netp::make_ref<netp::non_atomic_ref_packet>(outlet->head(), outlet_len,0),
-			intp,
+			intp->is_void() ? nullptr : intp,
 			to,
 		});
 		m_noutbound_bytes += outlet_len;
+		ch_mem_charge(outlet_len);
 
-		if (m_chflag & (int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE)) ) {
+		if (m_chflag & (int(channel_flag::F_WRITE_BARRIER)|int(channel_flag::F_WATCH_WRITE)|int(channel_flag::F_MIGRATING)) ) {
 			return;
 		}
 
@@ -825,6 +923,100 @@ __act_label_close_read_write:
 #endif
 	}
 
+	void socket_channel::ch_migrate_to_impl(NRP<promise<int>> const& intp, NRP<io_event_loop> const& to) {
+		NETP_ASSERT(L->in_event_loop());
+		if (to == L) {
+			intp->set(netp::OK);
+			return;
+		}
+		if (to == nullptr || to->poller_type() != L->poller_type()) {
+			intp->set(netp::E_INVALID_OPERATION);
+			return;
+		}
+		if (m_chflag & (int(channel_flag::F_MIGRATING) | int(channel_flag::F_WRITE_BARRIER))) {
+			intp->set(netp::E_OP_INPROCESS);
+			return;
+		}
+
+		const int _unmovable = int(channel_flag::F_CLOSED) | int(channel_flag::F_CLOSING) | int(channel_flag::F_CLOSE_PENDING) |
+			int(channel_flag::F_READ_SHUTDOWNING) | int(channel_flag::F_WRITE_SHUTDOWNING) | int(channel_flag::F_WRITE_SHUTDOWN_PENDING) |
+			int(channel_flag::F_READ_ERROR) | int(channel_flag::F_WRITE_ERROR) | int(channel_flag::F_FIRE_ACT_EXCEPTION) |
+			int(channel_flag::F_CONNECTING) | int(channel_flag::F_LISTENING) | int(channel_flag::F_IO_EVENT_LOOP_NOTIFY_TERMINATING);
+
+		//user defined io functions are bound to the old loop, we do not move them
+		if ( (m_chflag&_unmovable) || ((m_chflag & int(channel_flag::F_IO_EVENT_LOOP_BEGIN_DONE)) == 0) ||
+			((m_chflag & int(channel_flag::F_WATCH_READ)) && ((m_chflag & int(channel_flag::F_USE_DEFAULT_READ)) == 0)) ||
+			((m_chflag & int(channel_flag::F_WATCH_WRITE)) && ((m_chflag & int(channel_flag::F_USE_DEFAULT_WRITE)) == 0))
+		) {
+			intp->set(netp::E_CHANNEL_INVALID_STATE);
+			return;
+		}
+
+		const bool rewatch_read = (m_chflag & int(channel_flag::F_WATCH_READ)) != 0;
+		ch_io_end_read();
+		ch_io_end_write();
+		L->io_end(m_io_ctx);
+		m_io_ctx = 0;
+		m_chflag &= ~int(channel_flag::F_IO_EVENT_LOOP_BEGIN_DONE);
+		m_chflag |= int(channel_flag::F_MIGRATING);
+
+		m_rcv_buf_ptr = to->channel_rcv_buf()->head();
+		m_rcv_buf_size = u32_t(to->channel_rcv_buf()->left_right_capacity());
+		NETP_TRACE_SOCKET("[socket][%s]migrating, outbound bytes: %u", ch_info().c_str(), m_noutbound_bytes);
+
+		//the channel is not ours anymore once rebound, <to> might be running it already
+		NRP<io_event_loop> from = L;
+		ch_rebind_loop(to);
+		to->schedule([so = NRP<socket_channel>(this), intp, from, rewatch_read]() {
+			so->__ch_do_migrate_done(intp, from, rewatch_read);
+		});
+	}
+
+	void socket_channel::__ch_do_migrate_done(NRP<promise<int>> const& intp, NRP<io_event_loop> const& from, bool rewatch_read) {
+		NETP_ASSERT(L->in_event_loop());
+		NETP_ASSERT(m_chflag & int(channel_flag::F_MIGRATING));
+		m_chflag &= ~int(channel_flag::F_MIGRATING);
+
+		m_io_ctx = L->io_begin(m_fd, NRP<io_monitor>(this));
+		if (m_io_ctx == 0) {
+			m_chflag |= int(channel_flag::F_READ_ERROR);
+			ch_errno() = netp::E_IO_BEGIN_FAILED;
+			ch_close_impl(nullptr);
+			intp->set(netp::E_IO_BEGIN_FAILED);
+			return;
+		}
+		__io_begin_done(m_io_ctx);
+
+		if (L->cfg().sock_busy_poll != from->cfg().sock_busy_poll) {
+			int rt = _cfg_busy_poll(L->cfg().sock_busy_poll);
+			if (rt != netp::OK) {
+				NETP_WARN("[socket][%s]cfg busy poll failed: %d", ch_info().c_str(), rt);
+			}
+		}
+
+		__ch_fire_loop_migrated(from);
+		if (m_chflag & int(channel_flag::F_FIRE_ACT_EXCEPTION)) {
+			intp->set(ch_errno());
+			return;
+		}
+
+		if (rewatch_read) {
+			ch_io_read();
+		}
+
+		if (m_outbound_entry_q.size() && ((m_chflag & (int(channel_flag::F_WRITE_BARRIER) | int(channel_flag::F_WATCH_WRITE) | int(channel_flag::F_BDLIMIT))) == 0)) {
+#ifdef NETP_ENABLE_FAST_WRITE
+			m_chflag |= int(channel_flag::F_WRITE_BARRIER);
+			__do_io_write(netp::OK, m_io_ctx);
+			m_chflag &= ~int(channel_flag::F_WRITE_BARRIER);
+#else
+			ch_io_write();
+#endif
+		}
+		NETP_TRACE_SOCKET("[socket][%s]migrate done", ch_info().c_str());
+		intp->set(netp::OK);
+	}
+
 	void socket_channel::io_notify_terminating(int status, io_ctx* ctx_) {
 		NETP_ASSERT(L->in_event_loop());
 		NETP_ASSERT(status == netp::E_IO_EVENT_LOOP_NOTIFY_TERMINATING);
@@ -934,6 +1126,7 @@ __act_label_close_read_write:
 				return;
 			}
 			NETP_ASSERT((m_chflag & int(channel_flag::F_READ_SHUTDOWNING)) == 0);
+			m_chflag &= ~int(channel_flag::F_MEM_PAUSED);
 			if (m_chflag & int(channel_flag::F_WATCH_READ)) {
 				NETP_TRACE_SOCKET("[socket][%s]io_action::READ, ignore, flag: %d", ch_info().c_str(), m_chflag);
 				return;
@@ -970,6 +1163,7 @@ __act_label_close_read_write:
 				return;
 			}
 
+			m_chflag &= ~int(channel_flag::F_MEM_PAUSED);
 			if ((m_chflag & int(channel_flag::F_WATCH_READ))) {
 				L->io_do(io_action::END_READ, m_io_ctx);
 				m_chflag &= ~(int(channel_flag::F_USE_DEFAULT_READ) | int(channel_flag::F_WATCH_READ));
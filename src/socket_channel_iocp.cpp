@@ -195,6 +195,8 @@ namespace netp {
 		if (NETP_LIKELY(status) > 0) {
 			NETP_ASSERT(ULONG(status) <= ctx->ol_r->wsabuf.len);
 			channel::ch_fire_read(netp::make_ref<netp::packet>(ctx->ol_r->wsabuf.buf, status));
+			//one completion, one round
+			channel::ch_fire_read_complete();
 			status = netp::OK;
 		}
 		else if (status == 0) {
@@ -241,9 +243,10 @@ namespace netp {
 		socket_outbound_entry entry = m_outbound_entry_q.front();
 		NETP_ASSERT(entry.data != nullptr);
 		m_noutbound_bytes -= status;
+		ch_mem_release(u32_t(status));
 		entry.data->skip(status);
 		if (entry.data->len() == 0) {
-			entry.write_promise->set(netp::OK);
+			if (entry.write_promise != nullptr) { entry.write_promise->set(netp::OK); }
 			m_outbound_entry_q.pop_front();
 		}
 		status = netp::OK;
@@ -92,7 +92,7 @@ namespace netp {
 			return;
 		}
 
-		NRP<promise<int>> so_dialp = netp::make_ref<promise<int>>();
+		NRP<loop_promise<int>> so_dialp = netp::make_ref<loop_promise<int>>();
 		NRP<socket_channel> so = std::get<1>(tupc);
 		so_dialp->if_done([ch_dialf, so](int const& rt) {
 			NETP_ASSERT( so->L->in_event_loop() );
@@ -193,7 +193,7 @@ namespace netp {
 		}
 
 		NRP<socket_channel> so = std::get<1>(tupc);
-		NRP<promise<int>> listen_f = netp::make_ref<promise<int>>();
+		NRP<loop_promise<int>> listen_f = netp::make_ref<loop_promise<int>>();
 		listen_f->if_done([listenp, so](int const& rt) {
 			if (rt == netp::OK) {
 				listenp->set(std::make_tuple(netp::OK, so));
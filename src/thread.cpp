@@ -24,8 +24,9 @@ namespace netp {
 		tls_set<impl::thread_data>(th_data);
 
 #ifdef NETP_MEMORY_USE_TLS_POOL
-		netp::global_pool_aligned_allocator::instance()->incre_thread_count();
-		tls_create<netp::pool_aligned_allocator_t>();
+		netp::pool_aligned_allocator_t* allocator = tls_create<netp::pool_aligned_allocator_t>();
+		netp::global_pool_aligned_allocator::instance()->incre_thread_count(allocator->node());
+		netp::global_pool_aligned_allocator::instance()->stat_attach(allocator);
 #endif
 
 #if defined(_DEBUG_MUTEX) || defined(_DEBUG_SHARED_MUTEX)
@@ -80,8 +81,11 @@ namespace netp {
 		tls_set<impl::thread_data>(nullptr);
 		NETP_TRACE_THREAD("[thread]__POST_RUN_PROXY__");
 #ifdef NETP_MEMORY_USE_TLS_POOL
+		netp::pool_aligned_allocator_t* allocator = tls_get<netp::pool_aligned_allocator_t>();
+		const u8_t node = allocator->node();
+		//the stat is folded by its deinit, after the remote flush
 		tls_destroy<netp::pool_aligned_allocator_t>();
-		netp::global_pool_aligned_allocator::instance()->decre_thread_count();
+		netp::global_pool_aligned_allocator::instance()->decre_thread_count(node);
 #endif
 	}
 
@@ -10,14 +10,15 @@ namespace netp {
 			m_tq.pop_front();
 		}
 
+		const timer_timepoint_t now = timer_clock_t::now();
 		while (!m_heap.empty()) {
 			NRP<timer>& tm = m_heap.front();
-			tm->invoke(true);
+			tm->invoke(now, true);
 			m_heap.pop();
 		}
 	}
 
-	void timer_broker::expire(timer_duration_t& ndelay) {
+	void timer_broker::expire(timer_duration_t& ndelay, timer_timepoint_t const& now) {
 		const bool shrink_or_not = m_tq.size() > NETP_TM_INIT_CAPACITY;
 		while (!m_tq.empty()) {
 			NRP<timer>& tm = m_tq.front();
@@ -30,7 +31,7 @@ namespace netp {
 
 		while (!m_heap.empty()) {
 			NRP<timer>& tm = m_heap.front();
-			ndelay = tm->invoke();
+			ndelay = tm->invoke(now);
 			if (ndelay.count() > 0) {
 				goto _recalc_nexpire;
 			} else {
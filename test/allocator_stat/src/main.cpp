@@ -0,0 +1,58 @@
+#include <netp.hpp>
+#include <vector>
+
+//mixed sizes, keep a window of live blocks to exercise tls slots, global borrow/commit and large allocation
+void alloc_free_round(int count, size_t window) {
+	std::vector<netp::byte_t*> live;
+	live.reserve(window);
+	for (int i = 0; i < count; ++i) {
+		size_t size = 16 + (std::rand() % 4096);
+		if ((i % 1000) == 0) {
+			size = 4 * 1024 * 1024;
+		}
+		live.push_back(netp::allocator<netp::byte_t>::malloc(size));
+		if (live.size() == window) {
+			for (size_t j = 0; j < window; ++j) {
+				netp::allocator<netp::byte_t>::free(live[j]);
+			}
+			live.clear();
+		}
+	}
+	for (size_t j = 0; j < live.size(); ++j) {
+		netp::allocator<netp::byte_t>::free(live[j]);
+	}
+}
+
+void th_run() {
+	alloc_free_round(200000, 4096);
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	std::vector<NRP<netp::thread>> ths;
+	for (int i = 0; i < 4; ++i) {
+		NRP<netp::thread> th = netp::make_ref<netp::thread>();
+		th->start(&th_run);
+		ths.push_back(th);
+	}
+	alloc_free_round(100000, 256);
+
+	netp::allocator_stat st;
+	netp::allocator_stat_collect(st);
+	//dump might exceed the log line limit
+	printf("[allocator_stat]with %u worker running\n%s", (netp::u32_t)ths.size(), netp::allocator_stat_dump(st).c_str());
+
+	for (size_t i = 0; i < ths.size(); ++i) {
+		ths[i]->join();
+	}
+
+	netp::allocator_stat_collect(st);
+	printf("[allocator_stat]all worker exited\n%s", netp::allocator_stat_dump(st).c_str());
+
+	const size_t trimmed = netp::allocator_trim();
+	netp::allocator_stat_collect(st);
+	printf("[allocator_stat]trimmed: %llu bytes\n%s", (unsigned long long)trimmed, netp::allocator_stat_dump(st).c_str());
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <netp.hpp>
+#include <vector>
+#include <deque>
+
+//producers allocate, consumers free, so the tls slots of producers run dry (borrow, pop a batch)
+//and the ones of consumers overflow (commit, push a batch), while a trimmer pops every batch of every class
+//a batch handed out twice shows up as a block owned by two threads, the tag written on malloc is checked on free
+
+static const size_t sizes[] = { 32, 128, 512, 2048, 8192 };
+static const netp::u32_t SIZE_COUNT = sizeof(sizes) / sizeof(sizes[0]);
+
+struct block {
+	netp::u64_t* p;
+	netp::u32_t size;
+};
+
+struct channel_q {
+	netp::spin_mutex mtx;
+	std::deque<std::vector<block>> q;
+	bool producer_done = false;
+};
+
+std::atomic<bool> g_stop(false);
+std::atomic<netp::u64_t> g_blocks(0);
+std::atomic<netp::u64_t> g_bad(0);
+
+static __NETP_FORCE_INLINE netp::u64_t tag_of(netp::u64_t owner, netp::u64_t seq) { return (owner << 48) | seq; }
+
+void produce(netp::u32_t owner, channel_q* cq) {
+	netp::u64_t seq = 0;
+	while (!g_stop.load(std::memory_order_relaxed)) {
+		std::vector<block> bs;
+		bs.reserve(256);
+		for (int i = 0; i < 256; ++i) {
+			const netp::u32_t size = netp::u32_t(sizes[(seq + i) % SIZE_COUNT]);
+			netp::u64_t* p = (netp::u64_t*)netp::allocator<netp::byte_t>::malloc(size);
+			const netp::u64_t tag = tag_of(owner, ++seq);
+			p[0] = tag;
+			p[(size / sizeof(netp::u64_t)) - 1] = tag;
+			bs.push_back({ p, size });
+		}
+		netp::lock_guard<netp::spin_mutex> lg(cq->mtx);
+		if (cq->q.size() > 64) {
+			//the consumers lag behind, free them here
+			for (block const& b : bs) {
+				netp::allocator<netp::byte_t>::free((netp::byte_t*)b.p);
+			}
+			continue;
+		}
+		cq->q.push_back(std::move(bs));
+	}
+	netp::lock_guard<netp::spin_mutex> lg(cq->mtx);
+	cq->producer_done = true;
+}
+
+void consume(channel_q* cq) {
+	for (;;) {
+		std::vector<block> bs;
+		{
+			netp::lock_guard<netp::spin_mutex> lg(cq->mtx);
+			if (!cq->q.empty()) {
+				bs = std::move(cq->q.front());
+				cq->q.pop_front();
+			} else if (cq->producer_done) {
+				return;
+			}
+		}
+		for (block const& b : bs) {
+			const netp::u64_t tag = b.p[0];
+			if (tag != b.p[(b.size / sizeof(netp::u64_t)) - 1]) {
+				++g_bad;
+			}
+			//scribble before free, the next owner writes its own tag
+			b.p[0] = 0;
+			netp::allocator<netp::byte_t>::free((netp::byte_t*)b.p);
+		}
+		g_blocks.fetch_add(bs.size(), std::memory_order_relaxed);
+	}
+}
+
+void trim_loop() {
+	while (!g_stop.load(std::memory_order_relaxed)) {
+		netp::allocator_trim();
+		netp::allocator_decay(0);
+	}
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	const netp::u32_t pairs = 4;
+	const int seconds = (argc > 1) ? std::atoi(argv[1]) : 5;
+	std::vector<channel_q> cqs(pairs);
+	std::vector<NRP<netp::thread>> ths;
+	for (netp::u32_t i = 0; i < pairs; ++i) {
+		NRP<netp::thread> p = netp::make_ref<netp::thread>();
+		p->start(&produce, i + 1, &cqs[i]);
+		ths.push_back(p);
+		NRP<netp::thread> c = netp::make_ref<netp::thread>();
+		c->start(&consume, &cqs[i]);
+		ths.push_back(c);
+	}
+	NRP<netp::thread> trimmer = netp::make_ref<netp::thread>();
+	trimmer->start(&trim_loop);
+	ths.push_back(trimmer);
+
+	netp::this_thread::sleep(seconds * 1000);
+	g_stop.store(true, std::memory_order_relaxed);
+	for (NRP<netp::thread>& th : ths) {
+		th->join();
+	}
+	NETP_ASSERT(g_bad.load() == 0, "corrupted blocks: %llu", (unsigned long long)g_bad.load());
+
+	//pop all from the main thread, nothing is left in the stacks
+	netp::allocator_trim();
+	netp::allocator_stat st;
+	netp::allocator_stat_collect(st);
+	netp::u64_t global_cached = 0;
+	for (netp::u32_t t = 0; t < netp::TABLE::T_COUNT; ++t) {
+		for (netp::u32_t s = 0; s < NETP_ALIGNED_ALLOCATOR_SLOT_LIMIT; ++s) {
+			global_cached += st.slots[t][s].global_cached;
+		}
+	}
+	NETP_ASSERT(global_cached == 0, "global cached: %llu", (unsigned long long)global_cached);
+	NETP_ASSERT(netp::global_pool_aligned_allocator::instance()->cached_bytes() == 0);
+	printf("[allocator_transfer]ok, blocks moved across threads: %llu\n%s", (unsigned long long)g_blocks.load(), netp::allocator_stat_dump(st).c_str());
+	return 0;
+}
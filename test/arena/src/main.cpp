@@ -0,0 +1,134 @@
+#include <netp.hpp>
+
+typedef std::vector<int, netp::arena_allocator<int>> arena_vector_t;
+
+//reset() gives every block back in one go, never under a live allocation
+void test_reset() {
+	NRP<netp::arena> a = netp::make_ref<netp::arena>();
+	{
+		arena_vector_t v{ netp::arena_allocator<int>(a.get()) };
+		for (int i = 0; i < 1000; ++i) {
+			v.push_back(i);
+		}
+		netp::arena_string_t s("a string longer than the short string buffer", netp::arena_allocator<char>(a.get()));
+		//bigger than half a block, it gets a block of its own
+		void* big = a->allocate(NETP_ARENA_BLOCK_SIZE);
+		NETP_ASSERT(a->live() > 0 && a->allocated() > NETP_ARENA_BLOCK_SIZE);
+		NETP_ASSERT(a->reset() == false);
+		NETP_ASSERT(v[999] == 999 && s.length() > 0, "blocks freed under a live allocation");
+
+		a->deallocate(big, NETP_ARENA_BLOCK_SIZE);
+		NETP_ASSERT(a->reset() == false);
+	}
+	NETP_ASSERT(a->live() == 0);
+	NETP_ASSERT(a->reset() == true);
+	NETP_ASSERT(a->allocated() == 0);
+
+	//bumps from the start again
+	void* p = a->allocate(64);
+	NETP_ASSERT(p != nullptr && a->allocated() == 64);
+	a->deallocate(p, 64);
+	NETP_ASSERT(a->reset() == true);
+	NETP_INFO("[arena]reset ok");
+}
+
+//detach() moves every field to netp::allocator, the arena is free to be reset after
+void test_header_detach() {
+	NRP<netp::arena> a = netp::make_ref<netp::arena>();
+	NRP<netp::http::header> H = netp::make_ref<netp::http::header>(a);
+	H->add_header_line("Host", "127.0.0.1");
+	H->add_header_line("X-Multi", "1");
+	H->add_header_line("X-Multi", "2");
+	NETP_ASSERT(a->live() > 0);
+	NETP_ASSERT(a->reset() == false);
+
+	H->detach();
+	NETP_ASSERT(H->A == nullptr);
+	NETP_ASSERT(a->live() == 0, "live: %u", a->live());
+	NETP_ASSERT(a->reset() == true);
+	NETP_ASSERT(H->get("Host") == "127.0.0.1");
+	NETP_ASSERT(H->get("X-Multi") == "1, 2", "got: %s", H->get("X-Multi").c_str());
+
+	//it goes on with netp::allocator
+	H->add_header_line("X-After", "3");
+	H->remove("X-Multi");
+	NETP_ASSERT(!H->have("X-Multi") && H->get("X-After") == "3");
+	NETP_ASSERT(a->live() == 0);
+	H->detach();
+	NETP_INFO("[arena]header detach ok");
+}
+
+enum {
+	REQUESTS = 4,
+	KEPT = 1
+};
+
+struct request_record {
+	NRP<netp::arena> A;
+	NRP<netp::http::message> m; //the one of KEPT only
+};
+
+netp::spin_mutex g_mtx;
+std::vector<request_record> g_records;
+
+//request KEPT is held past its end, the ctx arena is left to it and the next request gets a new one
+void test_arena_release() {
+	NRP<netp::channel_listen_promise> lp = netp::listen_on("tcp://127.0.0.1:32831", [](NRP<netp::channel> const& ch) {
+		NRP<netp::handler::http> h = netp::make_ref<netp::handler::http>();
+		h->bind<netp::handler::http::fn_http_message_header_t>(netp::handler::http::http_event::E_MESSAGE_HEADER, [](NRP<netp::channel_handler_context> const& ctx, NRP<netp::http::message> const& m) {
+			NETP_ASSERT(m->H != nullptr && m->H->A == ctx->arena());
+			netp::lock_guard<netp::spin_mutex> lg(g_mtx);
+			const int n = std::atoi(m->H->get("X-N").c_str());
+			NETP_ASSERT(n == int(g_records.size()));
+			g_records.push_back({ m->H->A, (n == KEPT) ? m : nullptr });
+		});
+		ch->pipeline()->add_last(h);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<netp::channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:32831", [](NRP<netp::channel> const&) {});
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> cch = std::get<1>(dp->get());
+	for (int i = 0; i < REQUESTS; ++i) {
+		char req[128];
+		const int len = snprintf(req, sizeof(req), "GET /%d HTTP/1.1\r\nHost: 127.0.0.1\r\nX-N: %d\r\n\r\n", i, i);
+		NETP_ASSERT(cch->ch_write(netp::make_ref<netp::packet>(req, netp::u32_t(len)))->get() == netp::OK);
+		for (int k = 0; k < 5000; ++k) {
+			{
+				netp::lock_guard<netp::spin_mutex> lg(g_mtx);
+				if (g_records.size() == netp::size_t(i + 1)) { break; }
+			}
+			netp::this_thread::sleep(1);
+		}
+	}
+	cch->ch_close()->get();
+
+	netp::lock_guard<netp::spin_mutex> lg(g_mtx);
+	NETP_ASSERT(g_records.size() == REQUESTS);
+	//reset for a request nobody keeps, released for the kept one
+	NETP_ASSERT(g_records[1].A == g_records[0].A);
+	NETP_ASSERT(g_records[2].A != g_records[1].A);
+	NETP_ASSERT(g_records[3].A == g_records[2].A);
+
+	NRP<netp::http::message> const& m = g_records[KEPT].m;
+	NRP<netp::arena> const& A = g_records[KEPT].A;
+	NETP_ASSERT(m->H->A == A && A->live() > 0);
+	NETP_ASSERT(m->H->get("X-N") == "1" && m->H->get("Host") == "127.0.0.1");
+	m->H->detach();
+	NETP_ASSERT(A->live() == 0 && A->reset() == true);
+	NETP_ASSERT(m->H->get("X-N") == "1");
+
+	std::get<1>(lp->get())->ch_close()->get();
+	g_records.clear();
+	NETP_INFO("[arena]arena release ok");
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	test_reset();
+	test_header_detach();
+	test_arena_release();
+	return 0;
+}
@@ -0,0 +1,226 @@
+#include <netp.hpp>
+
+//frames are written from foreign threads while both ends are moved between two loops back and forth
+enum {
+	WRITERS = 4,
+	FRAMES = 2000,
+	MIGRATIONS = 200,
+	CALLS = 500
+};
+
+enum rpc_api {
+	API_ECHO = 1,
+	API_HANG = 2
+};
+
+//a frame is (writer, seq), each one must arrive once, the order between loops is not kept
+class frame_sink final :
+	public netp::channel_handler_abstract
+{
+	std::vector<netp::u8_t> m_seen;
+public:
+	std::atomic<int> received;
+	std::atomic<int> dup;
+	std::atomic<int> off_loop;
+
+	frame_sink() :
+		channel_handler_abstract(netp::CH_INBOUND_READ),
+		m_seen(WRITERS * FRAMES, 0),
+		received(0),
+		dup(0),
+		off_loop(0)
+	{}
+
+	void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income) override {
+		if (!ctx->L->in_event_loop()) {
+			++off_loop;
+		}
+		NETP_ASSERT(income->len() == sizeof(netp::u32_t) * 2);
+		const netp::u32_t w = income->read<netp::u32_t>();
+		const netp::u32_t s = income->read<netp::u32_t>();
+		NETP_ASSERT(w < WRITERS && s < FRAMES);
+		netp::u8_t& seen = m_seen[w * FRAMES + s];
+		if (seen) {
+			++dup;
+			return;
+		}
+		seen = 1;
+		++received;
+	}
+};
+
+//keeps the ctx for the writers, ctx->write from a foreign thread has to follow the channel too
+class keeper final :
+	public netp::channel_handler_abstract
+{
+public:
+	NRP<netp::promise<NRP<netp::channel_handler_context>>> ctxp;
+	keeper() :
+		channel_handler_abstract(netp::CH_ACTIVITY_CONNECTED),
+		ctxp(netp::make_ref<netp::promise<NRP<netp::channel_handler_context>>>())
+	{}
+	void connected(NRP<netp::channel_handler_context> const& ctx) override {
+		ctxp->set(ctx);
+		ctx->fire_connected();
+	}
+};
+
+void write_frames(NRP<netp::channel> ch, NRP<netp::channel_handler_context> ctx, netp::u32_t w) {
+	for (netp::u32_t s = 0; s < FRAMES; ++s) {
+		NRP<netp::packet> p = netp::make_ref<netp::packet>();
+		p->write<netp::u32_t>(w);
+		p->write<netp::u32_t>(s);
+		NRP<netp::promise<int>> wp = (s % 2) ? ch->ch_write(p) : ctx->write(p);
+		if ((s % 64) == 0) {
+			const int rt = wp->get();
+			NETP_ASSERT(rt == netp::OK, "write failed: %d", rt);
+		}
+	}
+}
+
+std::atomic<bool> g_migrate_stop(false);
+std::atomic<int> g_migrated(0);
+
+void migrate_loop(NRP<netp::channel> a, NRP<netp::channel> b, NRP<netp::io_event_loop> L1, NRP<netp::io_event_loop> L2) {
+	NRP<netp::channel> chs[] = { a, b };
+	for (int i = 0; i < MIGRATIONS && !g_migrate_stop.load(); ++i) {
+		for (NRP<netp::channel> const& ch : chs) {
+			NRP<netp::io_event_loop> const& to = (i % 2) ? L1 : L2;
+			const int rt = ch->ch_migrate_to(to)->get();
+			NETP_ASSERT(rt == netp::OK || rt == netp::E_OP_INPROCESS, "migrate failed: %d", rt);
+			if (rt == netp::OK) {
+				//ch->L is for its loop only, ch_loop() is the one for the other threads
+				NETP_ASSERT(ch->ch_loop() == to);
+				++g_migrated;
+			}
+		}
+	}
+}
+
+void wait_for(std::function<bool()> const& done) {
+	for (int i = 0; i < 10000 && !done(); ++i) {
+		netp::this_thread::sleep(1);
+	}
+}
+
+void test_channel(NRP<netp::io_event_loop> const& L1, NRP<netp::io_event_loop> const& L2) {
+	NRP<netp::promise<NRP<netp::channel>>> accepted = netp::make_ref<netp::promise<NRP<netp::channel>>>();
+	NRP<frame_sink> sink = netp::make_ref<frame_sink>();
+	NRP<netp::socket_cfg> lcfg = netp::make_ref<netp::socket_cfg>(L1);
+	NRP<netp::channel_listen_promise> lp = netp::listen_on("tcp://127.0.0.1:32701", [accepted, sink](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>());
+		ch->pipeline()->add_last(sink);
+		accepted->set(ch);
+	}, lcfg);
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<keeper> k = netp::make_ref<keeper>();
+	NRP<netp::socket_cfg> dcfg = netp::make_ref<netp::socket_cfg>(L2);
+	NRP<netp::channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:32701", [k](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>());
+		ch->pipeline()->add_last(k);
+	}, dcfg);
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> cch = std::get<1>(dp->get());
+	NRP<netp::channel> sch = accepted->get();
+	NRP<netp::channel_handler_context> kctx = k->ctxp->get();
+
+	g_migrate_stop = false;
+	g_migrated = 0;
+	NRP<netp::thread> migrator = netp::make_ref<netp::thread>();
+	migrator->start(&migrate_loop, cch, sch, L1, L2);
+
+	std::vector<NRP<netp::thread>> writers;
+	for (netp::u32_t w = 0; w < WRITERS; ++w) {
+		NRP<netp::thread> th = netp::make_ref<netp::thread>();
+		th->start(&write_frames, cch, kctx, w);
+		writers.push_back(th);
+	}
+	for (NRP<netp::thread>& th : writers) {
+		th->join();
+	}
+	g_migrate_stop = true;
+	migrator->join();
+
+	wait_for([sink]() { return sink->received.load() == WRITERS * FRAMES; });
+	NETP_ASSERT(sink->received.load() == WRITERS * FRAMES, "received: %d", sink->received.load());
+	NETP_ASSERT(sink->dup.load() == 0 && sink->off_loop.load() == 0);
+	NETP_ASSERT(g_migrated.load() > 0);
+	NETP_INFO("[channel_migrate]channel ok, frames: %d, migrated: %d", sink->received.load(), g_migrated.load());
+
+	cch->ch_close();
+	sch->ch_close_promise()->get();
+	cch->ch_close_promise()->get();
+	std::get<1>(lp->get())->ch_close()->get();
+}
+
+void call_echo(NRP<netp::rpc> r, std::atomic<int>* ok) {
+	for (netp::u32_t i = 0; i < CALLS; ++i) {
+		NRP<netp::packet> p = netp::make_ref<netp::packet>();
+		p->write<netp::u32_t>(i);
+		std::tuple<int, NRP<netp::packet>> const& tupr = r->call(API_ECHO, p)->get();
+		NETP_ASSERT(std::get<0>(tupr) == netp::OK, "call failed: %d", std::get<0>(tupr));
+		NETP_ASSERT(std::get<1>(tupr)->read<netp::u32_t>() == i);
+		++(*ok);
+	}
+}
+
+void test_rpc(NRP<netp::io_event_loop> const& L1, NRP<netp::io_event_loop> const& L2) {
+	NRP<netp::promise<NRP<netp::rpc>>> accepted = netp::make_ref<netp::promise<NRP<netp::rpc>>>();
+	NRP<netp::socket_cfg> lcfg = netp::make_ref<netp::socket_cfg>(L1);
+	NRP<netp::rpc_listen_promise> lp = netp::rpc::listen("tcp://127.0.0.1:32702", [accepted](NRP<netp::rpc> const& r) {
+		r->bindcall(API_ECHO, [](NRP<netp::rpc> const& r_, NRP<netp::packet> const& in, NRP<netp::rpc_call_promise> const& f) {
+			NETP_ASSERT(r_->channel()->L->in_event_loop());
+			f->set(std::make_tuple(netp::OK, in));
+		});
+		//never replied, the caller gets E_RPC_CALL_TIMEOUT by the timer of its current loop
+		r->bindcall(API_HANG, [](NRP<netp::rpc> const&, NRP<netp::packet> const&, NRP<netp::rpc_call_promise> const&) {});
+		accepted->set(r);
+	}, nullptr, lcfg);
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<netp::socket_cfg> dcfg = netp::make_ref<netp::socket_cfg>(L2);
+	NRP<netp::rpc_dial_promise> dp = netp::rpc::dial("tcp://127.0.0.1:32702", nullptr, dcfg);
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::rpc> cr = std::get<1>(dp->get());
+	NRP<netp::rpc> sr = accepted->get();
+
+	g_migrate_stop = false;
+	g_migrated = 0;
+	std::atomic<int> ok(0);
+	NRP<netp::thread> caller = netp::make_ref<netp::thread>();
+	caller->start(&call_echo, cr, &ok);
+	NRP<netp::thread> migrator = netp::make_ref<netp::thread>();
+	migrator->start(&migrate_loop, cr->channel(), sr->channel(), L1, L2);
+	caller->join();
+	g_migrate_stop = true;
+	migrator->join();
+	NETP_ASSERT(ok.load() == CALLS);
+
+	NRP<netp::packet> p = netp::make_ref<netp::packet>();
+	p->write<netp::u32_t>(0);
+	const int rt = std::get<0>(cr->call(API_HANG, p, std::chrono::seconds(1))->get());
+	NETP_ASSERT(rt == netp::E_RPC_CALL_TIMEOUT, "hang call: %d", rt);
+	NETP_INFO("[channel_migrate]rpc ok, calls: %d, migrated: %d", ok.load(), g_migrated.load());
+
+	cr->close()->get();
+	sr->close_promise()->get();
+	std::get<1>(lp->get())->ch_close()->get();
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	cfg.cfg_poller_count(NETP_DEFAULT_POLLER_TYPE, 2);
+	netp::app _app(cfg);
+
+	NRP<netp::io_event_loop> L1 = netp::io_event_loop_group::instance()->next();
+	NRP<netp::io_event_loop> L2 = netp::io_event_loop_group::instance()->next();
+	for (int i = 0; i < 8 && L2 == L1; ++i) {
+		L2 = netp::io_event_loop_group::instance()->next();
+	}
+	NETP_ASSERT(L1 != L2, "need two loops");
+
+	test_channel(L1, L2);
+	test_rpc(L1, L2);
+	return 0;
+}
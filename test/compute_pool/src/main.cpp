@@ -0,0 +1,165 @@
+#include <netp.hpp>
+#include <vector>
+
+//the owner pushes and pops at the bottom while thieves steal at the top, every item must be taken exactly once
+void test_ws_deque(netp::u32_t total, netp::u32_t thieves) {
+	netp::ws_deque<netp::u32_t> q(16); //small on purpose, grow under steal
+	std::vector<std::atomic<netp::u8_t>> taken(total);
+	for (netp::u32_t i = 0; i < total; ++i) {
+		taken[i].store(0, std::memory_order_relaxed);
+	}
+	std::atomic<netp::u32_t> count(0);
+	std::atomic<bool> done(false);
+
+	auto take = [&](netp::u32_t v) {
+		const netp::u8_t prev = taken[v].fetch_add(1, std::memory_order_relaxed);
+		NETP_ASSERT(prev == 0, "item %u taken twice", v);
+		count.fetch_add(1, std::memory_order_relaxed);
+	};
+
+	std::vector<NRP<netp::thread>> ths;
+	std::vector<netp::u32_t> stolen(thieves, 0);
+	for (netp::u32_t k = 0; k < thieves; ++k) {
+		NRP<netp::thread> th = netp::make_ref<netp::thread>();
+		th->start([&q, &done, &take, &stolen, k]() {
+			netp::u32_t v;
+			while (!done.load(std::memory_order_acquire) || !q.empty()) {
+				if (q.steal(v)) {
+					take(v);
+					++stolen[k];
+				}
+			}
+		});
+		ths.push_back(th);
+	}
+
+	netp::u32_t popped = 0;
+	for (netp::u32_t i = 0; i < total; ++i) {
+		q.push(i);
+		if ((i % 3) == 0) {
+			netp::u32_t v;
+			if (q.pop(v)) {
+				take(v);
+				++popped;
+			}
+		}
+	}
+	netp::u32_t v;
+	while (q.pop(v)) {
+		take(v);
+		++popped;
+	}
+	done.store(true, std::memory_order_release);
+	for (NRP<netp::thread>& th : ths) {
+		th->join();
+	}
+
+	NETP_ASSERT(count.load() == total, "count: %u, total: %u", count.load(), total);
+	netp::u32_t all_stolen = 0;
+	for (netp::u32_t s : stolen) {
+		all_stolen += s;
+	}
+	NETP_ASSERT(popped + all_stolen == total);
+	NETP_INFO("[compute_pool]ws_deque ok, total: %u, popped: %u, stolen: %u", total, popped, all_stolen);
+}
+
+void test_offload() {
+	NRP<netp::io_event_loop> L = netp::io_event_loop_group::instance()->next();
+
+	NRP<netp::promise<std::tuple<int, int>>> p_int = L->offload([]() { return 42; });
+	NRP<netp::promise<int>> p_void = L->offload([]() {});
+	NRP<netp::promise<std::tuple<int, int>>> p_netp_throw = L->offload([]() -> int { NETP_THROW2(netp::E_OP_ABORT, "abort"); });
+	NRP<netp::promise<std::tuple<int, std::string>>> p_std_throw = L->offload([]() -> std::string { throw std::runtime_error("runtime error"); });
+	NRP<netp::promise<int>> p_any_throw = L->offload([]() { throw 1; });
+
+	NETP_ASSERT(std::get<0>(p_int->get()) == netp::OK && std::get<1>(p_int->get()) == 42);
+	NETP_ASSERT(p_void->get() == netp::OK);
+	NETP_ASSERT(std::get<0>(p_netp_throw->get()) == netp::E_OP_ABORT);
+	NETP_ASSERT(std::get<0>(p_std_throw->get()) == netp::E_UNKNOWN && std::get<1>(p_std_throw->get()).empty());
+	NETP_ASSERT(p_any_throw->get() == netp::E_UNKNOWN);
+
+	//many round trips, every one comes back
+	const int n = 10000;
+	std::vector<NRP<netp::promise<std::tuple<int, int>>>> ps;
+	ps.reserve(n);
+	for (int i = 0; i < n; ++i) {
+		ps.push_back(L->offload([i]() -> int {
+			if ((i % 100) == 0) { throw std::runtime_error("every 100th"); }
+			return i * 2;
+		}));
+	}
+	int failed = 0;
+	for (int i = 0; i < n; ++i) {
+		std::tuple<int, int> const& r = ps[i]->get();
+		if ((i % 100) == 0) {
+			NETP_ASSERT(std::get<0>(r) == netp::E_UNKNOWN);
+			++failed;
+		} else {
+			NETP_ASSERT(std::get<0>(r) == netp::OK && std::get<1>(r) == i * 2);
+		}
+	}
+	NETP_INFO("[compute_pool]offload ok, round trip: %d, failed as expected: %d", n, failed);
+}
+
+//jobs still queued when the pool stops are never run, their promises must be settled anyway
+void test_stop_drop() {
+	NRP<netp::io_event_loop> L = netp::io_event_loop_group::instance()->next();
+	netp::compute_pool* pool = netp::compute_pool::instance();
+	const netp::u32_t workers = pool->worker_count();
+	NETP_ASSERT(workers > 0);
+
+	//keep every worker busy, the jobs below stay in the queue
+	std::atomic<netp::u32_t> blocked(0);
+	std::atomic<bool> release(false);
+	for (netp::u32_t i = 0; i < workers; ++i) {
+		NETP_ASSERT(pool->execute([&blocked, &release]() {
+			++blocked;
+			while (!release.load()) {
+				netp::this_thread::sleep(1);
+			}
+		}) == netp::OK);
+	}
+	while (blocked.load() != workers) {
+		netp::this_thread::sleep(1);
+	}
+
+	const int n = 64;
+	std::atomic<int> ran(0);
+	std::vector<NRP<netp::promise<std::tuple<int, int>>>> ps;
+	std::vector<NRP<netp::promise<int>>> pvs;
+	for (int i = 0; i < n; ++i) {
+		ps.push_back(L->offload([&ran, i]() -> int { ++ran; return i; }));
+		pvs.push_back(L->offload([&ran]() { ++ran; }));
+	}
+
+	NRP<netp::thread> stopper = netp::make_ref<netp::thread>();
+	stopper->start([pool]() { pool->stop(); });
+	//a refused task is freed by execute, nothing is left behind a drained pool
+	while (pool->execute([]() { NETP_ASSERT(!"run after stop"); }) == netp::OK) {
+		netp::this_thread::sleep(1);
+	}
+	NETP_ASSERT(pool->execute([]() {}) == netp::E_INVALID_STATE);
+	release = true;
+	stopper->join();
+
+	for (int i = 0; i < n; ++i) {
+		NETP_ASSERT(std::get<0>(ps[i]->get()) == netp::E_INVALID_STATE);
+		NETP_ASSERT(pvs[i]->get() == netp::E_INVALID_STATE);
+	}
+	NETP_ASSERT(ran.load() == 0, "ran: %d", ran.load());
+
+	//run in the loop once the pool is gone
+	NRP<netp::promise<std::tuple<int, int>>> p_in_loop = L->offload([L]() -> int { NETP_ASSERT(L->in_event_loop()); return 7; });
+	NETP_ASSERT(std::get<0>(p_in_loop->get()) == netp::OK && std::get<1>(p_in_loop->get()) == 7);
+	NETP_INFO("[compute_pool]stop ok, dropped offload settled: %d", n * 2);
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	test_ws_deque(1000000, 3);
+	test_offload();
+	test_stop_drop();
+	return 0;
+}
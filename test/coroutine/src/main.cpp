@@ -0,0 +1,166 @@
+#include <netp.hpp>
+
+#ifndef NETP_HAS_COROUTINE
+int main(int argc, char** argv) {
+	(void)argc; (void)argv;
+	NETP_INFO("[coroutine]build with -DNETP_ENABLE_COROUTINE=ON");
+	return 0;
+}
+#else
+
+netp::co_future<int> co_add(int a, int b) {
+	co_await netp::co_sleep(std::chrono::milliseconds(1));
+	co_return a + b;
+}
+
+netp::co_future<int> co_throw_std() {
+	co_await netp::co_sleep(std::chrono::milliseconds(1));
+	throw std::runtime_error("runtime error");
+	co_return 0;
+}
+
+netp::co_future<std::tuple<int, std::string>> co_throw_netp() {
+	co_await netp::co_sleep(std::chrono::milliseconds(1));
+	NETP_THROW2(netp::E_OP_ABORT, "abort");
+	co_return std::make_tuple(netp::OK, std::string("never"));
+}
+
+netp::co_task co_task_throw() {
+	co_await netp::co_sleep(std::chrono::milliseconds(1));
+	throw 1;
+}
+
+//exceptions of a co_future reach its awaiter, the loop never sees one
+netp::co_future<int> co_exceptions() {
+	int sum = co_await co_add(1, 2);
+	NETP_ASSERT(sum == 3);
+
+	bool caught = false;
+	try {
+		co_await co_throw_std();
+	} catch (std::runtime_error& e) {
+		caught = std::string(e.what()) == "runtime error";
+	}
+	NETP_ASSERT(caught);
+
+	caught = false;
+	try {
+		co_await co_throw_netp();
+	} catch (netp::exception& e) {
+		caught = e.code() == netp::E_OP_ABORT;
+	}
+	NETP_ASSERT(caught);
+
+	co_task_throw();
+	co_await netp::co_sleep(std::chrono::milliseconds(5));
+	co_return netp::OK;
+}
+
+void test_exceptions() {
+	NRP<netp::io_event_loop> L = netp::io_event_loop_group::instance()->next();
+
+	NRP<netp::promise<int>> p = netp::make_ref<netp::promise<int>>();
+	L->execute([p]() {
+		netp::co_future<int> f = co_exceptions();
+		f.p->if_done([p](int const& rt) { p->set(rt); });
+	});
+	NETP_ASSERT(p->get() == netp::OK);
+
+	//a watcher sees the error code
+	NRP<netp::promise<std::tuple<int, std::string>>> pt = netp::make_ref<netp::promise<std::tuple<int, std::string>>>();
+	L->execute([pt]() {
+		netp::co_future<std::tuple<int, std::string>> f = co_throw_netp();
+		f.p->if_done([pt](std::tuple<int, std::string> const& r) { pt->set(r); });
+	});
+	NETP_ASSERT(std::get<0>(pt->get()) == netp::E_OP_ABORT);
+
+	//the loop still runs after a co_task threw
+	NRP<netp::promise<int>> alive = netp::make_ref<netp::promise<int>>();
+	L->execute([alive]() { alive->set(netp::OK); });
+	NETP_ASSERT(alive->get() == netp::OK);
+	NETP_INFO("[coroutine]exceptions ok");
+}
+
+//counts the packets the coroutine has taken, the reader must not be resumed inside fire_read
+std::atomic<int> g_consumed(0);
+std::atomic<int> g_inline_resume(0);
+
+class resume_probe final :
+	public netp::channel_handler_abstract
+{
+public:
+	resume_probe() : channel_handler_abstract(netp::CH_INBOUND_READ) {}
+	void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income) override {
+		const int before = g_consumed.load();
+		ctx->fire_read(income);
+		if (g_consumed.load() != before) {
+			++g_inline_resume;
+		}
+	}
+};
+
+class discard final :
+	public netp::channel_handler_abstract
+{
+public:
+	discard() : channel_handler_abstract(netp::CH_INBOUND_READ) {}
+	void read(NRP<netp::channel_handler_context> const&, NRP<netp::packet> const&) override {}
+};
+
+netp::co_task co_echo(NRP<netp::channel> ch, NRP<netp::co_reader> r, NRP<netp::promise<int>> done) {
+	int bytes = 0;
+	for (;;) {
+		NRP<netp::packet> in = co_await r->read();
+		if (in == nullptr) {
+			break;
+		}
+		++g_consumed;
+		bytes += int(in->len());
+		int rt = co_await ch->ch_write(in);
+		if (rt != netp::OK) {
+			break;
+		}
+	}
+	done->set(bytes);
+}
+
+void test_co_reader(int port) {
+	NRP<netp::promise<int>> done = netp::make_ref<netp::promise<int>>();
+	std::string url = "tcp://127.0.0.1:" + std::to_string(port);
+	NRP<netp::channel_listen_promise> lp = netp::listen_on(url.c_str(), [done](NRP<netp::channel> const& ch) {
+		NRP<netp::co_reader> r = netp::make_ref<netp::co_reader>();
+		ch->pipeline()->add_last(netp::make_ref<resume_probe>());
+		ch->pipeline()->add_last(r);
+		co_echo(ch, r, done);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<netp::channel_dial_promise> dp = netp::dial(url.c_str(), [](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<discard>());
+	});
+	NRP<netp::channel> ch = std::get<1>(dp->get());
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+
+	const int total = 64 * 1024;
+	for (int i = 0; i < total / 1024; ++i) {
+		NRP<netp::packet> p = netp::make_ref<netp::packet>(1024);
+		for (int j = 0; j < 1024; ++j) { p->write<netp::u8_t>(netp::u8_t(j)); }
+		NETP_ASSERT(ch->ch_write(p)->get() == netp::OK);
+	}
+	ch->ch_close_write();
+	NETP_ASSERT(done->get() == total, "echoed: %d", done->get());
+	ch->ch_close();
+	std::get<1>(lp->get())->ch_close();
+	NETP_ASSERT(g_inline_resume.load() == 0);
+	NETP_INFO("[coroutine]co_reader ok, packets: %d", g_consumed.load());
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	test_exceptions();
+	test_co_reader(32202);
+	return 0;
+}
+#endif
@@ -0,0 +1,215 @@
+#include <netp.hpp>
+
+//the wheel ticks every NETP_IDLE_STATE_WHEEL_TICK_MS, an event may come up to two ticks late
+enum {
+	IDLE_MS = 1000,
+	LATE_MS = 2 * NETP_IDLE_STATE_WHEEL_TICK_MS + 200,
+	TRAFFIC_MS = 2500,
+	FRAME_INTERVAL_MS = 100
+};
+
+//the idle config of the next accepted channel
+std::atomic<int> g_read_ms(0);
+std::atomic<int> g_write_ms(0);
+std::atomic<int> g_all_ms(0);
+
+class event_sink final :
+	public netp::channel_handler_abstract
+{
+	netp::spin_mutex m_mtx;
+	std::vector<std::tuple<int, std::chrono::steady_clock::time_point>> m_events;
+public:
+	std::atomic<int> reads;
+
+	event_sink() :
+		channel_handler_abstract(netp::CH_INBOUND_READ | netp::CH_INBOUND_USER_EVENT),
+		reads(0)
+	{}
+
+	void read(NRP<netp::channel_handler_context> const&, NRP<netp::packet> const&) override {
+		++reads;
+	}
+	void user_event(NRP<netp::channel_handler_context> const& ctx, int evt) override {
+		NETP_ASSERT(ctx->L->in_event_loop());
+		netp::lock_guard<netp::spin_mutex> lg(m_mtx);
+		m_events.push_back(std::make_tuple(evt, std::chrono::steady_clock::now()));
+	}
+
+	//count of evt, and the time of the first one after since
+	int count(int evt, std::chrono::steady_clock::time_point const& since, std::chrono::steady_clock::time_point* first = nullptr) {
+		netp::lock_guard<netp::spin_mutex> lg(m_mtx);
+		int n = 0;
+		for (auto const& e : m_events) {
+			if (std::get<0>(e) == evt && std::get<1>(e) >= since) {
+				if (n == 0 && first != nullptr) { *first = std::get<1>(e); }
+				++n;
+			}
+		}
+		return n;
+	}
+	netp::size_t total() {
+		netp::lock_guard<netp::spin_mutex> lg(m_mtx);
+		return m_events.size();
+	}
+};
+
+struct idle_conn {
+	NRP<netp::channel> cch;
+	NRP<netp::channel> sch;
+	NRP<netp::handler::idle_state> idle;
+	NRP<event_sink> sink;
+};
+
+NRP<netp::promise<NRP<netp::channel>>> g_accepted;
+NRP<netp::handler::idle_state> g_idle;
+NRP<event_sink> g_sink;
+
+idle_conn connect_with(int read_ms, int write_ms, int all_ms) {
+	g_read_ms = read_ms;
+	g_write_ms = write_ms;
+	g_all_ms = all_ms;
+	g_accepted = netp::make_ref<netp::promise<NRP<netp::channel>>>();
+	NRP<netp::channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:32823", [](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>());
+	});
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+
+	idle_conn c;
+	c.cch = std::get<1>(dp->get());
+	c.sch = g_accepted->get();
+	c.idle = g_idle;
+	c.sink = g_sink;
+	g_accepted = nullptr;
+	g_idle = nullptr;
+	g_sink = nullptr;
+	return c;
+}
+
+void write_frames(idle_conn const& c, int ms) {
+	for (int i = 0; i < ms / FRAME_INTERVAL_MS; ++i) {
+		NRP<netp::packet> p = netp::make_ref<netp::packet>();
+		p->write<netp::u32_t>(i);
+		NETP_ASSERT(c.cch->ch_write(p)->get() == netp::OK);
+		netp::this_thread::sleep(FRAME_INTERVAL_MS);
+	}
+}
+
+//wait for n evt after since, return the time of the first one
+std::chrono::steady_clock::time_point wait_event(idle_conn const& c, int evt, int n, std::chrono::steady_clock::time_point const& since) {
+	std::chrono::steady_clock::time_point first;
+	for (int i = 0; i < 10000 && c.sink->count(evt, since, &first) < n; ++i) {
+		netp::this_thread::sleep(1);
+	}
+	NETP_ASSERT(c.sink->count(evt, since) >= n, "evt: %d, count: %d", evt, c.sink->count(evt, since));
+	return first;
+}
+
+void close_conn(idle_conn& c) {
+	c.cch->ch_close();
+	c.sch->ch_close_promise()->get();
+	c.cch->ch_close_promise()->get();
+}
+
+long elapsed_ms(std::chrono::steady_clock::time_point const& from, std::chrono::steady_clock::time_point const& to) {
+	return long(std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count());
+}
+
+//read idle: no event while the peer writes, one per period once it stops
+void test_read_idle() {
+	idle_conn c = connect_with(IDLE_MS, 0, 0);
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	write_frames(c, TRAFFIC_MS);
+	NETP_ASSERT(c.sink->count(netp::handler::IDLE_STATE_READ_IDLE, begin) == 0);
+
+	const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point first = wait_event(c, netp::handler::IDLE_STATE_READ_IDLE, 2, stop);
+	const long ms = elapsed_ms(stop, first);
+	NETP_ASSERT(ms >= IDLE_MS - FRAME_INTERVAL_MS && ms <= IDLE_MS + LATE_MS, "read idle after: %ld ms", ms);
+	NETP_ASSERT(c.sink->total() == netp::size_t(c.sink->count(netp::handler::IDLE_STATE_READ_IDLE, begin)));
+	close_conn(c);
+	NETP_INFO("[idle_state]read idle ok, first after: %ld ms", ms);
+}
+
+//write idle: reads do not count, the channel never writes
+void test_write_idle() {
+	idle_conn c = connect_with(0, IDLE_MS, 0);
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	write_frames(c, TRAFFIC_MS);
+	NETP_ASSERT(c.sink->count(netp::handler::IDLE_STATE_WRITE_IDLE, begin) >= 1);
+	NETP_ASSERT(c.sink->reads.load() == TRAFFIC_MS / FRAME_INTERVAL_MS);
+
+	//a write of its own pushes it away
+	const std::chrono::steady_clock::time_point wrote = std::chrono::steady_clock::now();
+	NRP<netp::packet> p = netp::make_ref<netp::packet>();
+	p->write<netp::u32_t>(0);
+	NETP_ASSERT(c.sch->ch_write(p)->get() == netp::OK);
+	const std::chrono::steady_clock::time_point first = wait_event(c, netp::handler::IDLE_STATE_WRITE_IDLE, 1, wrote);
+	const long ms = elapsed_ms(wrote, first);
+	NETP_ASSERT(ms >= IDLE_MS - FRAME_INTERVAL_MS && ms <= IDLE_MS + LATE_MS, "write idle after: %ld ms", ms);
+	close_conn(c);
+	NETP_INFO("[idle_state]write idle ok, first after: %ld ms", ms);
+}
+
+//all idle: either read or write keeps it away
+void test_all_idle() {
+	idle_conn c = connect_with(0, 0, IDLE_MS);
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	write_frames(c, TRAFFIC_MS);
+	NETP_ASSERT(c.sink->count(netp::handler::IDLE_STATE_ALL_IDLE, begin) == 0);
+
+	const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point first = wait_event(c, netp::handler::IDLE_STATE_ALL_IDLE, 2, stop);
+	const long ms = elapsed_ms(stop, first);
+	NETP_ASSERT(ms >= IDLE_MS - FRAME_INTERVAL_MS && ms <= IDLE_MS + LATE_MS, "all idle after: %ld ms", ms);
+	close_conn(c);
+	NETP_INFO("[idle_state]all idle ok, first after: %ld ms", ms);
+}
+
+//the wheel entry goes away with closed(), not with the sweep at its deadline
+void test_close() {
+	idle_conn c = connect_with(IDLE_MS, IDLE_MS, IDLE_MS);
+	write_frames(c, FRAME_INTERVAL_MS);
+	for (int i = 0; i < 1000 && c.sink->reads.load() == 0; ++i) {
+		netp::this_thread::sleep(1);
+	}
+	//the deadline is about IDLE_MS away
+	close_conn(c);
+	c.cch = nullptr;
+	c.sch = nullptr;
+	int i = 0;
+	for (; i < NETP_IDLE_STATE_WHEEL_TICK_MS / 2 && c.idle.ref_count() != 1; ++i) {
+		netp::this_thread::sleep(1);
+	}
+	NETP_ASSERT(c.idle.ref_count() == 1, "idle_state still referenced: %ld", c.idle.ref_count());
+
+	const netp::size_t total = c.sink->total();
+	netp::this_thread::sleep(IDLE_MS + LATE_MS);
+	NETP_ASSERT(c.sink->total() == total);
+	NETP_INFO("[idle_state]close ok, released in: %d ms", i);
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	NRP<netp::channel_listen_promise> lp = netp::listen_on("tcp://127.0.0.1:32823", [](NRP<netp::channel> const& ch) {
+		NRP<netp::handler::idle_state> idle = netp::make_ref<netp::handler::idle_state>(
+			std::chrono::milliseconds(g_read_ms.load()), std::chrono::milliseconds(g_write_ms.load()), std::chrono::milliseconds(g_all_ms.load()));
+		NRP<event_sink> sink = netp::make_ref<event_sink>();
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>());
+		ch->pipeline()->add_last(idle);
+		ch->pipeline()->add_last(sink);
+		g_idle = idle;
+		g_sink = sink;
+		g_accepted->set(ch);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	test_read_idle();
+	test_write_idle();
+	test_all_idle();
+	test_close();
+
+	std::get<1>(lp->get())->ch_close()->get();
+	return 0;
+}
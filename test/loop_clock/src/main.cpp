@@ -0,0 +1,73 @@
+#include <netp.hpp>
+
+//the loop blocks in wait before every frame, the read callback must see the time of the wakeup, not the one before the block
+enum {
+	ROUNDS = 4,
+	BLOCK_MS = 300
+};
+
+class clock_probe final :
+	public netp::channel_handler_abstract
+{
+public:
+	NRP<netp::promise<netp::timer_timepoint_t>> seen[ROUNDS];
+
+	clock_probe() :
+		channel_handler_abstract(netp::CH_INBOUND_READ)
+	{
+		for (int i = 0; i < ROUNDS; ++i) {
+			seen[i] = netp::make_ref<netp::promise<netp::timer_timepoint_t>>();
+		}
+	}
+
+	void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income) override {
+		NETP_ASSERT(income->len() == sizeof(netp::u32_t));
+		const netp::u32_t r = income->read<netp::u32_t>();
+		NETP_ASSERT(r < ROUNDS);
+		seen[r]->set(ctx->L->now());
+	}
+};
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	cfg.cfg_poller_count(NETP_DEFAULT_POLLER_TYPE, 2);
+	netp::app _app(cfg);
+
+	//the writer lives in another loop, nothing but the read event wakes L
+	NRP<netp::io_event_loop> L = netp::io_event_loop_group::instance()->next();
+	NRP<netp::io_event_loop> L2 = netp::io_event_loop_group::instance()->next();
+	for (int i = 0; i < 8 && L2 == L; ++i) {
+		L2 = netp::io_event_loop_group::instance()->next();
+	}
+	NETP_ASSERT(L != L2, "need two loops");
+	NRP<clock_probe> probe = netp::make_ref<clock_probe>();
+	NRP<netp::socket_cfg> lcfg = netp::make_ref<netp::socket_cfg>(L);
+	NRP<netp::channel_listen_promise> lp = netp::listen_on("tcp://127.0.0.1:32801", [probe](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(probe);
+	}, lcfg);
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<netp::socket_cfg> dcfg = netp::make_ref<netp::socket_cfg>(L2);
+	NRP<netp::channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:32801", nullptr, dcfg);
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> ch = std::get<1>(dp->get());
+
+	for (netp::u32_t r = 0; r < ROUNDS; ++r) {
+		//nothing to do for the loop in this period, it sleeps in the poller
+		netp::this_thread::sleep(BLOCK_MS);
+		const netp::timer_timepoint_t sent = netp::timer_clock_t::now();
+		NRP<netp::packet> p = netp::make_ref<netp::packet>();
+		p->write<netp::u32_t>(r);
+		ch->ch_write(p);
+
+		const netp::timer_timepoint_t seen = probe->seen[r]->get();
+		const long long lag = std::chrono::duration_cast<std::chrono::microseconds>(netp::timer_clock_t::now() - seen).count();
+		NETP_ASSERT(seen >= sent, "round: %u, L->now() is %lld us before the write", r, std::chrono::duration_cast<std::chrono::microseconds>(sent - seen).count());
+		NETP_INFO("[loop_clock]round: %u, L->now() lag to the reader: %lld us", r, lag);
+	}
+	NETP_INFO("[loop_clock]read callback sees the wakeup time ok");
+
+	ch->ch_close()->get();
+	std::get<1>(lp->get())->ch_close()->get();
+	return 0;
+}
@@ -0,0 +1,218 @@
+#include <netp.hpp>
+
+//the two halves alias the same pages, a byte written through one is read through the other
+void test_mirror() {
+	NRP<netp::mirror_ringbuffer> r = netp::make_ref<netp::mirror_ringbuffer>();
+	int rt = r->init(100);
+	NETP_ASSERT(rt == netp::OK, "rt: %d", rt);
+	const netp::u32_t cap = r->capacity();
+	NETP_ASSERT(cap >= 100);
+
+	netp::byte_t* const base = r->head();
+	for (netp::u32_t i = 0; i < cap; ++i) {
+		base[i] = netp::byte_t(i * 31);
+	}
+	for (netp::u32_t i = 0; i < cap; ++i) {
+		NETP_ASSERT(base[cap + i] == netp::byte_t(i * 31));
+	}
+	base[cap + 7] = 'x';
+	NETP_ASSERT(base[7] == 'x');
+	NETP_INFO("[mirror_ringbuffer]mirror ok, capacity: %u", cap);
+}
+
+//walk the indexes over the wrap point many times, a frame is always readable in one piece from head()
+void test_wraparound() {
+	NRP<netp::mirror_ringbuffer> r = netp::make_ref<netp::mirror_ringbuffer>();
+	int rt = r->init(4096);
+	NETP_ASSERT(rt == netp::OK, "rt: %d", rt);
+	const netp::u32_t cap = r->capacity();
+	const netp::byte_t* const base = r->head();
+
+	netp::byte_t src[4096];
+	netp::byte_t dst[4096];
+	netp::u32_t seq_w = 0;
+	netp::u32_t seq_r = 0;
+	netp::u32_t wrapped = 0;
+	for (int i = 0; i < 100000; ++i) {
+		const netp::u32_t n = 1 + (std::rand() % (cap - 1));
+		for (netp::u32_t k = 0; k < n; ++k) {
+			src[k] = netp::byte_t(seq_w + k);
+		}
+		const netp::u32_t off = netp::u32_t(r->tail() - base);
+		const netp::u32_t w = r->write(src, n);
+		if ((off % cap) + w > cap) {
+			++wrapped;
+		}
+		seq_w += w;
+		NETP_ASSERT(r->count() == (seq_w - seq_r) && r->count() <= cap);
+
+		const netp::u32_t m = netp::u32_t(std::rand()) % (r->count() + 1);
+		const netp::byte_t* const h = r->head();
+		for (netp::u32_t k = 0; k < m; ++k) {
+			NETP_ASSERT(h[k] == netp::byte_t(seq_r + k));
+		}
+		const netp::u32_t c = r->read(dst, m);
+		NETP_ASSERT(c == m);
+		NETP_ASSERT(std::memcmp(dst, h, m) == 0);
+		seq_r += m;
+	}
+	r->skip(r->count());
+	NETP_ASSERT(r->is_empty() && r->left_capacity() == cap);
+	NETP_ASSERT(wrapped > 0);
+
+	//a u32 straddling the wrap point decodes in place
+	r->write(src, cap - 1);
+	r->skip(cap - 2); //one byte left, the indexes are not reset
+	r->write((netp::byte_t*)"\x01\x02\x03\x04", 4);
+	r->skip(1);
+	NETP_ASSERT(netp::u32_t(r->head() - base) == cap - 1);
+	NETP_ASSERT(r->peek<netp::u32_t>() == 0x01020304);
+	NETP_ASSERT(r->read<netp::u32_t>() == 0x01020304);
+	NETP_ASSERT(r->is_empty());
+	NETP_INFO("[mirror_ringbuffer]wraparound ok, written: %u, wrapped writes: %u", seq_w, wrapped);
+}
+
+enum {
+	HLEN_FRAME_SIZE = 96 * 1024, //not a divisor of the read buffer, most of the frames span two reads
+	HLEN_FRAMES = 4096,
+	HLEN_RING_CAPACITY = 256 * 1024
+};
+
+class frame_counter final :
+	public netp::channel_handler_abstract
+{
+	netp::u32_t m_expect;
+public:
+	NRP<netp::promise<int>> done;
+	frame_counter() :
+		channel_handler_abstract(netp::CH_INBOUND_READ),
+		m_expect(0),
+		done(netp::make_ref<netp::promise<int>>())
+	{}
+	void read(NRP<netp::channel_handler_context> const&, NRP<netp::packet> const& income) override {
+		NETP_ASSERT(income->len() == HLEN_FRAME_SIZE);
+		NETP_ASSERT(income->read<netp::u32_t>() == m_expect, "frame out of order, expect: %u", m_expect);
+		NETP_ASSERT(*(income->tail() - 1) == netp::byte_t(m_expect));
+		if (++m_expect == HLEN_FRAMES) {
+			done->set(netp::OK);
+		}
+	}
+};
+
+//frames cut into chunks of a few bytes, the len and the content are completed over many reads
+class frame_checker final :
+	public netp::channel_handler_abstract
+{
+public:
+	std::vector<netp::u32_t> sizes;
+	NRP<netp::promise<int>> done;
+	netp::u32_t expect;
+	frame_checker(std::vector<netp::u32_t> const& sizes_) :
+		channel_handler_abstract(netp::CH_INBOUND_READ),
+		sizes(sizes_),
+		done(netp::make_ref<netp::promise<int>>()),
+		expect(0)
+	{}
+	void read(NRP<netp::channel_handler_context> const&, NRP<netp::packet> const& income) override {
+		NETP_ASSERT(expect < sizes.size());
+		NETP_ASSERT(income->len() == sizes[expect], "frame: %u, len: %u", expect, income->len());
+		for (netp::u32_t i = 0; i < income->len(); ++i) {
+			NETP_ASSERT(income->head()[i] == netp::byte_t(expect + i));
+		}
+		if (++expect == sizes.size()) {
+			done->set(netp::OK);
+		}
+	}
+};
+
+void hlen_partials(std::string const& addr, netp::u32_t ring_capacity) {
+	std::vector<netp::u32_t> sizes = { 0, 1, 3, 4, 5, 300, 0, 2 };
+	NRP<netp::packet> stream = netp::make_ref<netp::packet>();
+	for (netp::u32_t f = 0; f < sizes.size(); ++f) {
+		stream->write<netp::u32_t>(sizes[f]);
+		for (netp::u32_t i = 0; i < sizes[f]; ++i) {
+			stream->write<netp::u8_t>(netp::u8_t(f + i));
+		}
+	}
+
+	NRP<frame_checker> checker = netp::make_ref<frame_checker>(sizes);
+	NRP<netp::channel_listen_promise> lp = netp::listen_on(addr, [checker, ring_capacity](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>(ring_capacity));
+		ch->pipeline()->add_last(checker);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+	//raw bytes, no hlen on this side
+	NRP<netp::channel_dial_promise> dp = netp::dial(addr, nullptr);
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> ch = std::get<1>(dp->get());
+
+	netp::u32_t chunks = 0;
+	while (stream->len() > 0) {
+		const netp::u32_t r = 1 + (netp::u32_t(std::rand()) % 7);
+		const netp::u32_t n = NETP_MIN(stream->len(), r);
+		NETP_ASSERT(ch->ch_write(netp::make_ref<netp::packet>(stream->head(), n))->get() == netp::OK);
+		stream->skip(n);
+		++chunks;
+		netp::this_thread::sleep(1);
+	}
+	NETP_ASSERT(checker->done->get() == netp::OK);
+	NETP_INFO("[mirror_ringbuffer]hlen partials ok, ring capacity: %u, frames: %u, chunks: %u", ring_capacity, netp::u32_t(sizes.size()), chunks);
+
+	ch->ch_close()->get();
+	std::get<1>(lp->get())->ch_close()->get();
+}
+
+void test_hlen_partials() {
+	hlen_partials("tcp://127.0.0.1:32813", 0);
+	hlen_partials("tcp://127.0.0.1:32814", 4096);
+}
+
+//MB/s of hlen reassembling frames that span reads, by the ring or by m_tmp (ring_capacity == 0)
+double hlen_throughput(std::string const& addr, netp::u32_t ring_capacity) {
+	NRP<frame_counter> counter = netp::make_ref<frame_counter>();
+	NRP<netp::channel_listen_promise> lp = netp::listen_on(addr, [counter, ring_capacity](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>(ring_capacity));
+		ch->pipeline()->add_last(counter);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+	NRP<netp::channel_dial_promise> dp = netp::dial(addr, [](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(netp::make_ref<netp::handler::hlen>());
+	});
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> ch = std::get<1>(dp->get());
+
+	const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	for (netp::u32_t i = 0; i < HLEN_FRAMES; ++i) {
+		NRP<netp::packet> p = netp::make_ref<netp::packet>(HLEN_FRAME_SIZE);
+		p->write<netp::u32_t>(i);
+		p->incre_write_idx(HLEN_FRAME_SIZE - sizeof(netp::u32_t) - 1);
+		p->write<netp::u8_t>(netp::u8_t(i));
+		NRP<netp::promise<int>> wp = ch->ch_write(p);
+		if ((i % 32) == 31) {
+			NETP_ASSERT(wp->get() == netp::OK);
+		}
+	}
+	NETP_ASSERT(counter->done->get() == netp::OK);
+	const long long us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+	ch->ch_close()->get();
+	std::get<1>(lp->get())->ch_close()->get();
+	return (double(HLEN_FRAME_SIZE) * HLEN_FRAMES) / double(NETP_MAX(us, 1LL));
+}
+
+void test_hlen_throughput() {
+	const double tmp = hlen_throughput("tcp://127.0.0.1:32811", 0);
+	const double ring = hlen_throughput("tcp://127.0.0.1:32812", HLEN_RING_CAPACITY);
+	NETP_INFO("[mirror_ringbuffer]hlen throughput, frame: %u, frames: %u, m_tmp: %.1f MB/s, ring: %.1f MB/s",
+		netp::u32_t(HLEN_FRAME_SIZE), netp::u32_t(HLEN_FRAMES), tmp, ring);
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+	test_mirror();
+	test_wraparound();
+	test_hlen_partials();
+	test_hlen_throughput();
+	return 0;
+}
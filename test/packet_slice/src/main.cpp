@@ -0,0 +1,115 @@
+#include <netp.hpp>
+
+typedef netp::cap_fix_packet<netp::ref_base, 16, 256, NETP_DEFAULT_ALIGN> fix_packet;
+
+template <class P>
+NRP<P> make_seq(netp::u32_t n) {
+	NRP<P> p = netp::make_ref<P>();
+	for (netp::u32_t i = 0; i < n; ++i) {
+		p->template write<netp::u8_t>(netp::u8_t(i));
+	}
+	return p;
+}
+
+template <class P>
+bool is_seq(NRP<P> const& p, netp::u32_t from, netp::u32_t n) {
+	if (p->len() != n) { return false; }
+	for (netp::u32_t i = 0; i < n; ++i) {
+		if (p->head()[i] != netp::byte_t(from + i)) { return false; }
+	}
+	return true;
+}
+
+//writes to a packet or a slice never show up in the others sharing the buffer
+template <class P>
+void test_slice(char const* name) {
+	NRP<P> p = make_seq<P>(200);
+	p->skip(20);
+	NRP<P> s1 = p->retained_slice(0, 50); //[20,70)
+	NRP<P> s2 = p->retained_slice(50, 50); //[70,120)
+	NETP_ASSERT(p->is_shared() && s1->is_shared() && s2->is_shared());
+	NETP_ASSERT(is_seq(s1, 20, 50) && is_seq(s2, 70, 50));
+
+	//the parent consumes s1's bytes, then writes left over them
+	p->skip(100);
+	p->write_left((netp::byte_t*)"xxxxxxxxxxxxxxxxxxxx", 20);
+	p->template write_left<netp::u32_t>(0xffffffff);
+	NETP_ASSERT(!p->is_shared());
+	NETP_ASSERT(is_seq(s1, 20, 50) && is_seq(s2, 70, 50));
+	NETP_ASSERT(p->len() == 80 + 24 && p->head()[4] == 'x' && p->head()[24] == netp::byte_t(120));
+
+	//a slice has no left capacity, writing left copies it out
+	s2->template write_left<netp::u32_t>(0x01020304);
+	s1->write_left((netp::byte_t*)"yy", 2);
+	NETP_ASSERT(!s1->is_shared() && !s2->is_shared());
+	NETP_ASSERT(s2->len() == 54 && s2->template read<netp::u32_t>() == 0x01020304 && is_seq(s2, 70, 50));
+	NETP_ASSERT(s1->len() == 52 && s1->head()[0] == 'y');
+	s1->skip(2);
+	NETP_ASSERT(is_seq(s1, 20, 50));
+
+	//the buffer outlives the packet it came from
+	NRP<P> q = make_seq<P>(100);
+	NRP<P> s3 = q->retained_slice(10, 10);
+	q = nullptr;
+	NETP_ASSERT(is_seq(s3, 10, 10));
+
+	//reset of a shared packet moves it to a new buffer
+	NRP<P> r = make_seq<P>(100);
+	NRP<P> s4 = r->retained_slice(0, 100);
+	r->reset();
+	r->write((netp::byte_t*)"zz", 2);
+	NETP_ASSERT(!r->is_shared() && is_seq(s4, 0, 100));
+	NETP_INFO("[packet_slice][%s]ok", name);
+}
+
+//expandable only, growing right never reallocates a shared buffer in place
+void test_expand_right() {
+	NRP<netp::packet> p = make_seq<netp::packet>(100);
+	NRP<netp::packet> s = p->retained_slice(0, 100);
+	for (netp::u32_t i = 0; i < 64 * 1024; ++i) {
+		p->write<netp::u8_t>(0xee);
+	}
+	NETP_ASSERT(!p->is_shared() && is_seq(s, 0, 100));
+	NETP_INFO("[packet_slice][packet]expand right ok");
+}
+
+//segments are shared, not copied, a u32 may straddle two of them
+void test_composite() {
+	NRP<netp::composite_packet> c = netp::make_ref<netp::composite_packet>();
+	NETP_ASSERT(c->len() == 0 && c->slice(0, 0)->len() == 0);
+
+	NRP<netp::packet> p = make_seq<netp::packet>(100);
+	p->skip(10); //[10,100)
+	c->append(p);
+	c->append(netp::make_ref<netp::packet>());
+	c->prepend(make_seq<netp::packet>(10)); //[0,10)
+	NETP_ASSERT(c->len() == 100 && c->segment_count() == 2);
+	NETP_ASSERT(c->segment_at(1).head == p->head());
+
+	//an empty slice at the end walks no segment
+	NETP_ASSERT(c->slice(c->len(), 0)->len() == 0);
+	NETP_ASSERT(c->slice(10, 0)->len() == 0);
+	NRP<netp::composite_packet> s = c->slice(8, 4);
+	NETP_ASSERT(s->len() == 4 && s->segment_count() == 2);
+	NETP_ASSERT(s->read<netp::u32_t>() == 0x08090a0b && s->len() == 0);
+	NETP_ASSERT(c->slice(10, 90)->flatten() == p);
+	NETP_ASSERT(is_seq(c->flatten(), 0, 100));
+
+	netp::iov_t iov[4];
+	NETP_ASSERT(c->to_iov(iov, 4) == 2);
+	c->skip(9);
+	NETP_ASSERT(c->peek<netp::u32_t>() == 0x090a0b0c && c->segment_count() == 2);
+	c->skip(1);
+	NETP_ASSERT(c->segment_count() == 1 && c->flatten() == p);
+	NETP_INFO("[packet_slice][composite_packet]ok");
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+	test_slice<fix_packet>("fix_packet");
+	test_slice<netp::packet>("packet");
+	test_expand_right();
+	test_composite();
+	return 0;
+}
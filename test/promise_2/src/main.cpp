@@ -19,13 +19,126 @@ NRP<netp::promise<std::tuple<int, NRP<netp::packet>>>> set_p_on_L(NRP<netp::io_e
 
 //#define ACCESS_ONCE(x) (*(volatile typeof(x) *)&(x))
 
-int main(int argc, char** argv) {
+NRP<netp::promise<int>> set_later(NRP<netp::io_event_loop> const& L, int v, int delay_ms) {
+	NRP<netp::promise<int>> p = netp::make_ref<netp::promise<int>>();
+	L->launch(netp::make_ref<netp::timer>(std::chrono::milliseconds(delay_ms), [p, v](NRP<netp::timer> const&) {
+		p->set(v);
+	}));
+	return p;
+}
+
+void test_when_all(NRP<netp::io_event_loop> const& L1, NRP<netp::io_event_loop> const& L2) {
+	//set in the reverse order from two loops, the result keeps the input order
+	std::vector<NRP<netp::promise<int>>> ps = { set_later(L1, 1, 30), set_later(L2, 2, 20), set_later(L1, 3, 10) };
+	std::vector<int> vals = netp::when_all(ps)->get();
+	NETP_ASSERT(vals.size() == 3 && vals[0] == 1 && vals[1] == 2 && vals[2] == 3);
+
+	NETP_ASSERT(netp::when_all(std::vector<NRP<netp::promise<int>>>())->get().size() == 0);
+
+	//a cancelled input counts as done with V()
+	std::vector<NRP<netp::promise<int>>> cs = { netp::make_ref<netp::promise<int>>(), netp::make_ref<netp::promise<int>>() };
+	NRP<netp::promise<std::vector<int>>> cp = netp::when_all(cs);
+	cs[0]->set(7);
+	NETP_ASSERT(cp->is_idle());
+	NETP_ASSERT(cs[1]->cancel());
+	NETP_ASSERT(cp->get().size() == 2 && cp->get()[0] == 7 && cp->get()[1] == 0);
+	NETP_INFO("[promise_2]when_all ok");
+}
 
-	netp::app _app;
+void test_when_any_some(NRP<netp::io_event_loop> const& L1, NRP<netp::io_event_loop> const& L2) {
+	std::vector<NRP<netp::promise<int>>> ps = { set_later(L1, 1, 300), set_later(L2, 2, 10), set_later(L1, 3, 200) };
+	std::tuple<netp::size_t, int> any = netp::when_any(ps)->get();
+	NETP_ASSERT(std::get<0>(any) == 1 && std::get<1>(any) == 2);
+
+	std::vector<NRP<netp::promise<int>>> qs = { set_later(L1, 1, 300), set_later(L2, 2, 10), set_later(L1, 3, 100), set_later(L2, 4, 600) };
+	std::vector<std::tuple<netp::size_t, int>> some = netp::when_some(qs, 2)->get();
+	NETP_ASSERT(some.size() == 2);
+	NETP_ASSERT(std::get<0>(some[0]) == 1 && std::get<1>(some[0]) == 2);
+	NETP_ASSERT(std::get<0>(some[1]) == 2 && std::get<1>(some[1]) == 3);
+	//the later ones do not touch the result
+	qs[3]->get();
+	NETP_ASSERT(some.size() == 2 && std::get<1>(some[1]) == 3);
+
+	NETP_ASSERT(netp::when_some(qs, 0)->get().size() == 0);
+	//k is clamped, all of them are done here
+	NETP_ASSERT(netp::when_some(qs, 10)->get().size() == qs.size());
+
+	//the first cancel settles a when_any too
+	std::vector<NRP<netp::promise<int>>> cs = { netp::make_ref<netp::promise<int>>(), netp::make_ref<netp::promise<int>>() };
+	NRP<netp::promise<std::tuple<netp::size_t, int>>> cp = netp::when_any(cs);
+	NETP_ASSERT(cs[1]->cancel());
+	NETP_ASSERT(std::get<0>(cp->get()) == 1 && std::get<1>(cp->get()) == 0);
+	cs[0]->set(1);
+	NETP_ASSERT(std::get<0>(cp->get()) == 1);
+	NETP_INFO("[promise_2]when_any, when_some ok");
+}
+
+void test_then(NRP<netp::io_event_loop> const& L1) {
+	NRP<netp::promise<int>> p = netp::make_ref<netp::promise<int>>();
+	NRP<netp::promise<std::tuple<int, int>>> twice = p->then(L1, [L1](int const& v) {
+		NETP_ASSERT(L1->in_event_loop());
+		return v * 2;
+	});
+	NRP<netp::promise<int>> v_void = p->then(L1, [](int const&) {});
+	NRP<netp::promise<std::tuple<int, std::string>>> v_netp_throw = p->then(L1, [](int const&) -> std::string { NETP_THROW2(netp::E_OP_ABORT, "abort"); });
+	NRP<netp::promise<int>> v_any_throw = p->then(L1, [](int const&) { throw 1; });
+	p->set(21);
+	NETP_ASSERT(std::get<0>(twice->get()) == netp::OK && std::get<1>(twice->get()) == 42);
+	NETP_ASSERT(v_void->get() == netp::OK);
+	NETP_ASSERT(std::get<0>(v_netp_throw->get()) == netp::E_OP_ABORT && std::get<1>(v_netp_throw->get()).empty());
+	NETP_ASSERT(v_any_throw->get() == netp::E_UNKNOWN);
+
+	//bound after done, and on a cancel with V()
+	NETP_ASSERT(std::get<1>(p->then(L1, [](int const& v) { return v + 1; })->get()) == 22);
+	NRP<netp::promise<int>> c = netp::make_ref<netp::promise<int>>();
+	NRP<netp::promise<std::tuple<int, int>>> on_cancel = c->then(L1, [](int const& v) { return v - 1; });
+	NETP_ASSERT(c->cancel());
+	NETP_ASSERT(std::get<0>(on_cancel->get()) == netp::OK && std::get<1>(on_cancel->get()) == -1);
+	NETP_INFO("[promise_2]then ok");
+}
+
+void test_with_timeout(NRP<netp::io_event_loop> const& L1, NRP<netp::io_event_loop> const& L2) {
+	std::tuple<int, int> in_time = netp::with_timeout(L1, set_later(L2, 5, 10), std::chrono::milliseconds(1000))->get();
+	NETP_ASSERT(std::get<0>(in_time) == netp::OK && std::get<1>(in_time) == 5);
+
+	NRP<netp::promise<int>> never = netp::make_ref<netp::promise<int>>();
+	std::tuple<int, int> timeout = netp::with_timeout(L1, never, std::chrono::milliseconds(50))->get();
+	NETP_ASSERT(std::get<0>(timeout) == netp::E_OP_TIMEOUT && std::get<1>(timeout) == 0);
+	//a late set is not reported, p is not cancelled by the timeout either
+	NETP_ASSERT(never->is_idle());
+	never->set(1);
+
+	NRP<netp::promise<int>> done = netp::make_ref<netp::promise<int>>();
+	done->set(9);
+	NRP<netp::promise<std::tuple<int, int>>> at_once = netp::with_timeout(L1, done, std::chrono::milliseconds(1));
+	NETP_ASSERT(!at_once->is_idle() && std::get<1>(at_once->get()) == 9);
+
+	NRP<netp::promise<int>> cancelled = netp::make_ref<netp::promise<int>>();
+	NRP<netp::promise<std::tuple<int, int>>> on_cancel = netp::with_timeout(L1, cancelled, std::chrono::milliseconds(1000));
+	NETP_ASSERT(cancelled->cancel());
+	NETP_ASSERT(std::get<0>(on_cancel->get()) == netp::E_OP_ABORT);
+
+	NRP<netp::promise<int>> cancelled_before = netp::make_ref<netp::promise<int>>();
+	NETP_ASSERT(cancelled_before->cancel());
+	NETP_ASSERT(std::get<0>(netp::with_timeout(L1, cancelled_before, std::chrono::milliseconds(1000))->get()) == netp::E_OP_ABORT);
+	NETP_INFO("[promise_2]with_timeout ok");
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	cfg.cfg_poller_count(NETP_DEFAULT_POLLER_TYPE, 2);
+	netp::app _app(cfg);
 
 	NRP<netp::io_event_loop> L1 = netp::io_event_loop_group::instance()->next();
 	NRP<netp::io_event_loop> L2 = netp::io_event_loop_group::instance()->next();
-	std::atomic<bool> round_go = true;
+
+	test_when_all(L1, L2);
+	test_when_any_some(L1, L2);
+	test_then(L1);
+	test_with_timeout(L1, L2);
+
+	//stress, runs until killed
+	std::atomic<bool> round_go(true);
 	while (true) {
 		while (!round_go.load(std::memory_order_acquire)) {
 			netp::this_thread::yield();
@@ -33,7 +146,7 @@ int main(int argc, char** argv) {
 		round_go.store(false, std::memory_order_release);
 
 		NRP<netp::promise<std::tuple<int, NRP<netp::packet> >>> p = set_p_on_L(L2);
-		p->if_done([L1, L2, &round_go]( const std::tuple<int, NRP<netp::packet>> const& tup ) {
+		p->if_done([L1, L2, &round_go]( std::tuple<int, NRP<netp::packet>> const& tup ) {
 			//main thread check
 			int rt = std::get<0>(tup);
 			if (rt == 0) {
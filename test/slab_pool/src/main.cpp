@@ -0,0 +1,141 @@
+#include <netp.hpp>
+#include <vector>
+
+#ifndef NETP_MEMORY_USE_SLAB
+	#error "slab_pool test needs netplus built with NETP_MEMORY_USE_SLAB"
+#endif
+
+//the tables below T7 (<=16K) are carved out of 2MB slab chunks, the ones from T7 on go to std::malloc
+//every cache is capped to 1 byte, so a malloc/free of this thread goes down to the backend directly
+//the loops are idle, a change of the chunk count comes from the class under test only
+
+netp::u32_t chunk_count() {
+	netp::allocator_stat st;
+	netp::allocator_stat_collect(st);
+	return st.slab_chunks;
+}
+
+netp::u32_t slot_size(netp::u8_t t, netp::u8_t s) {
+	netp::allocator_stat st;
+	netp::allocator_stat_collect(st);
+	return st.slots[t][s].size;
+}
+
+//the last slot of T6, the biggest class that lives in slab
+netp::u32_t slab_edge_size() {
+	return slot_size(netp::T6, 7);
+}
+
+//an emptied chunk is kept as spare, items of a non-empty chunk are taken from its free list first
+void test_chunk_reuse() {
+	const netp::u32_t size = slab_edge_size();
+	const netp::u32_t base = chunk_count();
+
+	netp::byte_t* p1 = netp::allocator<netp::byte_t>::malloc(size);
+	NETP_ASSERT(chunk_count() == base + 1, "chunks: %u, base: %u", chunk_count(), base);
+	netp::allocator<netp::byte_t>::free(p1);
+	//the spare, not unmapped
+	NETP_ASSERT(chunk_count() == base + 1);
+
+	//the spare is reset, bump from its start again
+	netp::byte_t* p2 = netp::allocator<netp::byte_t>::malloc(size);
+	NETP_ASSERT(p2 == p1 && chunk_count() == base + 1);
+
+	netp::byte_t* p3 = netp::allocator<netp::byte_t>::malloc(size);
+	netp::byte_t* p4 = netp::allocator<netp::byte_t>::malloc(size);
+	NETP_ASSERT(p3 != p2 && p4 != p3 && chunk_count() == base + 1);
+	netp::allocator<netp::byte_t>::free(p3);
+	netp::byte_t* p5 = netp::allocator<netp::byte_t>::malloc(size);
+	NETP_ASSERT(p5 == p3, "free list not reused");
+
+	netp::allocator<netp::byte_t>::free(p2);
+	netp::allocator<netp::byte_t>::free(p4);
+	netp::allocator<netp::byte_t>::free(p5);
+	NETP_ASSERT(chunk_count() == base + 1);
+	netp::allocator_trim();
+	NETP_ASSERT(chunk_count() == base, "spare not trimmed, chunks: %u, base: %u", chunk_count(), base);
+	NETP_INFO("[slab_pool]chunk reuse ok");
+}
+
+//two chunks emptied: the first is kept as spare, the second is unmapped
+void test_spare_chunk() {
+	const netp::u32_t size = slab_edge_size();
+	const netp::u32_t base = chunk_count();
+
+	std::vector<netp::byte_t*> items;
+	while (chunk_count() != base + 2) {
+		NETP_ASSERT(items.size() < 1024, "the second chunk never mapped");
+		items.push_back(netp::allocator<netp::byte_t>::malloc(size));
+	}
+	const netp::size_t per_chunk = items.size() - 1;
+	//the second chunk is the one of the last item
+	const std::size_t chunk_mask = ~std::size_t(2 * 1024 * 1024 - 1);
+	NETP_ASSERT((std::size_t(items.front()) & chunk_mask) != (std::size_t(items.back()) & chunk_mask));
+	NETP_ASSERT((std::size_t(items.front()) & chunk_mask) == (std::size_t(items[per_chunk - 1]) & chunk_mask));
+
+	for (netp::byte_t* p : items) {
+		netp::allocator<netp::byte_t>::free(p);
+	}
+	NETP_ASSERT(chunk_count() == base + 1, "chunks: %u, base: %u", chunk_count(), base);
+
+	//a full round again out of the spare, the second chunk is mapped on the last one
+	items.clear();
+	for (netp::size_t i = 0; i < per_chunk; ++i) {
+		items.push_back(netp::allocator<netp::byte_t>::malloc(size));
+	}
+	NETP_ASSERT(chunk_count() == base + 1);
+	items.push_back(netp::allocator<netp::byte_t>::malloc(size));
+	NETP_ASSERT(chunk_count() == base + 2);
+
+	for (netp::byte_t* p : items) {
+		netp::allocator<netp::byte_t>::free(p);
+	}
+	netp::allocator_trim();
+	NETP_ASSERT(chunk_count() == base);
+	NETP_INFO("[slab_pool]spare chunk ok, items per chunk: %u", netp::u32_t(per_chunk));
+}
+
+//__item_free routes by the table tagged in the item header, T7 and beyond are never handed to the slab
+void test_edge_routing() {
+	const netp::u32_t edge = slab_edge_size();
+	const netp::u32_t base = chunk_count();
+
+	const netp::u32_t sizes[] = { edge + 1, slot_size(netp::T7, 7), slot_size(netp::T8, 0), 4 * 1024 * 1024 };
+	std::vector<netp::byte_t*> items;
+	for (netp::u32_t size : sizes) {
+		for (int i = 0; i < 8; ++i) {
+			netp::byte_t* p = netp::allocator<netp::byte_t>::malloc(size);
+			//a std::malloc-ed item handed to the slab would be taken as part of a chunk, write all of it
+			std::memset(p, 0x5a, size);
+			items.push_back(p);
+		}
+	}
+	NETP_ASSERT(chunk_count() == base, "chunks: %u, base: %u", chunk_count(), base);
+
+	netp::byte_t* in = netp::allocator<netp::byte_t>::malloc(edge);
+	NETP_ASSERT(chunk_count() == base + 1);
+	for (netp::byte_t* p : items) {
+		netp::allocator<netp::byte_t>::free(p);
+	}
+	NETP_ASSERT(chunk_count() == base + 1);
+	netp::allocator<netp::byte_t>::free(in);
+	netp::allocator_trim();
+	NETP_ASSERT(chunk_count() == base);
+	NETP_INFO("[slab_pool]edge routing ok, edge: %u", edge);
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	cfg.cfg_poller_count(NETP_DEFAULT_POLLER_TYPE, 1);
+	netp::app _app(cfg);
+
+	netp::allocator_cfg_cached_bytes_max(1, 1);
+	netp::allocator_trim();
+
+	test_chunk_reuse();
+	test_spare_chunk();
+	test_edge_routing();
+
+	netp::allocator_cfg_cached_bytes_max(0, 0);
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include <netp.hpp>
+
+//every hop appends its tag, the peer sees the path a packet took
+struct count_stage : netp::static_handler {
+	enum { CH_FLAG = netp::CH_ACTIVITY_CONNECTED | netp::CH_INBOUND_READ | netp::CH_OUTBOUND_WRITE };
+	int connected_cnt = 0;
+	int read_cnt = 0;
+
+	template <class C> void connected(C& ctx) { ++connected_cnt; ctx.fire_connected(); }
+	template <class C> void read(C& ctx, NRP<netp::packet> const& income) { ++read_cnt; ctx.fire_read(income); }
+	template <class C> void write(NRP<netp::promise<int>> const& intp, C& ctx, NRP<netp::packet> const& outlet) {
+		outlet->write<netp::u8_t>('0');
+		ctx.write(intp, outlet);
+	}
+};
+
+std::atomic<int> g_mark_alive(0);
+std::atomic<int> g_mark_connected(0);
+std::atomic<int> g_mark_closed(0);
+std::atomic<int> g_mark_void(0);
+NRP<netp::channel_handler_context> g_mark_ctx;
+
+class mark final :
+	public netp::channel_handler_abstract
+{
+public:
+	mark() : channel_handler_abstract(netp::CH_ACTIVITY_CONNECTED | netp::CH_ACTIVITY_CLOSED | netp::CH_INBOUND_READ | netp::CH_OUTBOUND_WRITE) { ++g_mark_alive; }
+	~mark() { --g_mark_alive; }
+
+	void connected(NRP<netp::channel_handler_context> const& ctx) override {
+		++g_mark_connected;
+		g_mark_ctx = ctx;
+		ctx->fire_connected();
+	}
+	void closed(NRP<netp::channel_handler_context> const& ctx) override {
+		++g_mark_closed;
+		ctx->fire_closed();
+	}
+	void read(NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& income) override {
+		income->write<netp::u8_t>('m');
+		ctx->fire_read(income);
+	}
+	void write(NRP<netp::promise<int>> const& intp, NRP<netp::channel_handler_context> const& ctx, NRP<netp::packet> const& outlet) override {
+		//never nullptr, a void write comes with void_promise()
+		NETP_ASSERT(intp != nullptr);
+		if (intp->is_void()) { ++g_mark_void; }
+		outlet->write<netp::u8_t>('M');
+		ctx->write(intp, outlet);
+	}
+};
+
+struct echo_stage : netp::static_handler {
+	enum { CH_FLAG = netp::CH_INBOUND_READ };
+	template <class C> void read(C& ctx, NRP<netp::packet> const& income) {
+		income->write<netp::u8_t>('e');
+		ctx.write_void(income);
+	}
+};
+
+typedef netp::static_pipeline<count_stage, netp::dynamic_stage<mark>, echo_stage> echo_stack_t;
+
+class collector final :
+	public netp::channel_handler_abstract
+{
+	netp::spin_mutex m_mtx;
+	std::string m_buf;
+public:
+	collector() : channel_handler_abstract(netp::CH_INBOUND_READ) {}
+	void read(NRP<netp::channel_handler_context> const&, NRP<netp::packet> const& income) override {
+		netp::lock_guard<netp::spin_mutex> lg(m_mtx);
+		m_buf.append((char const*)income->head(), income->len());
+	}
+	std::string take(netp::size_t n) {
+		for (int i = 0; i < 5000; ++i) {
+			{
+				netp::lock_guard<netp::spin_mutex> lg(m_mtx);
+				if (m_buf.size() >= n) {
+					std::string s = m_buf.substr(0, n);
+					m_buf.erase(0, n);
+					return s;
+				}
+			}
+			netp::this_thread::sleep(1);
+		}
+		return std::string();
+	}
+};
+
+NRP<netp::packet> make_packet(char const* s) {
+	return netp::make_ref<netp::packet>(s, netp::u32_t(::strlen(s)));
+}
+
+int main(int argc, char** argv) {
+	netp::app_cfg cfg(argc, argv);
+	netp::app _app(cfg);
+
+	NRP<netp::promise<NRP<netp::channel>>> accepted = netp::make_ref<netp::promise<NRP<netp::channel>>>();
+	NRP<echo_stack_t> stack = netp::make_ref<echo_stack_t>();
+	NRP<netp::channel_listen_promise> lp = netp::listen_on("tcp://127.0.0.1:32311", [accepted, stack](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(stack);
+		accepted->set(ch);
+	});
+	NETP_ASSERT(std::get<0>(lp->get()) == netp::OK);
+
+	NRP<collector> c = netp::make_ref<collector>();
+	NRP<netp::channel_dial_promise> dp = netp::dial("tcp://127.0.0.1:32311", [c](NRP<netp::channel> const& ch) {
+		ch->pipeline()->add_last(c);
+	});
+	NETP_ASSERT(std::get<0>(dp->get()) == netp::OK);
+	NRP<netp::channel> cch = std::get<1>(dp->get());
+	NRP<netp::channel> sch = accepted->get();
+
+	//inbound 0 -> mark -> echo, then outbound from echo back through mark and 0
+	NETP_ASSERT(cch->ch_write(make_packet("ping"))->get() == netp::OK);
+	std::string r = c->take(8);
+	NETP_ASSERT(r == "pingmeM0", "got: %s", r.c_str());
+
+	//outbound from the tail passes every stage
+	NETP_ASSERT(sch->ch_write(make_packet("tail"))->get() == netp::OK);
+	r = c->take(6);
+	NETP_ASSERT(r == "tailM0", "got: %s", r.c_str());
+
+	//a ctx kept by the dynamic handler, written from a foreign thread, skips mark itself
+	NETP_ASSERT(g_mark_ctx != nullptr);
+	NETP_ASSERT(g_mark_ctx->write(make_packet("kept"))->get() == netp::OK);
+	r = c->take(5);
+	NETP_ASSERT(r == "kept0", "got: %s", r.c_str());
+
+	//a void write passes a non-null promise to every handler, set() on it does nothing
+	sch->ch_write_void(make_packet("void"));
+	r = c->take(6);
+	NETP_ASSERT(r == "voidM0", "got: %s", r.c_str());
+	//the echo of "ping" was a void write too
+	NETP_ASSERT(g_mark_void.load() == 2, "void: %d", g_mark_void.load());
+	netp::void_promise()->set(netp::OK);
+	netp::void_promise()->set(netp::E_CHANNEL_CLOSED);
+	NETP_ASSERT(netp::void_promise()->is_void());
+
+	NETP_ASSERT(stack->stage<0>().connected_cnt == 1 && stack->stage<0>().read_cnt == 1);
+	NETP_ASSERT(g_mark_connected.load() == 1);
+
+	//closed reaches the dynamic handler, deinit of the pipeline releases the stages and their bridges
+	NETP_ASSERT(sch->ch_close()->get() == netp::OK);
+	cch->ch_close();
+	sch->ch_close_promise()->get();
+	NETP_ASSERT(g_mark_closed.load() == 1);
+	g_mark_ctx = nullptr;
+	stack = nullptr;
+	sch = nullptr;
+	//the initializer holds a ref of the stack too
+	std::get<1>(lp->get())->ch_close()->get();
+	lp = nullptr;
+	for (int i = 0; i < 1000 && g_mark_alive.load() != 0; ++i) {
+		netp::this_thread::sleep(1);
+	}
+	NETP_ASSERT(g_mark_alive.load() == 0, "mark leaked");
+	NETP_INFO("[static_pipeline]ok");
+	return 0;
+}